@@ -0,0 +1,424 @@
+/**
+ * @file ArrowColumn.hpp
+ * @author Pedro Lucas (pedrolucas.jsrn@gmail.com)
+ * @brief Arquivo de cabeçalho para a classe ArrowColumn e as estruturas da
+ * Arrow C Data Interface.
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef ARROW_COLUMN_HPP_
+#define ARROW_COLUMN_HPP_
+
+#include "Generator.hpp"
+#include "StatisticsView.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+extern "C" {
+/**
+ * @brief O tipo de um array, como definido pela Arrow C Data Interface.
+ */
+struct ArrowSchema {
+   char const* format;
+   char const* name;
+   char const* metadata;
+   int64_t flags;
+   int64_t n_children;
+   struct ArrowSchema** children;
+   struct ArrowSchema* dictionary;
+   void (*release)(struct ArrowSchema*);
+   void* private_data;
+};
+
+/**
+ * @brief Os buffers de um array, como definidos pela Arrow C Data Interface.
+ */
+struct ArrowArray {
+   int64_t length;
+   int64_t null_count;
+   int64_t offset;
+   int64_t n_buffers;
+   int64_t n_children;
+   void const** buffers;
+   struct ArrowArray** children;
+   struct ArrowArray* dictionary;
+   void (*release)(struct ArrowArray*);
+   void* private_data;
+};
+}
+
+#endif /// ARROW_C_DATA_INTERFACE
+
+namespace stats {
+   /**
+    * @class ArrowColumn
+    * @brief Um array primitivo numérico recebido pela Arrow C Data Interface,
+    * lido sem cópia.
+    *
+    * O objeto assume a posse das estruturas exportadas pelo produtor (que
+    * ficam marcadas como liberadas, como pede a especificação) e chama os
+    * seus release no destrutor. O formato é validado contra TYPE.
+    *
+    * Sem nulos, os valores formam um std::span direto sobre o buffer do
+    * produtor e podem ser usados por StatisticsView. Com nulos, accumulate()
+    * percorre o bitmap de validade em palavras de 64 bits: trechos sem nulos
+    * são entregues ao acumulador direto do buffer, palavras só de nulos são
+    * puladas e as demais são compactadas sem desvios em um buffer curto.
+    *
+    * @tparam TYPE Define o tipo de dados. Deve ser um tipo numérico.
+    */
+   template <typename TYPE>
+   class ArrowColumn {
+      static_assert(std::is_arithmetic_v<TYPE>, "TYPE must be a numeric type");
+
+  private:
+      static constexpr std::size_t batchSize = 4096;
+
+      ArrowArray array {};
+      ArrowSchema schema {};
+      TYPE const* data = nullptr;
+      std::uint8_t const* validity = nullptr;
+      std::size_t length = 0;
+      std::size_t bitOffset = 0;
+
+      /**
+       * @brief Retorna o formato da Arrow correspondente a TYPE.
+       *
+       * @return O formato, ou vazio se TYPE não tiver um.
+       */
+      static constexpr std::string_view expectedFormat() {
+         if constexpr (std::is_same_v<TYPE, float>) {
+            return "f";
+         } else if constexpr (std::is_same_v<TYPE, double>) {
+            return "g";
+         } else if constexpr (std::is_integral_v<TYPE> && sizeof(TYPE) == 1) {
+            return std::is_signed_v<TYPE> ? "c" : "C";
+         } else if constexpr (std::is_integral_v<TYPE> && sizeof(TYPE) == 2) {
+            return std::is_signed_v<TYPE> ? "s" : "S";
+         } else if constexpr (std::is_integral_v<TYPE> && sizeof(TYPE) == 4) {
+            return std::is_signed_v<TYPE> ? "i" : "I";
+         } else if constexpr (std::is_integral_v<TYPE> && sizeof(TYPE) == 8) {
+            return std::is_signed_v<TYPE> ? "l" : "L";
+         } else {
+            return "";
+         }
+      }
+
+      /**
+       * @brief Libera as estruturas, se ainda não foram liberadas.
+       */
+      void release() {
+         if (array.release != nullptr) {
+            array.release(&array);
+         }
+         if (schema.release != nullptr) {
+            schema.release(&schema);
+         }
+      }
+
+      /**
+       * @brief Lê os bits de validade de até 64 valores.
+       *
+       * @param first O índice do primeiro valor.
+       * @param count O número de valores, até 64.
+       *
+       * @return Os bits, o do valor first no bit 0.
+       */
+      std::uint64_t validityBits(std::size_t first, std::size_t count) const {
+         std::size_t bit = bitOffset + first;
+         std::size_t byte = bit / 8;
+         std::size_t shift = bit % 8;
+         std::size_t available = (bitOffset + length + 7) / 8 - byte;
+
+         std::uint64_t low = 0;
+         std::memcpy(
+           &low, validity + byte, std::min<std::size_t>(8, available));
+         std::uint64_t word = low >> shift;
+
+         if (shift > 0 && available > 8) {
+            word |= static_cast<std::uint64_t>(validity[byte + 8])
+              << (64 - shift);
+         }
+
+         return count == 64 ? word
+                            : word & ((std::uint64_t { 1 } << count) - 1);
+      }
+
+      /**
+       * @brief Entrega um lote de valores a um acumulador com feedBatch(),
+       * ignorando lotes vazios.
+       *
+       * @tparam ACCUMULATOR Tipo do acumulador.
+       *
+       * @param accumulator O acumulador.
+       * @param values Os valores.
+       */
+      template <typename ACCUMULATOR>
+      static void apply(
+        ACCUMULATOR& accumulator, std::span<TYPE const> values) {
+         if (!values.empty()) {
+            feedBatch(accumulator, values);
+         }
+      }
+
+  public:
+      /**
+       * @brief Assume a posse de um array exportado.
+       *
+       * @param array O array. É movido e fica marcado como liberado.
+       * @param schema O tipo do array. É movido e fica marcado como liberado.
+       *
+       * @throws std::runtime_error se alguma estrutura já estiver liberada,
+       * se o formato não corresponder a TYPE ou se o array não for
+       * primitivo. As estruturas são liberadas nesse caso.
+       */
+      ArrowColumn(ArrowArray* array, ArrowSchema* schema)
+          : array(std::exchange(*array, ArrowArray {})),
+            schema(std::exchange(*schema, ArrowSchema {})) {
+         try {
+            if (this->array.release == nullptr
+              || this->schema.release == nullptr) {
+               throw std::runtime_error("Arrow structure is already released");
+            }
+
+            if (this->schema.format == nullptr
+              || this->schema.format != expectedFormat()) {
+               throw std::runtime_error("Arrow format '"
+                 + std::string(this->schema.format ? this->schema.format : "")
+                 + "' does not match the requested type");
+            }
+
+            if (this->schema.dictionary != nullptr
+              || this->array.n_buffers != 2 || this->array.length < 0
+              || this->array.offset < 0) {
+               throw std::runtime_error("Arrow array is not primitive");
+            }
+         } catch (...) {
+            release();
+            throw;
+         }
+
+         length = static_cast<std::size_t>(this->array.length);
+         bitOffset = static_cast<std::size_t>(this->array.offset);
+         validity = static_cast<std::uint8_t const*>(this->array.buffers[0]);
+         data = static_cast<TYPE const*>(this->array.buffers[1]);
+         if (data != nullptr) {
+            data += bitOffset;
+         }
+         if (this->array.null_count == 0) {
+            validity = nullptr;
+         }
+      }
+
+      ArrowColumn(ArrowColumn const&) = delete;
+      ArrowColumn& operator=(ArrowColumn const&) = delete;
+
+      /**
+       * @brief Construtor de movimento.
+       *
+       * @param other O objeto movido.
+       */
+      ArrowColumn(ArrowColumn&& other) noexcept
+          : array(std::exchange(other.array, ArrowArray {})),
+            schema(std::exchange(other.schema, ArrowSchema {})),
+            data(std::exchange(other.data, nullptr)),
+            validity(std::exchange(other.validity, nullptr)),
+            length(std::exchange(other.length, 0)),
+            bitOffset(std::exchange(other.bitOffset, 0)) { }
+
+      /**
+       * @brief Atribuição por movimento.
+       *
+       * @param other O objeto movido.
+       *
+       * @return A referência do objeto de ArrowColumn atual.
+       */
+      ArrowColumn& operator=(ArrowColumn&& other) noexcept {
+         if (this != &other) {
+            release();
+            array = std::exchange(other.array, ArrowArray {});
+            schema = std::exchange(other.schema, ArrowSchema {});
+            data = std::exchange(other.data, nullptr);
+            validity = std::exchange(other.validity, nullptr);
+            length = std::exchange(other.length, 0);
+            bitOffset = std::exchange(other.bitOffset, 0);
+         }
+
+         return *this;
+      }
+
+      /**
+       * @brief Destrutor que devolve os buffers ao produtor.
+       */
+      ~ArrowColumn() { release(); }
+
+      /**
+       * @brief Retorna o número de posições do array, incluindo os nulos.
+       *
+       * @return O número de posições.
+       */
+      std::size_t size() const { return length; }
+
+      /**
+       * @brief Conta os nulos, usando o valor do produtor quando ele o
+       * informou.
+       *
+       * @return O número de nulos.
+       */
+      std::size_t nullCount() const {
+         if (validity == nullptr) {
+            return 0;
+         }
+         if (array.null_count >= 0) {
+            return static_cast<std::size_t>(array.null_count);
+         }
+
+         std::size_t valid = 0;
+         for (std::size_t first = 0; first < length; first += 64) {
+            valid += std::popcount(
+              validityBits(first, std::min<std::size_t>(64, length - first)));
+         }
+
+         return length - valid;
+      }
+
+      /**
+       * @brief Retorna os valores, incluindo as posições nulas, cujo
+       * conteúdo é indefinido.
+       *
+       * @return Os valores, válidos enquanto o objeto existir.
+       */
+      std::span<TYPE const> values() const {
+         return std::span<TYPE const>(data, data == nullptr ? 0 : length);
+      }
+
+      /**
+       * @brief Informa se uma posição é válida, isto é, não nula.
+       *
+       * @param index A posição.
+       *
+       * @return True se a posição tem um valor e False se é nula.
+       */
+      bool isValid(std::size_t index) const {
+         if (validity == nullptr) {
+            return true;
+         }
+
+         std::size_t bit = bitOffset + index;
+         return (validity[bit / 8] >> (bit % 8)) & 1;
+      }
+
+      /**
+       * @brief Cria uma visão de estatísticas sobre os valores, sem cópia.
+       *
+       * @param populationData Define se os valores são de dados de população
+       * ou de uma amostra. O padrão é True.
+       *
+       * @return A visão.
+       *
+       * @throws std::runtime_error se o array tiver nulos; nesse caso use
+       * accumulate().
+       */
+      StatisticsView<TYPE> view(bool populationData = true) const {
+         if (nullCount() > 0) {
+            throw std::runtime_error(
+              "Arrow array has nulls; use accumulate instead");
+         }
+
+         return StatisticsView<TYPE>(values(), populationData);
+      }
+
+      /**
+       * @brief Entrega os valores não nulos a um acumulador, em ordem.
+       *
+       * @tparam ACCUMULATOR Tipo do acumulador: qualquer um
+       * aceito por feedBatch().
+       *
+       * @param accumulator O acumulador.
+       *
+       * @return A referência do acumulador.
+       */
+      template <typename ACCUMULATOR>
+      ACCUMULATOR& accumulate(ACCUMULATOR& accumulator) const {
+         if (validity == nullptr) {
+            apply(accumulator, values());
+            return accumulator;
+         }
+
+         std::vector<TYPE> pending;
+         pending.reserve(batchSize + 64);
+         std::size_t runStart = length;
+
+         for (std::size_t first = 0; first < length; first += 64) {
+            std::size_t count = std::min<std::size_t>(64, length - first);
+            std::uint64_t word = validityBits(first, count);
+            std::uint64_t full = count == 64
+              ? ~std::uint64_t { 0 }
+              : (std::uint64_t { 1 } << count) - 1;
+
+            if (word == full) {
+               if (runStart == length) {
+                  apply(accumulator, std::span<TYPE const>(pending));
+                  pending.clear();
+                  runStart = first;
+               }
+               continue;
+            }
+
+            if (runStart != length) {
+               apply(accumulator,
+                 std::span<TYPE const>(data + runStart, first - runStart));
+               runStart = length;
+            }
+
+            if (word == 0) {
+               continue;
+            }
+
+            std::size_t size = pending.size();
+            pending.resize(size + count);
+            for (std::size_t i = 0; i < count; ++i) {
+               pending[size] = data[first + i];
+               size += (word >> i) & 1;
+            }
+            pending.resize(size);
+
+            if (pending.size() >= batchSize) {
+               apply(accumulator, std::span<TYPE const>(pending));
+               pending.clear();
+            }
+         }
+
+         if (runStart != length) {
+            apply(accumulator,
+              std::span<TYPE const>(data + runStart, length - runStart));
+         }
+         apply(accumulator, std::span<TYPE const>(pending));
+
+         return accumulator;
+      }
+   };
+}
+
+#endif /// ARROW_COLUMN_HPP_
@@ -0,0 +1,287 @@
+/**
+ * @file ChunkedReader.hpp
+ * @author Pedro Lucas (pedrolucas.jsrn@gmail.com)
+ * @brief Arquivo de cabeçalho para a classe ChunkedReader.
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef CHUNKED_READER_HPP_
+#define CHUNKED_READER_HPP_
+
+#include "Generator.hpp"
+#include "MappedColumn.hpp"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace stats {
+   /**
+    * @class ChunkedReader
+    * @brief Lê um arquivo de coluna (o formato de MappedColumn) maior que a
+    * memória em pedaços de tamanho fixo, com leitura antecipada em uma
+    * thread própria.
+    *
+    * Uma thread leitora preenche um anel de buffers com pread() enquanto o
+    * chamador processa o pedaço anterior, de modo que o cálculo sobre o
+    * pedaço k se sobrepõe à leitura dos pedaços seguintes. Com três buffers
+    * (o padrão), um pedaço está sendo processado, um está pronto e um está
+    * sendo lido. A memória usada é fixa: bufferCount * chunkValues valores.
+    *
+    * Os pedaços podem alimentar qualquer acumulador em lotes, com next() ou
+    * com accumulate() sobre chunks(), e StreamingStatistics,
+    * QuantileSketch e HyperLogLog dão os mesmos resultados que teriam com o
+    * arquivo inteiro na memória.
+    *
+    * @tparam TYPE Define o tipo de dados. Deve ser um tipo numérico.
+    */
+   template <typename TYPE>
+   class ChunkedReader {
+      static_assert(std::is_arithmetic_v<TYPE>, "TYPE must be a numeric type");
+
+  private:
+      int descriptor = -1;
+      std::size_t dataOffset = 0;
+      std::size_t valueCount = 0;
+      std::size_t chunkValues;
+      std::vector<std::vector<TYPE>> buffers;
+      std::vector<std::size_t> bufferSizes;
+
+      std::mutex mutex;
+      std::condition_variable changed;
+      std::size_t produced = 0;
+      std::size_t released = 0;
+      std::size_t taken = 0;
+      bool holding = false;
+      bool stopping = false;
+      std::string error;
+      std::thread reader;
+
+      /**
+       * @brief Lê bytes de uma posição do arquivo, repetindo leituras
+       * parciais.
+       *
+       * @param destination O destino.
+       * @param bytes O número de bytes.
+       * @param offset A posição no arquivo.
+       *
+       * @return True se todos os bytes foram lidos e False caso contrário.
+       */
+      bool readFully(void* destination, std::size_t bytes, std::size_t offset) {
+         auto target = static_cast<char*>(destination);
+
+         while (bytes > 0) {
+            ssize_t count
+              = pread(descriptor, target, bytes, static_cast<off_t>(offset));
+            if (count < 0 && errno == EINTR) {
+               continue;
+            }
+            if (count == 0) {
+               errno = 0;
+            }
+            if (count <= 0) {
+               return false;
+            }
+
+            target += count;
+            offset += count;
+            bytes -= count;
+         }
+
+         return true;
+      }
+
+      /**
+       * @brief Laço da thread leitora.
+       */
+      void readAhead() {
+         std::size_t chunkCount = (valueCount + chunkValues - 1) / chunkValues;
+
+         for (std::size_t chunk = 0; chunk < chunkCount; ++chunk) {
+            std::size_t slot = chunk % buffers.size();
+
+            {
+               std::unique_lock lock(mutex);
+               changed.wait(lock, [&] {
+                  return stopping || chunk - released < buffers.size();
+               });
+
+               if (stopping) {
+                  return;
+               }
+            }
+
+            std::size_t first = chunk * chunkValues;
+            std::size_t size = std::min(chunkValues, valueCount - first);
+            bool ok = readFully(buffers[slot].data(),
+              size * sizeof(TYPE),
+              dataOffset + first * sizeof(TYPE));
+            int code = errno;
+
+            {
+               std::lock_guard lock(mutex);
+               if (!ok) {
+                  error = std::string("Could not read file: ")
+                    + (code == 0 ? "unexpected end of file"
+                                 : std::strerror(code));
+                  changed.notify_all();
+                  return;
+               }
+
+               bufferSizes[slot] = size;
+               ++produced;
+            }
+
+            changed.notify_all();
+         }
+      }
+
+  public:
+      /**
+       * @brief Abre o arquivo e inicia a leitura antecipada.
+       *
+       * @param path O caminho do arquivo, com ou sem o cabeçalho de
+       * MappedColumn.
+       * @param chunkValues O número de valores de cada pedaço. O padrão é
+       * 1 Mi valores.
+       * @param bufferCount O número de buffers, pelo menos 2. O padrão é 3.
+       *
+       * @throws std::runtime_error se o arquivo não puder ser aberto ou não
+       * for um arquivo de coluna de TYPE.
+       */
+      ChunkedReader(std::string const& path,
+        std::size_t chunkValues = std::size_t { 1 } << 20,
+        std::size_t bufferCount = 3)
+          : chunkValues(std::max<std::size_t>(chunkValues, 1)),
+            buffers(std::max<std::size_t>(bufferCount, 2)),
+            bufferSizes(buffers.size(), 0) {
+         descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+         if (descriptor < 0) {
+            throw std::runtime_error("Could not open file '" + path
+              + "': " + std::strerror(errno));
+         }
+
+         try {
+            struct stat status;
+            if (fstat(descriptor, &status) != 0) {
+               throw std::runtime_error("Could not stat file '" + path
+                 + "': " + std::strerror(errno));
+            }
+
+            auto fileBytes = static_cast<std::size_t>(status.st_size);
+            std::array<std::uint8_t, MappedColumn<TYPE>::headerSize> head {};
+            std::size_t headBytes = std::min(head.size(), fileBytes);
+            if (!readFully(head.data(), headBytes, 0)) {
+               throw std::runtime_error("Could not read file '" + path + "'");
+            }
+
+            auto [offset, count] = MappedColumn<TYPE>::layout(
+              std::span<std::uint8_t const>(head.data(), headBytes), fileBytes);
+            dataOffset = offset;
+            valueCount = count;
+         } catch (...) {
+            close(descriptor);
+            throw;
+         }
+
+#if defined(POSIX_FADV_SEQUENTIAL)
+         posix_fadvise(descriptor, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+         for (auto& buffer : buffers) {
+            buffer.resize(std::min(this->chunkValues, valueCount));
+         }
+
+         reader = std::thread([this] { readAhead(); });
+      }
+
+      ChunkedReader(ChunkedReader const&) = delete;
+      ChunkedReader& operator=(ChunkedReader const&) = delete;
+
+      /**
+       * @brief Destrutor que interrompe a leitura antecipada e fecha o
+       * arquivo.
+       */
+      ~ChunkedReader() {
+         {
+            std::lock_guard lock(mutex);
+            stopping = true;
+         }
+
+         changed.notify_all();
+         reader.join();
+         close(descriptor);
+      }
+
+      /**
+       * @brief Retorna o número de valores do arquivo.
+       *
+       * @return O número de valores.
+       */
+      std::size_t size() const { return valueCount; }
+
+      /**
+       * @brief Retorna o próximo pedaço, esperando a leitura dele se
+       * necessário. O pedaço anterior é devolvido à thread leitora.
+       *
+       * @return O pedaço, válido até a próxima chamada, ou vazio no fim do
+       * arquivo.
+       *
+       * @throws std::runtime_error se a leitura falhar.
+       */
+      std::span<TYPE const> next() {
+         std::unique_lock lock(mutex);
+
+         if (holding) {
+            holding = false;
+            ++released;
+            changed.notify_all();
+         }
+
+         if (taken * chunkValues >= valueCount) {
+            return {};
+         }
+
+         changed.wait(lock, [&] { return taken < produced || !error.empty(); });
+         if (taken >= produced) {
+            throw std::runtime_error(error);
+         }
+
+         std::size_t slot = taken % buffers.size();
+         ++taken;
+         holding = true;
+
+         return std::span<TYPE const>(buffers[slot].data(), bufferSizes[slot]);
+      }
+
+      /**
+       * @brief Retorna um gerador com os pedaços restantes.
+       *
+       * @return O gerador de lotes.
+       */
+      BatchGenerator<TYPE> chunks() {
+         for (auto chunk = next(); !chunk.empty(); chunk = next()) {
+            co_yield chunk;
+         }
+      }
+   };
+}
+
+#endif /// CHUNKED_READER_HPP_
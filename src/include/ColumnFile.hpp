@@ -0,0 +1,605 @@
+/**
+ * @file ColumnFile.hpp
+ * @author Pedro Lucas (pedrolucas.jsrn@gmail.com)
+ * @brief Arquivo de cabeçalho para a classe ColumnFile.
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef COLUMN_FILE_HPP_
+#define COLUMN_FILE_HPP_
+
+#include "Generator.hpp"
+#include "MappedColumn.hpp"
+#include "Serialization.hpp"
+#include "StreamingStatistics.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace stats {
+   /**
+    * @brief A codificação de um bloco de ColumnFile.
+    */
+   enum class BlockEncoding : std::uint8_t {
+      /// Os valores sem compressão.
+      Plain = 0,
+      /// A diferença de cada valor para o mínimo do bloco, com o menor número
+      /// de bits que cabe a maior diferença.
+      FrameOfReference = 1,
+      /// O primeiro valor e as diferenças entre valores vizinhos, empacotadas
+      /// como em FrameOfReference. Bom para valores ordenados ou quase
+      /// ordenados, como instantes de tempo.
+      Delta = 2
+   };
+
+   /**
+    * @class ColumnFile
+    * @brief Um formato de arquivo em blocos para uma coluna numérica, com um
+    * resumo por bloco (zone map) e compressão leve para inteiros.
+    *
+    * Cada bloco guarda a contagem, a soma, o M2, o mínimo e o máximo dos seus
+    * valores em um diretório no início do arquivo, então média, variância e
+    * amplitude do arquivo inteiro saem só do diretório, sem ler os valores.
+    * Consultas restritas a um intervalo de valores usam os resumos para
+    * pular os blocos fora do intervalo e para aproveitar inteiros os blocos
+    * contidos nele; só os blocos que cruzam os limites são decodificados.
+    *
+    * Blocos de inteiros são gravados na menor entre as codificações Plain,
+    * FrameOfReference e Delta; blocos de ponto flutuante são sempre Plain e
+    * são lidos diretamente do mapeamento, sem cópia. A decodificação é um
+    * laço sem desvios sobre palavras de 64 bits, feito um bloco por vez em
+    * um buffer reaproveitado que é reduzido em seguida, enquanto ainda está
+    * no cache.
+    *
+    * @tparam TYPE Define o tipo de dados. Deve ser um tipo numérico.
+    */
+   template <typename TYPE>
+   class ColumnFile {
+      static_assert(std::is_arithmetic_v<TYPE>, "TYPE must be a numeric type");
+      static_assert(std::endian::native == std::endian::little,
+        "ColumnFile requires a little-endian machine");
+
+  public:
+      /**
+       * @brief O resumo de um bloco.
+       */
+      struct Zone {
+         std::uint64_t offset = 0;
+         std::uint64_t bytes = 0;
+         std::uint32_t count = 0;
+         BlockEncoding encoding = BlockEncoding::Plain;
+         std::uint8_t bitWidth = 0;
+         double sum = 0;
+         double m2 = 0;
+         TYPE minValue {};
+         TYPE maxValue {};
+
+         /**
+          * @brief Retorna o resumo como um acumulador.
+          *
+          * @param populationData Define se os valores são de dados de
+          * população ou de uma amostra. O padrão é True.
+          *
+          * @return O acumulador com os momentos do bloco.
+          */
+         StreamingStatistics<TYPE> statistics(
+           bool populationData = true) const {
+            return StreamingStatistics<TYPE>::fromMoments(
+              count, sum / count, m2, minValue, maxValue, populationData);
+         }
+      };
+
+  private:
+      static constexpr std::uint32_t tag = serializationTag("SBLK");
+      static constexpr std::uint16_t version = 1;
+      static constexpr std::size_t headerSize = 32;
+      static constexpr std::size_t zoneSize = 40 + 2 * sizeof(TYPE);
+
+      MappedColumn<std::uint8_t> file;
+      std::vector<Zone> zones;
+      std::uint64_t valueCount = 0;
+      std::uint32_t blockSize = 0;
+
+      /**
+       * @brief Converte um valor para 64 bits sem sinal, com aritmética
+       * módulo 2^64.
+       *
+       * @param value O valor.
+       *
+       * @return O valor convertido.
+       */
+      static std::uint64_t toBits(TYPE value) {
+         return static_cast<std::uint64_t>(value);
+      }
+
+      /**
+       * @brief Retorna o número de bytes de um bloco empacotado, incluindo
+       * a palavra extra lida pela decodificação sem desvios.
+       *
+       * @param count O número de valores empacotados.
+       * @param bitWidth O número de bits de cada valor.
+       *
+       * @return O número de bytes.
+       */
+      static std::size_t packedBytes(std::size_t count, unsigned bitWidth) {
+         return ((count * bitWidth + 63) / 64 + 1) * sizeof(std::uint64_t);
+      }
+
+      /**
+       * @brief Empacota valores com bitWidth bits cada.
+       *
+       * @param values Os valores, já menores que 2^bitWidth.
+       * @param bitWidth O número de bits de cada valor.
+       * @param writer O destino.
+       */
+      static void pack(std::span<std::uint64_t const> values,
+        unsigned bitWidth,
+        ByteWriter& writer) {
+         std::vector<std::uint64_t> words(
+           packedBytes(values.size(), bitWidth) / sizeof(std::uint64_t), 0);
+
+         for (std::size_t i = 0; i < values.size() && bitWidth > 0; ++i) {
+            std::size_t bit = i * bitWidth;
+            std::size_t shift = bit % 64;
+            words[bit / 64] |= values[i] << shift;
+            if (shift + bitWidth > 64) {
+               words[bit / 64 + 1] |= values[i] >> (64 - shift);
+            }
+         }
+
+         writer.writeBytes(words.data(), words.size() * sizeof(std::uint64_t));
+      }
+
+      /**
+       * @brief Desempacota valores e soma a referência a cada um.
+       *
+       * As duas palavras que podem conter um valor são sempre lidas, e os
+       * deslocamentos ficam abaixo de 64, então o laço não tem desvios.
+       *
+       * @param words As palavras empacotadas, com uma palavra extra no fim.
+       * @param bitWidth O número de bits de cada valor.
+       * @param reference O valor somado a cada um.
+       * @param output O destino.
+       */
+      static void unpack(std::uint64_t const* words,
+        unsigned bitWidth,
+        std::uint64_t reference,
+        std::span<TYPE> output) {
+         if (bitWidth == 0) {
+            std::fill(
+              output.begin(), output.end(), static_cast<TYPE>(reference));
+            return;
+         }
+
+         std::uint64_t mask = bitWidth == 64
+           ? std::numeric_limits<std::uint64_t>::max()
+           : (std::uint64_t { 1 } << bitWidth) - 1;
+
+         for (std::size_t i = 0; i < output.size(); ++i) {
+            std::size_t bit = i * bitWidth;
+            std::size_t shift = bit % 64;
+            std::uint64_t low = words[bit / 64] >> shift;
+            std::uint64_t high = (words[bit / 64 + 1] << 1) << (63 - shift);
+            output[i] = static_cast<TYPE>(reference + ((low | high) & mask));
+         }
+      }
+
+      /**
+       * @brief Codifica um bloco, escolhendo a menor codificação.
+       *
+       * @param values Os valores do bloco.
+       * @param zone O resumo do bloco, com mínimo e máximo preenchidos.
+       *
+       * @return Os bytes do bloco.
+       */
+      static ByteWriter encode(std::span<TYPE const> values, Zone& zone) {
+         ByteWriter writer;
+         zone.encoding = BlockEncoding::Plain;
+         zone.bitWidth = 0;
+
+         if constexpr (std::is_integral_v<TYPE>) {
+            std::uint64_t reference = toBits(zone.minValue);
+            unsigned frameWidth
+              = std::bit_width(toBits(zone.maxValue) - reference);
+
+            std::int64_t minDelta = 0;
+            std::int64_t maxDelta = 0;
+            for (std::size_t i = 1; i < values.size(); ++i) {
+               auto delta = static_cast<std::int64_t>(
+                 toBits(values[i]) - toBits(values[i - 1]));
+               minDelta = i == 1 ? delta : std::min(minDelta, delta);
+               maxDelta = i == 1 ? delta : std::max(maxDelta, delta);
+            }
+            unsigned deltaWidth = std::bit_width(static_cast<std::uint64_t>(
+              maxDelta) - static_cast<std::uint64_t>(minDelta));
+
+            std::size_t plainBytes = values.size_bytes();
+            std::size_t frameBytes = 8 + packedBytes(values.size(), frameWidth);
+            std::size_t deltaBytes
+              = 16 + packedBytes(values.size() - 1, deltaWidth);
+
+            std::vector<std::uint64_t> offsets;
+            if (deltaBytes < frameBytes && deltaBytes < plainBytes) {
+               zone.encoding = BlockEncoding::Delta;
+               zone.bitWidth = static_cast<std::uint8_t>(deltaWidth);
+               for (std::size_t i = 1; i < values.size(); ++i) {
+                  offsets.push_back(toBits(values[i]) - toBits(values[i - 1])
+                    - static_cast<std::uint64_t>(minDelta));
+               }
+
+               writer.write(toBits(values[0]));
+               writer.write(static_cast<std::uint64_t>(minDelta));
+               pack(offsets, deltaWidth, writer);
+               return writer;
+            }
+
+            if (frameBytes < plainBytes) {
+               zone.encoding = BlockEncoding::FrameOfReference;
+               zone.bitWidth = static_cast<std::uint8_t>(frameWidth);
+               for (auto const& value : values) {
+                  offsets.push_back(toBits(value) - reference);
+               }
+
+               writer.write(reference);
+               pack(offsets, frameWidth, writer);
+               return writer;
+            }
+         }
+
+         writer.writeBytes(values.data(), values.size_bytes());
+         return writer;
+      }
+
+      /**
+       * @brief Lê e valida o diretório de blocos.
+       *
+       * @throws std::runtime_error se o arquivo for de outro tipo ou estiver
+       * corrompido.
+       */
+      void readDirectory() {
+         auto bytes = file.values();
+         ByteReader reader(bytes);
+         reader.readHeader(tag, version);
+
+         auto typeSize = reader.read<std::uint16_t>();
+         auto floatingPoint = reader.read<std::uint8_t>();
+         auto isSigned = reader.read<std::uint8_t>();
+         if (typeSize != sizeof(TYPE)
+           || floatingPoint != std::is_floating_point_v<TYPE>
+           || isSigned != std::is_signed_v<TYPE>) {
+            throw std::runtime_error("Column file has another type");
+         }
+
+         blockSize = reader.read<std::uint32_t>();
+         valueCount = reader.read<std::uint64_t>();
+         auto blockCount = reader.read<std::uint64_t>();
+         reader.read<std::uint16_t>();
+
+         if (blockCount > (bytes.size() - headerSize) / zoneSize) {
+            throw std::runtime_error("Column file is truncated");
+         }
+
+         ByteReader directory(bytes.subspan(headerSize));
+         std::uint64_t total = 0;
+         zones.resize(blockCount);
+
+         for (auto& zone : zones) {
+            zone.offset = directory.read<std::uint64_t>();
+            zone.bytes = directory.read<std::uint64_t>();
+            zone.count = directory.read<std::uint32_t>();
+            zone.encoding = directory.read<BlockEncoding>();
+            zone.bitWidth = directory.read<std::uint8_t>();
+            directory.read<std::uint16_t>();
+            zone.sum = directory.read<double>();
+            zone.m2 = directory.read<double>();
+            zone.minValue = directory.read<TYPE>();
+            zone.maxValue = directory.read<TYPE>();
+            total += zone.count;
+
+            if (zone.count == 0 || zone.count > blockSize
+              || zone.offset % sizeof(std::uint64_t) != 0
+              || zone.offset > bytes.size()
+              || zone.bytes > bytes.size() - zone.offset
+              || zone.bytes < minimumBytes(zone)) {
+               throw std::runtime_error("Column file is corrupt");
+            }
+         }
+
+         if (total != valueCount) {
+            throw std::runtime_error("Column file is corrupt");
+         }
+      }
+
+      /**
+       * @brief Calcula o tamanho mínimo de um bloco válido.
+       *
+       * @param zone O resumo do bloco.
+       *
+       * @return O número de bytes.
+       *
+       * @throws std::runtime_error se a codificação for desconhecida.
+       */
+      static std::size_t minimumBytes(Zone const& zone) {
+         if (zone.bitWidth > 64) {
+            throw std::runtime_error("Column file is corrupt");
+         }
+
+         switch (zone.encoding) {
+         case BlockEncoding::Plain:
+            return zone.count * sizeof(TYPE);
+         case BlockEncoding::FrameOfReference:
+            return 8 + packedBytes(zone.count, zone.bitWidth);
+         case BlockEncoding::Delta:
+            return 16 + packedBytes(zone.count - 1, zone.bitWidth);
+         }
+
+         throw std::runtime_error("Column file has an unknown block encoding");
+      }
+
+  public:
+      /**
+       * @brief Abre um arquivo escrito por ColumnFile::write.
+       *
+       * @param path O caminho do arquivo.
+       *
+       * @throws std::runtime_error se o arquivo não puder ser mapeado, for de
+       * outro tipo ou estiver corrompido.
+       */
+      explicit ColumnFile(std::string const& path) : file(path) {
+         readDirectory();
+      }
+
+      /**
+       * @brief Escreve os valores em um arquivo em blocos.
+       *
+       * @param path O caminho do arquivo.
+       * @param values Os valores.
+       * @param blockSize O número de valores de cada bloco, exceto talvez o
+       * último. O padrão é 16384.
+       *
+       * @throws std::runtime_error se blockSize for 0 ou se o arquivo não
+       * puder ser escrito.
+       */
+      static void write(std::string const& path,
+        std::span<TYPE const> values,
+        std::uint32_t blockSize = 16384) {
+         if (blockSize == 0) {
+            throw std::runtime_error("Block size must be positive");
+         }
+
+         std::size_t blockCount = (values.size() + blockSize - 1) / blockSize;
+         std::vector<Zone> zones(blockCount);
+         std::uint64_t offset = headerSize + blockCount * zoneSize;
+         offset += (8 - offset % 8) % 8;
+
+         std::ofstream output(path, std::ios::binary | std::ios::trunc);
+         std::vector<std::uint8_t> empty(offset, 0);
+         output.write(reinterpret_cast<char const*>(empty.data()), offset);
+
+         for (std::size_t block = 0; block < blockCount; ++block) {
+            std::size_t first = block * blockSize;
+            auto blockValues = values.subspan(first,
+              std::min<std::size_t>(blockSize, values.size() - first));
+            StreamingStatistics<TYPE> summary;
+            summary.pushBatch(blockValues);
+
+            Zone& zone = zones[block];
+            zone.count = static_cast<std::uint32_t>(blockValues.size());
+            zone.sum = summary.sum();
+            zone.m2 = summary.sumOfSquaredDeviations();
+            zone.minValue = summary.min();
+            zone.maxValue = summary.max();
+
+            auto bytes = encode(blockValues, zone).release();
+            bytes.resize(bytes.size() + (8 - bytes.size() % 8) % 8, 0);
+            zone.offset = offset;
+            zone.bytes = bytes.size();
+            offset += bytes.size();
+
+            output.write(
+              reinterpret_cast<char const*>(bytes.data()), bytes.size());
+         }
+
+         ByteWriter directory;
+         directory.writeHeader(tag, version);
+         directory.write(static_cast<std::uint16_t>(sizeof(TYPE)));
+         directory.write(
+           static_cast<std::uint8_t>(std::is_floating_point_v<TYPE>));
+         directory.write(static_cast<std::uint8_t>(std::is_signed_v<TYPE>));
+         directory.write(blockSize);
+         directory.write(static_cast<std::uint64_t>(values.size()));
+         directory.write(static_cast<std::uint64_t>(blockCount));
+         directory.write(std::uint16_t { 0 });
+
+         for (auto const& zone : zones) {
+            directory.write(zone.offset);
+            directory.write(zone.bytes);
+            directory.write(zone.count);
+            directory.write(zone.encoding);
+            directory.write(zone.bitWidth);
+            directory.write(std::uint16_t { 0 });
+            directory.write(zone.sum);
+            directory.write(zone.m2);
+            directory.write(zone.minValue);
+            directory.write(zone.maxValue);
+         }
+
+         auto bytes = directory.release();
+         output.seekp(0);
+         output.write(
+           reinterpret_cast<char const*>(bytes.data()), bytes.size());
+
+         if (!output) {
+            throw std::runtime_error("Could not write file '" + path + "'");
+         }
+      }
+
+      /**
+       * @brief Retorna o número de valores do arquivo.
+       *
+       * @return O número de valores.
+       */
+      std::size_t size() const { return valueCount; }
+
+      /**
+       * @brief Retorna o número de valores por bloco.
+       *
+       * @return O tamanho dos blocos, exceto talvez o último.
+       */
+      std::size_t getBlockSize() const { return blockSize; }
+
+      /**
+       * @brief Retorna os resumos dos blocos.
+       *
+       * @return Os resumos, na ordem do arquivo.
+       */
+      std::span<Zone const> getZones() const { return zones; }
+
+      /**
+       * @brief Calcula as estatísticas do arquivo inteiro só com os resumos
+       * dos blocos, sem ler os valores.
+       *
+       * @param populationData Define se os valores são de dados de população
+       * ou de uma amostra. O padrão é True.
+       *
+       * @return O acumulador com média, variância, mínimo e máximo.
+       */
+      StreamingStatistics<TYPE> summary(bool populationData = true) const {
+         StreamingStatistics<TYPE> result(populationData);
+         for (auto const& zone : zones) {
+            result.merge(zone.statistics(populationData));
+         }
+
+         return result;
+      }
+
+      /**
+       * @brief Calcula as estatísticas dos valores em [lower, upper].
+       *
+       * Blocos fora do intervalo são pulados, blocos contidos nele entram
+       * pelo resumo e só os que cruzam os limites são decodificados.
+       *
+       * @param lower O menor valor aceito.
+       * @param upper O maior valor aceito.
+       * @param populationData Define se os valores são de dados de população
+       * ou de uma amostra. O padrão é True.
+       *
+       * @return O acumulador com os valores do intervalo.
+       */
+      StreamingStatistics<TYPE> summaryBetween(
+        TYPE lower, TYPE upper, bool populationData = true) const {
+         StreamingStatistics<TYPE> result(populationData);
+         std::vector<TYPE> buffer;
+         std::vector<TYPE> selected;
+
+         for (std::size_t block = 0; block < zones.size(); ++block) {
+            Zone const& zone = zones[block];
+            if (zone.maxValue < lower || zone.minValue > upper) {
+               continue;
+            }
+
+            if (zone.minValue >= lower && zone.maxValue <= upper) {
+               result.merge(zone.statistics(populationData));
+               continue;
+            }
+
+            selected.clear();
+            for (auto const& value : decodeBlock(block, buffer)) {
+               if (value >= lower && value <= upper) {
+                  selected.push_back(value);
+               }
+            }
+
+            result.pushBatch(std::span<TYPE const>(selected));
+         }
+
+         return result;
+      }
+
+      /**
+       * @brief Retorna os valores de um bloco.
+       *
+       * Blocos Plain são devolvidos diretamente do mapeamento; os outros são
+       * decodificados no buffer.
+       *
+       * @param block O índice do bloco.
+       * @param buffer O buffer usado na decodificação, reaproveitado entre
+       * chamadas.
+       *
+       * @return Os valores, válidos enquanto o objeto e o buffer existirem.
+       *
+       * @throws std::runtime_error se o índice for inválido.
+       */
+      std::span<TYPE const> decodeBlock(
+        std::size_t block, std::vector<TYPE>& buffer) const {
+         if (block >= zones.size()) {
+            throw std::runtime_error("Block index is out of range");
+         }
+
+         Zone const& zone = zones[block];
+         auto bytes = file.values().data() + zone.offset;
+
+         if (zone.encoding == BlockEncoding::Plain) {
+            return std::span<TYPE const>(
+              reinterpret_cast<TYPE const*>(bytes), zone.count);
+         }
+
+         auto words = reinterpret_cast<std::uint64_t const*>(bytes);
+         buffer.resize(zone.count);
+
+         if (zone.encoding == BlockEncoding::FrameOfReference) {
+            unpack(words + 1, zone.bitWidth, words[0], buffer);
+            return buffer;
+         }
+
+         unpack(words + 2,
+           zone.bitWidth,
+           words[1],
+           std::span<TYPE>(buffer).subspan(1));
+
+         std::uint64_t running = words[0];
+         buffer[0] = static_cast<TYPE>(running);
+         for (std::size_t i = 1; i < buffer.size(); ++i) {
+            running += toBits(buffer[i]);
+            buffer[i] = static_cast<TYPE>(running);
+         }
+
+         return buffer;
+      }
+
+      /**
+       * @brief Decodifica todos os blocos, em ordem, entregando cada um ao
+       * acumulador assim que é decodificado.
+       *
+       * @tparam ACCUMULATOR Tipo do acumulador: qualquer um
+       * aceito por feedBatch().
+       *
+       * @param accumulator O acumulador.
+       *
+       * @return A referência do acumulador.
+       */
+      template <typename ACCUMULATOR>
+      ACCUMULATOR& scan(ACCUMULATOR& accumulator) const {
+         std::vector<TYPE> buffer;
+         for (std::size_t block = 0; block < zones.size(); ++block) {
+            feedBatch(accumulator, decodeBlock(block, buffer));
+         }
+
+         return accumulator;
+      }
+   };
+}
+
+#endif /// COLUMN_FILE_HPP_
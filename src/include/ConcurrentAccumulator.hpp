@@ -0,0 +1,307 @@
+/**
+ * @file ConcurrentAccumulator.hpp
+ * @author Pedro Lucas (pedrolucas.jsrn@gmail.com)
+ * @brief Arquivo de cabeçalho para a classe ConcurrentAccumulator.
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef CONCURRENT_ACCUMULATOR_HPP_
+#define CONCURRENT_ACCUMULATOR_HPP_
+
+#include "StreamingStatistics.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace stats {
+   /**
+    * @class ConcurrentAccumulator
+    * @brief Um acumulador de contagem, média, variância, mínimo e máximo que
+    * várias threads podem alimentar ao mesmo tempo sem disputa.
+    *
+    * Cada thread escreve em um fragmento próprio, alinhado à linha de cache,
+    * criado na primeira escrita dela. O caminho de escrita não usa mutex nem
+    * instruções atômicas de leitura-modificação-escrita: só a thread dona
+    * escreve no fragmento, com cargas e armazenamentos relaxados (instruções
+    * comuns) protegidos por um contador de sequência (seqlock). Os leitores
+    * juntam os fragmentos sob demanda e repetem a leitura de um fragmento se
+    * ele mudou no meio da cópia.
+    *
+    * @tparam TYPE Define o tipo de dados. Deve ser um tipo numérico.
+    */
+   template <typename TYPE>
+   class ConcurrentAccumulator {
+      static_assert(std::is_arithmetic_v<TYPE>, "TYPE must be a numeric type");
+
+  private:
+      static constexpr std::size_t cacheLineSize = 64;
+
+      /**
+       * @brief O fragmento de uma thread.
+       */
+      struct alignas(cacheLineSize) Shard {
+         std::atomic<std::uint64_t> sequence { 0 };
+         std::atomic<std::uint64_t> count { 0 };
+         std::atomic<double> mean { 0 };
+         std::atomic<double> m2 { 0 };
+         std::atomic<TYPE> minValue { std::numeric_limits<TYPE>::max() };
+         std::atomic<TYPE> maxValue { std::numeric_limits<TYPE>::lowest() };
+
+         /**
+          * @brief Lê o estado do fragmento, escrito apenas pela thread dona.
+          *
+          * @return O estado atual.
+          */
+         StreamingStatistics<TYPE> loadOwned() const {
+            return StreamingStatistics<TYPE>::fromMoments(
+              count.load(std::memory_order_relaxed),
+              mean.load(std::memory_order_relaxed),
+              m2.load(std::memory_order_relaxed),
+              minValue.load(std::memory_order_relaxed),
+              maxValue.load(std::memory_order_relaxed));
+         }
+
+         /**
+          * @brief Publica um novo estado do fragmento.
+          *
+          * @param state O novo estado.
+          */
+         void store(StreamingStatistics<TYPE> const& state) {
+            auto current = sequence.load(std::memory_order_relaxed);
+            sequence.store(current + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            count.store(state.size(), std::memory_order_relaxed);
+            mean.store(state.mean(), std::memory_order_relaxed);
+            m2.store(state.sumOfSquaredDeviations(), std::memory_order_relaxed);
+            minValue.store(state.min(), std::memory_order_relaxed);
+            maxValue.store(state.max(), std::memory_order_relaxed);
+
+            sequence.store(current + 2, std::memory_order_release);
+         }
+
+         /**
+          * @brief Lê um estado consistente do fragmento a partir de outra
+          * thread.
+          *
+          * @return O estado lido.
+          */
+         StreamingStatistics<TYPE> loadShared() const {
+            while (true) {
+               auto before = sequence.load(std::memory_order_acquire);
+               if (before % 2 == 1) {
+                  continue;
+               }
+
+               auto state = loadOwned();
+               std::atomic_thread_fence(std::memory_order_acquire);
+
+               if (sequence.load(std::memory_order_relaxed) == before) {
+                  return state;
+               }
+            }
+         }
+      };
+
+      /**
+       * @brief Cache, por thread, do fragmento usado por último.
+       */
+      struct ThreadCache {
+         std::uint64_t owner = 0;
+         Shard* shard = nullptr;
+      };
+
+      /**
+       * @brief Os fragmentos das threads vivas e o acumulado das threads já
+       * encerradas. Fica vivo enquanto uma thread o estiver usando, mesmo
+       * que o acumulador seja destruído nesse meio-tempo.
+       */
+      struct Registry {
+         std::mutex mutex;
+         std::vector<std::unique_ptr<Shard>> shards;
+         StreamingStatistics<TYPE> retired;
+      };
+
+      /**
+       * @brief Fragmento de um acumulador na tabela de uma thread, com uma
+       * referência fraca que expira quando o acumulador é destruído.
+       */
+      struct OwnedShard {
+         std::weak_ptr<Registry> registry;
+         Shard* shard = nullptr;
+      };
+
+      /**
+       * @brief A tabela de fragmentos de uma thread. Quando a thread
+       * termina, o estado de cada fragmento vai para o acumulado das threads
+       * encerradas e o fragmento é removido do acumulador.
+       */
+      struct ThreadShards {
+         std::unordered_map<std::uint64_t, OwnedShard> entries;
+         std::size_t pruneAt = 16;
+
+         ~ThreadShards() {
+            for (auto const& [owner, entry] : entries) {
+               auto registry = entry.registry.lock();
+               if (registry == nullptr) {
+                  continue;
+               }
+
+               std::lock_guard lock(registry->mutex);
+               registry->retired.merge(entry.shard->loadOwned());
+               std::erase_if(registry->shards, [&](auto const& shard) {
+                  return shard.get() == entry.shard;
+               });
+            }
+         }
+      };
+
+      std::uint64_t id;
+      bool populationData;
+      std::shared_ptr<Registry> registry = std::make_shared<Registry>();
+
+      /**
+       * @brief Gera um identificador único para cada acumulador, usado como
+       * chave dos fragmentos de cada thread.
+       *
+       * @return O identificador.
+       */
+      static std::uint64_t nextId() {
+         static std::atomic<std::uint64_t> counter { 0 };
+         return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+      }
+
+      /**
+       * @brief Retorna o fragmento da thread atual, criando-o se necessário.
+       *
+       * @return O fragmento da thread atual.
+       */
+      Shard& localShard() {
+         thread_local ThreadCache cache;
+         if (cache.owner == id) {
+            return *cache.shard;
+         }
+
+         thread_local ThreadShards owned;
+
+         auto found = owned.entries.find(id);
+         if (found == owned.entries.end()) {
+            // Remove as entradas de acumuladores já destruídos quando a
+            // tabela dobra de tamanho, então ela acompanha só os vivos.
+            if (owned.entries.size() >= owned.pruneAt) {
+               std::erase_if(owned.entries, [](auto const& entry) {
+                  return entry.second.registry.expired();
+               });
+               owned.pruneAt
+                 = std::max<std::size_t>(16, 2 * owned.entries.size());
+            }
+
+            std::lock_guard lock(registry->mutex);
+            registry->shards.push_back(std::make_unique<Shard>());
+            OwnedShard entry { registry, registry->shards.back().get() };
+            found = owned.entries.emplace(id, std::move(entry)).first;
+         }
+
+         cache = { id, found->second.shard };
+         return *found->second.shard;
+      }
+
+  public:
+      /**
+       * @brief Construtor padrão.
+       *
+       * @param populationData Define se os valores são de dados de população ou
+       * de uma amostra. O padrão é True.
+       */
+      ConcurrentAccumulator(bool populationData = true)
+          : id(nextId()), populationData(populationData) {
+         registry->retired = StreamingStatistics<TYPE>(populationData);
+      }
+
+      ConcurrentAccumulator(ConcurrentAccumulator const&) = delete;
+      ConcurrentAccumulator& operator=(ConcurrentAccumulator const&) = delete;
+
+      /**
+       * @brief Adiciona um valor no fragmento da thread atual.
+       *
+       * @param value O valor a ser adicionado.
+       *
+       * @return A referência do objeto de ConcurrentAccumulator atual.
+       */
+      ConcurrentAccumulator& push(TYPE value) {
+         Shard& shard = localShard();
+         auto state = shard.loadOwned();
+         shard.store(state.push(value));
+
+         return *this;
+      }
+
+      /**
+       * @brief Adiciona um lote de valores no fragmento da thread atual.
+       *
+       * O lote é reduzido localmente e publicado com uma única escrita no
+       * fragmento.
+       *
+       * @param values Os valores a serem adicionados.
+       *
+       * @return A referência do objeto de ConcurrentAccumulator atual.
+       */
+      ConcurrentAccumulator& pushBatch(std::span<TYPE const> values) {
+         if (values.empty()) {
+            return *this;
+         }
+
+         Shard& shard = localShard();
+         auto state = shard.loadOwned();
+         shard.store(state.pushBatch(values));
+
+         return *this;
+      }
+
+      /**
+       * @brief Junta os fragmentos de todas as threads.
+       *
+       * Pode ser chamado enquanto outras threads escrevem. Cada fragmento é
+       * lido de forma consistente, mas fragmentos diferentes podem refletir
+       * instantes ligeiramente diferentes. Os valores de threads já
+       * encerradas entram pelo acumulado delas.
+       *
+       * @return O acumulado de todas as threads.
+       */
+      StreamingStatistics<TYPE> snapshot() const {
+         std::lock_guard lock(registry->mutex);
+         StreamingStatistics<TYPE> total(registry->retired);
+
+         for (auto const& shard : registry->shards) {
+            total.merge(shard->loadShared());
+         }
+
+         return total;
+      }
+
+      /**
+       * @brief Retorna o número de threads vivas que já escreveram no
+       * acumulador.
+       *
+       * @return O número de fragmentos.
+       */
+      std::size_t shardCount() const {
+         std::lock_guard lock(registry->mutex);
+         return registry->shards.size();
+      }
+   };
+}
+
+#endif /// CONCURRENT_ACCUMULATOR_HPP_
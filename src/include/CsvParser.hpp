@@ -0,0 +1,329 @@
+/**
+ * @file CsvParser.hpp
+ * @author Pedro Lucas (pedrolucas.jsrn@gmail.com)
+ * @brief Arquivo de cabeçalho para a classe CsvParser.
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef CSV_PARSER_HPP_
+#define CSV_PARSER_HPP_
+
+#include "Generator.hpp"
+#include "MappedColumn.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace stats {
+   /**
+    * @class CsvParser
+    * @brief Um leitor de números em CSV ou em texto com um valor por linha,
+    * que entrega cada coluna diretamente a um acumulador.
+    *
+    * O texto é dividido em pedaços de tamanho fixo, ajustados para terminar
+    * em uma quebra de linha, e os pedaços são lidos em paralelo com
+    * std::from_chars. Os valores de cada pedaço são entregues aos
+    * acumuladores em lotes e na ordem do texto, então o resultado é o mesmo
+    * de uma leitura sequencial, inclusive para Statistics.
+    *
+    * Campos vazios são ignorados; qualquer outro campo que não seja um número
+    * completo gera um erro com a posição no texto.
+    *
+    * @tparam TYPE Define o tipo de dados. Deve ser um tipo numérico.
+    */
+   template <typename TYPE>
+   class CsvParser {
+      static_assert(std::is_arithmetic_v<TYPE>, "TYPE must be a numeric type");
+
+  private:
+      /**
+       * @brief Os valores lidos de um pedaço, por coluna.
+       */
+      struct Chunk {
+         std::size_t begin = 0;
+         std::size_t end = 0;
+         std::size_t rows = 0;
+         std::vector<std::vector<TYPE>> columns;
+      };
+
+      char delimiter;
+      bool hasHeader;
+      std::size_t chunkBytes;
+      std::vector<std::size_t> selected;
+      std::shared_ptr<ThreadPool> pool;
+
+      /**
+       * @brief Lê um campo como número.
+       *
+       * @param field O campo, sem espaços nas pontas.
+       * @param offset A posição do campo no texto, para a mensagem de erro.
+       *
+       * @return O número.
+       *
+       * @throws std::runtime_error se o campo não for um número completo.
+       */
+      static TYPE parseField(std::string_view field, std::size_t offset) {
+         if (field.size() > 1 && field[0] == '+') {
+            field.remove_prefix(1);
+         }
+
+         TYPE value {};
+         auto [end, error]
+           = std::from_chars(field.data(), field.data() + field.size(), value);
+
+         if (error != std::errc() || end != field.data() + field.size()) {
+            throw std::runtime_error("Invalid number '" + std::string(field)
+              + "' at byte " + std::to_string(offset));
+         }
+
+         return value;
+      }
+
+      /**
+       * @brief Lê as linhas de um pedaço do texto.
+       *
+       * @param text O texto inteiro.
+       * @param chunk O pedaço, com o início e o fim preenchidos.
+       * @param targets O acumulador de cada coluna do texto, ou npos para as
+       * colunas ignoradas.
+       * @param columnCount O número de acumuladores.
+       * @param offset A posição do texto na entrada, para as mensagens de
+       * erro.
+       */
+      void parseChunk(std::string_view text,
+        Chunk& chunk,
+        std::span<std::size_t const> targets,
+        std::size_t columnCount,
+        std::size_t offset) const {
+         chunk.columns.resize(columnCount);
+         for (auto& column : chunk.columns) {
+            column.clear();
+         }
+         std::size_t position = chunk.begin;
+
+         while (position < chunk.end) {
+            std::size_t lineEnd = text.find('\n', position);
+            if (lineEnd == std::string_view::npos || lineEnd > chunk.end) {
+               lineEnd = chunk.end;
+            }
+
+            std::string_view line = text.substr(position, lineEnd - position);
+            std::size_t lineOffset = offset + position;
+            position = lineEnd + 1;
+
+            if (!line.empty() && line.back() == '\r') {
+               line.remove_suffix(1);
+            }
+            if (line.empty()) {
+               continue;
+            }
+
+            ++chunk.rows;
+            std::size_t fieldBegin = 0;
+
+            for (std::size_t column = 0; column < targets.size(); ++column) {
+               std::size_t fieldEnd = line.find(delimiter, fieldBegin);
+               if (fieldEnd == std::string_view::npos) {
+                  fieldEnd = line.size();
+               }
+
+               std::size_t target = targets[column];
+               std::string_view field
+                 = line.substr(fieldBegin, fieldEnd - fieldBegin);
+               std::size_t first = field.find_first_not_of(" \t");
+
+               if (target != npos && first != std::string_view::npos) {
+                  std::size_t last = field.find_last_not_of(" \t");
+                  chunk.columns[target].push_back(
+                    parseField(field.substr(first, last - first + 1),
+                      lineOffset + fieldBegin + first));
+               }
+
+               if (fieldEnd == line.size()) {
+                  break;
+               }
+               fieldBegin = fieldEnd + 1;
+            }
+         }
+      }
+
+  public:
+      static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+      /**
+       * @brief Construtor com o formato do texto.
+       *
+       * @param delimiter O separador de colunas. O padrão é ','.
+       * @param hasHeader Define se a primeira linha é um cabeçalho a ser
+       * ignorado. O padrão é False.
+       * @param chunkBytes O tamanho aproximado de cada pedaço. O padrão é 4
+       * MiB.
+       * @param pool O pool que lê os pedaços. Se for nulo, usa o pool padrão.
+       */
+      CsvParser(char delimiter = ',',
+        bool hasHeader = false,
+        std::size_t chunkBytes = std::size_t { 1 } << 22,
+        std::shared_ptr<ThreadPool> pool = nullptr)
+          : delimiter(delimiter),
+            hasHeader(hasHeader),
+            chunkBytes(std::max<std::size_t>(chunkBytes, 1)),
+            pool(pool ? std::move(pool) : ThreadPool::getDefault()) { }
+
+      /**
+       * @brief Seleciona as colunas do texto a serem lidas: a coluna
+       * columns[i] (contada a partir de 0) é entregue ao acumulador i. As
+       * demais colunas não são convertidas, então podem conter texto.
+       *
+       * @param columns As colunas, sem repetições. Se for vazio, a coluna i
+       * vai para o acumulador i.
+       *
+       * @return Uma referência para o próprio objeto.
+       *
+       * @throws std::runtime_error se alguma coluna se repetir.
+       */
+      CsvParser& setColumns(std::vector<std::size_t> columns) {
+         auto sorted = columns;
+         std::sort(sorted.begin(), sorted.end());
+         if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end()) {
+            throw std::runtime_error("Selected columns must be distinct");
+         }
+
+         selected = std::move(columns);
+         return *this;
+      }
+
+      /**
+       * @brief Retorna as colunas selecionadas.
+       *
+       * @return As colunas, ou vazio se todas forem lidas em ordem.
+       */
+      std::vector<std::size_t> const& getColumns() const { return selected; }
+
+      /**
+       * @brief Lê um texto, entregando a coluna i ao acumulador i.
+       *
+       * Colunas além do número de acumuladores são ignoradas. Com
+       * setColumns(), o acumulador i recebe a coluna selecionada i, e os
+       * acumuladores sem coluna selecionada não recebem valores.
+       *
+       * @tparam ACCUMULATOR Tipo dos acumuladores: qualquer um
+       * aceito por feedBatch().
+       *
+       * @param text O texto.
+       * @param columns Os acumuladores, um por coluna.
+       * @param offset A posição do texto na entrada, somada às posições das
+       * mensagens de erro quando o texto é um pedaço de um arquivo. O padrão
+       * é 0.
+       *
+       * @return O número de linhas não vazias lidas, sem o cabeçalho.
+       *
+       * @throws std::runtime_error se algum campo não for um número.
+       */
+      template <typename ACCUMULATOR>
+      std::size_t parse(std::string_view text,
+        std::span<ACCUMULATOR> columns,
+        std::size_t offset = 0) {
+         std::size_t position = 0;
+         if (hasHeader) {
+            std::size_t headerEnd = text.find('\n');
+            position = headerEnd == std::string_view::npos ? text.size()
+                                                           : headerEnd + 1;
+         }
+
+         std::vector<std::size_t> targets;
+         if (selected.empty()) {
+            targets.resize(columns.size());
+            for (std::size_t column = 0; column < targets.size(); ++column) {
+               targets[column] = column;
+            }
+         } else {
+            for (std::size_t i = 0; i < selected.size() && i < columns.size();
+                 ++i) {
+               if (selected[i] >= targets.size()) {
+                  targets.resize(selected[i] + 1, npos);
+               }
+               targets[selected[i]] = i;
+            }
+         }
+
+         std::vector<Chunk> wave(pool->concurrency() * 2);
+         std::size_t rows = 0;
+
+         while (position < text.size()) {
+            std::size_t chunkCount = 0;
+
+            for (; chunkCount < wave.size() && position < text.size();
+                 ++chunkCount) {
+               std::size_t end = std::min(text.size(), position + chunkBytes);
+               if (end < text.size()) {
+                  std::size_t newline = text.find('\n', end);
+                  end = newline == std::string_view::npos ? text.size()
+                                                          : newline + 1;
+               }
+
+               wave[chunkCount].begin = position;
+               wave[chunkCount].end = end;
+               wave[chunkCount].rows = 0;
+               position = end;
+            }
+
+            parallelFor(*pool,
+              0,
+              chunkCount,
+              1,
+              [&](std::size_t first, std::size_t last) {
+                 for (std::size_t chunk = first; chunk < last; ++chunk) {
+                    parseChunk(
+                      text, wave[chunk], targets, columns.size(), offset);
+                 }
+              });
+
+            for (std::size_t chunk = 0; chunk < chunkCount; ++chunk) {
+               rows += wave[chunk].rows;
+               for (std::size_t column = 0; column < columns.size(); ++column) {
+                  feedBatch(columns[column],
+                    std::span<TYPE const>(wave[chunk].columns[column]));
+               }
+            }
+         }
+
+         return rows;
+      }
+
+      /**
+       * @brief Lê um arquivo mapeado em memória, sem cópia para o heap.
+       *
+       * @tparam ACCUMULATOR Tipo dos acumuladores.
+       *
+       * @param path O caminho do arquivo.
+       * @param columns Os acumuladores, um por coluna.
+       *
+       * @return O número de linhas não vazias lidas, sem o cabeçalho.
+       *
+       * @throws std::runtime_error se o arquivo não puder ser lido ou se
+       * algum campo não for um número.
+       */
+      template <typename ACCUMULATOR>
+      std::size_t parseFile(
+        std::string const& path, std::span<ACCUMULATOR> columns) {
+         MappedColumn<char> file(path, false);
+         auto bytes = file.values();
+
+         return parse(std::string_view(bytes.data(), bytes.size()), columns);
+      }
+   };
+}
+
+#endif /// CSV_PARSER_HPP_
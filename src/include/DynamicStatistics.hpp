@@ -0,0 +1,697 @@
+/**
+ * @file DynamicStatistics.hpp
+ * @author Pedro Lucas (pedrolucas.jsrn@gmail.com)
+ * @brief Arquivo de cabeçalho para a classe DynamicStatistics.
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DYNAMIC_STATISTICS_HPP_
+#define DYNAMIC_STATISTICS_HPP_
+
+#include "Serialization.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace stats {
+   /**
+    * @class DynamicStatistics
+    * @brief Uma classe que mantém um conjunto de dados dinâmico, com inserções
+    * e remoções, respondendo mediana, k-ésimo elemento e posto de forma exata.
+    *
+    * Os valores são guardados em uma B-tree de estatística de ordem: cada
+    * chave distinta guarda sua multiplicidade e cada nó guarda o total de
+    * elementos da sua subárvore. Assim `insert`, `erase`, `kth`, `rank` e
+    * `median` custam O(log n). A média e a variância são mantidas de forma
+    * incremental (Welford) e custam O(1).
+    *
+    * Chaves cuja multiplicidade chega a zero permanecem na árvore como
+    * lápides e a árvore é reconstruída quando as lápides superam as chaves
+    * vivas, o que mantém o custo amortizado de `erase` em O(log n).
+    *
+    * @tparam TYPE Define o tipo de dados. Deve ser um tipo numérico.
+    */
+   template <typename TYPE>
+   class DynamicStatistics {
+      static_assert(std::is_arithmetic_v<TYPE>, "TYPE must be a numeric type");
+
+  private:
+      static constexpr int minimumDegree = 16;
+      static constexpr int maximumKeys = 2 * minimumDegree - 1;
+      static constexpr std::uint32_t tag = serializationTag("DYNS");
+      static constexpr std::uint16_t version = 1;
+
+      /**
+       * @brief Nó da B-tree.
+       */
+      struct Node {
+         int keyCount = 0;
+         bool leaf = true;
+         std::size_t total = 0;
+         std::array<TYPE, maximumKeys> keys;
+         std::array<std::size_t, maximumKeys> counts;
+         std::array<std::unique_ptr<Node>, maximumKeys + 1> children;
+
+         /**
+          * @brief Retorna o total de elementos da i-ésima subárvore.
+          *
+          * @param index Índice do filho.
+          *
+          * @return O total da subárvore ou 0 se o nó for uma folha.
+          */
+         std::size_t childTotal(int index) const {
+            return leaf ? 0 : children[index]->total;
+         }
+
+         /**
+          * @brief Retorna a posição da primeira chave maior ou igual ao valor.
+          *
+          * @param value O valor procurado.
+          *
+          * @return A posição encontrada.
+          */
+         int lowerBound(TYPE value) const {
+            return std::lower_bound(keys.begin(), keys.begin() + keyCount, value)
+              - keys.begin();
+         }
+      };
+
+      std::unique_ptr<Node> root;
+      std::size_t liveKeys = 0;
+      std::size_t tombstones = 0;
+      bool populationData;
+
+      std::size_t count = 0;
+      double runningMean = 0;
+      double runningM2 = 0;
+
+      /**
+       * @brief Checa se os valores estão vazios.
+       *
+       * @throws std::runtime_error se os valores estiverem vazios.
+       */
+      void ensureNotEmpty() const {
+         if (count == 0) {
+            throw std::runtime_error("Values are empty");
+         }
+      }
+
+      /**
+       * @brief Divide o i-ésimo filho (cheio) de um nó em dois, promovendo a
+       * chave central para o pai.
+       *
+       * @param parent O nó pai, que não pode estar cheio.
+       * @param index O índice do filho cheio.
+       */
+      static void splitChild(Node* parent, int index) {
+         Node* left = parent->children[index].get();
+         auto right = std::make_unique<Node>();
+         right->leaf = left->leaf;
+         right->keyCount = minimumDegree - 1;
+
+         for (int i = 0; i < minimumDegree - 1; ++i) {
+            right->keys[i] = left->keys[i + minimumDegree];
+            right->counts[i] = left->counts[i + minimumDegree];
+            right->total += right->counts[i];
+         }
+
+         if (!left->leaf) {
+            for (int i = 0; i < minimumDegree; ++i) {
+               right->children[i]
+                 = std::move(left->children[i + minimumDegree]);
+               right->total += right->children[i]->total;
+            }
+         }
+
+         TYPE middleKey = left->keys[minimumDegree - 1];
+         std::size_t middleCount = left->counts[minimumDegree - 1];
+         left->keyCount = minimumDegree - 1;
+         left->total -= right->total + middleCount;
+
+         for (int i = parent->keyCount; i > index; --i) {
+            parent->keys[i] = parent->keys[i - 1];
+            parent->counts[i] = parent->counts[i - 1];
+            parent->children[i + 1] = std::move(parent->children[i]);
+         }
+
+         parent->keys[index] = middleKey;
+         parent->counts[index] = middleCount;
+         parent->children[index + 1] = std::move(right);
+         ++parent->keyCount;
+      }
+
+      /**
+       * @brief Insere múltiplas cópias de um valor na árvore.
+       *
+       * @param value O valor a ser inserido.
+       * @param copies O número de cópias.
+       */
+      void insertIntoTree(TYPE value, std::size_t copies) {
+         if (!root) {
+            root = std::make_unique<Node>();
+         }
+
+         if (root->keyCount == maximumKeys) {
+            auto newRoot = std::make_unique<Node>();
+            newRoot->leaf = false;
+            newRoot->total = root->total;
+            newRoot->children[0] = std::move(root);
+            root = std::move(newRoot);
+            splitChild(root.get(), 0);
+         }
+
+         Node* node = root.get();
+
+         while (true) {
+            node->total += copies;
+
+            int index = node->lowerBound(value);
+            if (index < node->keyCount && node->keys[index] == value) {
+               reviveIfTombstone(node->counts[index]);
+               node->counts[index] += copies;
+               return;
+            }
+
+            if (node->leaf) {
+               for (int i = node->keyCount; i > index; --i) {
+                  node->keys[i] = node->keys[i - 1];
+                  node->counts[i] = node->counts[i - 1];
+               }
+
+               node->keys[index] = value;
+               node->counts[index] = copies;
+               ++node->keyCount;
+               ++liveKeys;
+               return;
+            }
+
+            if (node->children[index]->keyCount == maximumKeys) {
+               splitChild(node, index);
+
+               if (node->keys[index] == value) {
+                  reviveIfTombstone(node->counts[index]);
+                  node->counts[index] += copies;
+                  return;
+               }
+
+               if (node->keys[index] < value) {
+                  ++index;
+               }
+            }
+
+            node = node->children[index].get();
+         }
+      }
+
+      /**
+       * @brief Atualiza os contadores de chaves quando uma lápide volta a ter
+       * elementos.
+       *
+       * @param currentCount A multiplicidade atual da chave.
+       */
+      void reviveIfTombstone(std::size_t currentCount) {
+         if (currentCount == 0) {
+            --tombstones;
+            ++liveKeys;
+         }
+      }
+
+      /**
+       * @brief Percorre a árvore em ordem chamando uma função para cada chave
+       * viva.
+       *
+       * @param node O nó atual.
+       * @param function Função que recebe a chave e sua multiplicidade.
+       */
+      template <typename FUNCTION>
+      static void forEachKey(Node const* node, FUNCTION&& function) {
+         if (node == nullptr) {
+            return;
+         }
+
+         for (int i = 0; i < node->keyCount; ++i) {
+            if (!node->leaf) {
+               forEachKey(node->children[i].get(), function);
+            }
+
+            if (node->counts[i] > 0) {
+               function(node->keys[i], node->counts[i]);
+            }
+         }
+
+         if (!node->leaf) {
+            forEachKey(node->children[node->keyCount].get(), function);
+         }
+      }
+
+      /**
+       * @brief Reconstrói a árvore descartando as lápides.
+       */
+      void rebuild() {
+         std::vector<std::pair<TYPE, std::size_t>> entries;
+         entries.reserve(liveKeys);
+
+         forEachKey(root.get(), [&entries](TYPE key, std::size_t copies) {
+            entries.emplace_back(key, copies);
+         });
+
+         root.reset();
+         liveKeys = 0;
+         tombstones = 0;
+
+         for (auto const& [key, copies] : entries) {
+            insertIntoTree(key, copies);
+         }
+      }
+
+      /**
+       * @brief Atualiza a média e a variância incrementais com um novo valor.
+       *
+       * @param value O valor inserido.
+       */
+      void addMoment(TYPE value) {
+         ++count;
+         double delta = value - runningMean;
+         runningMean += delta / count;
+         runningM2 += delta * (value - runningMean);
+      }
+
+      /**
+       * @brief Atualiza a média e a variância incrementais removendo um valor.
+       *
+       * @param value O valor removido.
+       */
+      void removeMoment(TYPE value) {
+         if (--count == 0) {
+            runningMean = 0;
+            runningM2 = 0;
+            return;
+         }
+
+         double delta = value - runningMean;
+         runningMean -= delta / count;
+         runningM2 = std::max(0.0, runningM2 - delta * (value - runningMean));
+      }
+
+  public:
+      /**
+       * @brief Construtor padrão.
+       *
+       * @param populationData Define se os valores são de dados de população ou
+       * de uma amostra. O padrão é True.
+       */
+      DynamicStatistics(bool populationData = true)
+          : populationData(populationData) { }
+
+      /**
+       * @brief Construtor com um range de valores.
+       *
+       * @tparam ItInput Tipo do iterador de entrada.
+       *
+       * @param first Primeiro valor do range.
+       * @param last Ultimo valor do range.
+       * @param populationData Define se os valores são de dados de população ou
+       * de uma amostra. O padrão é True.
+       */
+      template <typename ItInput,
+        typename = typename std::iterator_traits<ItInput>::iterator_category>
+      DynamicStatistics(ItInput first, ItInput last, bool populationData = true)
+          : populationData(populationData) {
+         for (; first != last; ++first) {
+            insert(*first);
+         }
+      }
+
+      /**
+       * @brief Construtor com uma lista de valores.
+       *
+       * @param list Lista de valores.
+       * @param populationData Define se os valores são de dados de população ou
+       * de uma amostra. O padrão é True.
+       */
+      DynamicStatistics(
+        std::initializer_list<TYPE> list, bool populationData = true)
+          : DynamicStatistics(list.begin(), list.end(), populationData) { }
+
+      /**
+       * @brief Insere um valor no conjunto de dados.
+       *
+       * @param value O valor a ser inserido.
+       *
+       * @return A referência do objeto de DynamicStatistics atual.
+       */
+      DynamicStatistics& insert(TYPE value) {
+         insertIntoTree(value, 1);
+         addMoment(value);
+
+         return *this;
+      }
+
+      /**
+       * @brief Remove uma ocorrência de um valor do conjunto de dados.
+       *
+       * @param value O valor a ser removido.
+       *
+       * @return True se o valor existia e foi removido e False caso contrário.
+       */
+      bool erase(TYPE value) {
+         std::vector<Node*> path;
+         Node* node = root.get();
+
+         while (node != nullptr) {
+            path.push_back(node);
+
+            int index = node->lowerBound(value);
+            if (index < node->keyCount && node->keys[index] == value) {
+               if (node->counts[index] == 0) {
+                  return false;
+               }
+
+               for (Node* ancestor : path) {
+                  --ancestor->total;
+               }
+
+               if (--node->counts[index] == 0) {
+                  --liveKeys;
+                  ++tombstones;
+               }
+
+               removeMoment(value);
+
+               if (tombstones > liveKeys + minimumDegree) {
+                  rebuild();
+               }
+
+               return true;
+            }
+
+            node = node->leaf ? nullptr : node->children[index].get();
+         }
+
+         return false;
+      }
+
+      /**
+       * @brief Remove todos os valores.
+       *
+       * @return A referência do objeto de DynamicStatistics atual.
+       */
+      DynamicStatistics& clear() {
+         root.reset();
+         liveKeys = 0;
+         tombstones = 0;
+         count = 0;
+         runningMean = 0;
+         runningM2 = 0;
+
+         return *this;
+      }
+
+      /**
+       * @brief Obter os valores em ordem crescente.
+       *
+       * @return Os valores ordenados.
+       */
+      std::vector<TYPE> getValues() const {
+         std::vector<TYPE> values;
+         values.reserve(count);
+
+         forEachKey(root.get(), [&values](TYPE key, std::size_t copies) {
+            values.insert(values.end(), copies, key);
+         });
+
+         return values;
+      }
+
+      /**
+       * @brief Informa se os valores são de dados de população ou de amostra.
+       *
+       * @return True se os valores são de dados de população e False caso
+       * contrário.
+       */
+      bool isPopulationData() const { return populationData; }
+
+      /**
+       * @brief Define se os valores são de dados de população ou de amostra.
+       *
+       * @param populationData Define se os valores são de dados de população ou
+       * de uma amostra. O padrão é True.
+       *
+       * @return A referência do objeto de DynamicStatistics atual.
+       */
+      DynamicStatistics& setPopulationData(bool populationData = true) {
+         this->populationData = populationData;
+
+         return *this;
+      }
+
+      /**
+       * @brief Retorna o tamanho do conjunto de dados.
+       *
+       * @return O tamanho do conjunto de dados.
+       */
+      std::size_t size() const { return count; }
+
+      /**
+       * @brief Retorna quantas vezes um valor aparece no conjunto de dados.
+       *
+       * @param value O valor procurado.
+       *
+       * @return A multiplicidade do valor.
+       */
+      std::size_t frequency(TYPE value) const {
+         Node const* node = root.get();
+
+         while (node != nullptr) {
+            int index = node->lowerBound(value);
+            if (index < node->keyCount && node->keys[index] == value) {
+               return node->counts[index];
+            }
+
+            node = node->leaf ? nullptr : node->children[index].get();
+         }
+
+         return 0;
+      }
+
+      /**
+       * @brief Retorna o k-ésimo menor elemento do conjunto de dados.
+       *
+       * @param k A posição do elemento, começando em 0.
+       *
+       * @return O k-ésimo menor elemento.
+       *
+       * @throws std::out_of_range se k for maior ou igual ao tamanho.
+       */
+      TYPE kth(std::size_t k) const {
+         if (k >= count) {
+            throw std::out_of_range("Order statistic is out of range");
+         }
+
+         Node const* node = root.get();
+
+         while (true) {
+            int index = 0;
+
+            for (; index < node->keyCount; ++index) {
+               std::size_t childTotal = node->childTotal(index);
+               if (k < childTotal) {
+                  break;
+               }
+
+               k -= childTotal;
+               if (k < node->counts[index]) {
+                  return node->keys[index];
+               }
+
+               k -= node->counts[index];
+            }
+
+            node = node->children[index].get();
+         }
+      }
+
+      /**
+       * @brief Calcula o posto de um valor.
+       *
+       * @param value O valor consultado.
+       *
+       * @return O número de elementos estritamente menores que o valor.
+       */
+      std::size_t rank(TYPE value) const {
+         std::size_t smaller = 0;
+         Node const* node = root.get();
+
+         while (node != nullptr) {
+            int index = node->lowerBound(value);
+
+            for (int i = 0; i < index; ++i) {
+               smaller += node->childTotal(i) + node->counts[i];
+            }
+
+            if (index < node->keyCount && node->keys[index] == value) {
+               return smaller + node->childTotal(index);
+            }
+
+            node = node->leaf ? nullptr : node->children[index].get();
+         }
+
+         return smaller;
+      }
+
+      /**
+       * @brief Calcula a média dos elementos do conjunto de dados.
+       *
+       * @return A média dos elementos do conjunto de dados. Se o conjunto
+       * estiver vazio retorna 0.
+       */
+      double mean() const { return runningMean; }
+
+      /**
+       * @brief Calcula a mediana dos elementos do conjunto de dados.
+       *
+       * @return A mediana dos elementos do conjunto de dados.
+       *
+       * @throws std::runtime_error se o conjunto de dados estiver vazio.
+       */
+      double median() const {
+         ensureNotEmpty();
+
+         std::size_t mid = count / 2;
+         return count % 2 == 0
+           ? (static_cast<double>(kth(mid - 1)) + kth(mid)) / 2
+           : static_cast<double>(kth(mid));
+      }
+
+      /**
+       * @brief Calcula a amplitude dos elementos do conjunto de dados.
+       *
+       * @return A amplitude dos elementos do conjunto de dados.
+       *
+       * @throws std::runtime_error se o conjunto de dados estiver vazio.
+       */
+      TYPE amplitude() const {
+         ensureNotEmpty();
+
+         return kth(count - 1) - kth(0);
+      }
+
+      /**
+       * @brief Calcula a variância dos elementos do conjunto de dados.
+       *
+       * @return A variância dos elementos do conjunto de dados. Se o conjunto
+       * estiver vazio retorna 0.
+       */
+      double variance() const {
+         if (count == 0 || (!populationData && count == 1)) {
+            return 0;
+         }
+
+         return populationData ? runningM2 / count : runningM2 / (count - 1);
+      }
+
+      /**
+       * @brief Calcula o desvio padrão dos elementos do conjunto de dados.
+       *
+       * @return O desvio padrão dos elementos do conjunto de dados. Se o
+       * conjunto estiver vazio retorna 0.
+       */
+      double standardDeviation() const { return std::sqrt(variance()); }
+
+      /**
+       * @brief Serializa o conjunto de dados em um formato binário compacto.
+       *
+       * Cada chave distinta é gravada uma vez com a sua multiplicidade, e as
+       * lápides são descartadas. A média e o M2 incrementais são gravados
+       * como estão, então a restauração não os recalcula.
+       *
+       * @return Os bytes do conjunto de dados.
+       */
+      std::vector<std::uint8_t> serialize() const {
+         std::vector<TYPE> keys;
+         std::vector<std::uint64_t> counts;
+         keys.reserve(liveKeys);
+         counts.reserve(liveKeys);
+
+         forEachKey(root.get(), [&](TYPE key, std::size_t copies) {
+            keys.push_back(key);
+            counts.push_back(copies);
+         });
+
+         ByteWriter writer;
+         writer.writeHeader(tag, version);
+         writer.writeType<TYPE>();
+         writer.write(static_cast<std::uint8_t>(populationData));
+         writer.write(static_cast<std::uint64_t>(count));
+         writer.write(runningMean);
+         writer.write(runningM2);
+         writer.writeAlignedArray(std::span<TYPE const>(keys));
+         writer.writeAlignedArray(std::span<std::uint64_t const>(counts));
+
+         return writer.release();
+      }
+
+      /**
+       * @brief Reconstrói o conjunto de dados a partir dos bytes de
+       * serialize().
+       *
+       * @param bytes Os bytes do conjunto de dados.
+       *
+       * @return O conjunto de dados reconstruído.
+       *
+       * @throws std::runtime_error se os bytes forem inválidos.
+       */
+      static DynamicStatistics deserialize(
+        std::span<std::uint8_t const> bytes) {
+         ByteReader reader(bytes);
+         reader.readHeader(tag, version);
+         reader.readType<TYPE>();
+
+         DynamicStatistics result(reader.read<std::uint8_t>() != 0);
+         auto total = reader.read<std::uint64_t>();
+         double mean = reader.read<double>();
+         double m2 = reader.read<double>();
+         auto keys = reader.readAlignedArray<TYPE>();
+         auto counts = reader.readAlignedArray<std::uint64_t>();
+
+         if (keys.size() != counts.size()) {
+            throw std::runtime_error("Serialized columns have wrong size");
+         }
+
+         std::uint64_t sum = 0;
+         for (std::size_t i = 0; i < keys.size(); ++i) {
+            if (counts[i] == 0 || (i > 0 && !(keys[i - 1] < keys[i]))) {
+               throw std::runtime_error("Serialized keys are invalid");
+            }
+
+            result.insertIntoTree(keys[i], counts[i]);
+            sum += counts[i];
+         }
+
+         if (sum != total) {
+            throw std::runtime_error("Serialized counts do not match size");
+         }
+
+         result.count = total;
+         result.runningMean = mean;
+         result.runningM2 = m2;
+
+         return result;
+      }
+   };
+}
+
+#endif /// DYNAMIC_STATISTICS_HPP_
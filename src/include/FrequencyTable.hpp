@@ -0,0 +1,337 @@
+/**
+ * @file FrequencyTable.hpp
+ * @author Pedro Lucas (pedrolucas.jsrn@gmail.com)
+ * @brief Arquivo de cabeçalho para a classe FrequencyTable.
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef FREQUENCY_TABLE_HPP_
+#define FREQUENCY_TABLE_HPP_
+
+#include "Serialization.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace stats {
+   /**
+    * @class FrequencyTable
+    * @brief A tabela de frequências exata de um conjunto de valores, contada
+    * em paralelo.
+    *
+    * Na construção paralela os valores são primeiro espalhados em P
+    * partições pelo hash, com cada bloco de valores escrevendo em posições
+    * próprias calculadas por uma soma de prefixos das contagens. Depois cada
+    * partição é contada por uma única thread em uma tabela privada. Um valor
+    * só aparece em uma partição, então não há travas nem junção de tabelas.
+    *
+    * @tparam TYPE Define o tipo de dados. Deve ser um tipo numérico.
+    */
+   template <typename TYPE>
+   class FrequencyTable {
+      static_assert(std::is_arithmetic_v<TYPE>, "TYPE must be a numeric type");
+
+  private:
+      static constexpr std::size_t parallelThreshold = 1 << 16;
+      static constexpr std::uint32_t tag = serializationTag("FREQ");
+      static constexpr std::uint16_t version = 1;
+
+      std::vector<std::unordered_map<TYPE, std::size_t>> partitions;
+      int shift = 64;
+      std::size_t total = 0;
+
+      /**
+       * @brief Retorna a partição de um valor.
+       *
+       * @param value O valor.
+       *
+       * @return A posição da partição.
+       */
+      std::size_t partitionOf(TYPE value) const {
+         return shift >= 64
+           ? 0
+           : static_cast<std::size_t>(hashValue(value) >> shift);
+      }
+
+      /**
+       * @brief Conta os valores em uma única partição.
+       *
+       * @param values Os valores.
+       */
+      void countSerial(std::span<TYPE const> values) {
+         partitions.assign(1, {});
+         shift = 64;
+
+         for (auto const& value : values) {
+            ++partitions[0][value];
+         }
+      }
+
+  public:
+      /**
+       * @brief Construtor que conta os valores na thread atual.
+       *
+       * @param values Os valores.
+       */
+      FrequencyTable(std::span<TYPE const> values = {})
+          : total(values.size()) {
+         countSerial(values);
+      }
+
+      /**
+       * @brief Construtor que conta os valores em paralelo.
+       *
+       * @param values Os valores.
+       * @param pool O pool que executa as partes.
+       */
+      FrequencyTable(std::span<TYPE const> values, ThreadPool& pool)
+          : total(values.size()) {
+         if (values.size() < parallelThreshold || pool.size() == 0) {
+            countSerial(values);
+            return;
+         }
+
+         std::size_t partitionCount = std::bit_ceil(pool.concurrency() * 4);
+         shift = 64 - std::countr_zero(partitionCount);
+         partitions.resize(partitionCount);
+
+         std::size_t blocks = pool.concurrency() * 4;
+         auto blockBegin = [&](std::size_t block) {
+            return values.size() * block / blocks;
+         };
+
+         std::vector<std::size_t> offsets(blocks * partitionCount, 0);
+         parallelFor(pool, 0, blocks, 1, [&](std::size_t first, std::size_t last) {
+            for (std::size_t block = first; block < last; ++block) {
+               std::size_t* counts = &offsets[block * partitionCount];
+               for (std::size_t i = blockBegin(block);
+                    i < blockBegin(block + 1);
+                    ++i) {
+                  ++counts[partitionOf(values[i])];
+               }
+            }
+         });
+
+         std::vector<std::size_t> partitionBegin(partitionCount + 1, 0);
+         std::size_t position = 0;
+         for (std::size_t partition = 0; partition < partitionCount;
+              ++partition) {
+            partitionBegin[partition] = position;
+            for (std::size_t block = 0; block < blocks; ++block) {
+               std::size_t count = offsets[block * partitionCount + partition];
+               offsets[block * partitionCount + partition] = position;
+               position += count;
+            }
+         }
+         partitionBegin[partitionCount] = position;
+
+         std::vector<TYPE> buffer(values.size());
+         parallelFor(pool, 0, blocks, 1, [&](std::size_t first, std::size_t last) {
+            for (std::size_t block = first; block < last; ++block) {
+               std::size_t* next = &offsets[block * partitionCount];
+               for (std::size_t i = blockBegin(block);
+                    i < blockBegin(block + 1);
+                    ++i) {
+                  buffer[next[partitionOf(values[i])]++] = values[i];
+               }
+            }
+         });
+
+         parallelFor(pool,
+           0,
+           partitionCount,
+           1,
+           [&](std::size_t first, std::size_t last) {
+              for (std::size_t partition = first; partition < last;
+                   ++partition) {
+                 auto& table = partitions[partition];
+                 for (std::size_t i = partitionBegin[partition];
+                      i < partitionBegin[partition + 1];
+                      ++i) {
+                    ++table[buffer[i]];
+                 }
+              }
+           });
+      }
+
+      /**
+       * @brief Retorna o número de valores contados.
+       *
+       * @return O número de valores.
+       */
+      std::size_t size() const { return total; }
+
+      /**
+       * @brief Retorna o número de valores distintos.
+       *
+       * @return O número de valores distintos.
+       */
+      std::size_t distinctCount() const {
+         std::size_t count = 0;
+         for (auto const& table : partitions) {
+            count += table.size();
+         }
+
+         return count;
+      }
+
+      /**
+       * @brief Retorna a frequência de um valor.
+       *
+       * @param value O valor.
+       *
+       * @return Quantas vezes o valor aparece.
+       */
+      std::size_t frequency(TYPE value) const {
+         auto const& table = partitions[partitionOf(value)];
+         auto found = table.find(value);
+
+         return found == table.end() ? 0 : found->second;
+      }
+
+      /**
+       * @brief Retorna o valor mais frequente. Em caso de empate, retorna o
+       * menor dos valores empatados.
+       *
+       * @return A moda.
+       *
+       * @throws std::runtime_error se a tabela estiver vazia.
+       */
+      TYPE mode() const {
+         if (total == 0) {
+            throw std::runtime_error("Values are empty");
+         }
+
+         bool found = false;
+         std::pair<TYPE, std::size_t> best {};
+
+         for (auto const& table : partitions) {
+            for (auto const& [value, count] : table) {
+               if (!found || count > best.second
+                 || (count == best.second && value < best.first)) {
+                  best = { value, count };
+                  found = true;
+               }
+            }
+         }
+
+         return best.first;
+      }
+
+      /**
+       * @brief Executa uma função para cada valor distinto, em ordem
+       * arbitrária.
+       *
+       * @tparam FUNCTION Tipo da função, chamada como function(value, count).
+       *
+       * @param function A função.
+       */
+      template <typename FUNCTION>
+      void forEach(FUNCTION&& function) const {
+         for (auto const& table : partitions) {
+            for (auto const& [value, count] : table) {
+               function(value, count);
+            }
+         }
+      }
+
+      /**
+       * @brief Retorna todos os valores distintos com as suas frequências.
+       *
+       * @return Os pares (valor, frequência), em ordem crescente de valor.
+       */
+      std::vector<std::pair<TYPE, std::size_t>> entries() const {
+         std::vector<std::pair<TYPE, std::size_t>> result;
+         result.reserve(distinctCount());
+
+         forEach([&](TYPE value, std::size_t count) {
+            result.emplace_back(value, count);
+         });
+         std::sort(result.begin(), result.end());
+
+         return result;
+      }
+
+      /**
+       * @brief Serializa a tabela em um formato binário compacto, com os
+       * valores e as frequências em colunas.
+       *
+       * @return Os bytes da tabela.
+       */
+      std::vector<std::uint8_t> serialize() const {
+         std::vector<TYPE> values;
+         std::vector<std::uint64_t> counts;
+         values.reserve(distinctCount());
+         counts.reserve(distinctCount());
+
+         forEach([&](TYPE value, std::size_t count) {
+            values.push_back(value);
+            counts.push_back(count);
+         });
+
+         ByteWriter writer;
+         writer.writeHeader(tag, version);
+         writer.writeType<TYPE>();
+         writer.write(static_cast<std::uint64_t>(total));
+         writer.writeAlignedArray(std::span<TYPE const>(values));
+         writer.writeAlignedArray(std::span<std::uint64_t const>(counts));
+
+         return writer.release();
+      }
+
+      /**
+       * @brief Reconstrói uma tabela a partir dos bytes de serialize().
+       *
+       * @param bytes Os bytes da tabela.
+       *
+       * @return A tabela reconstruída, em uma única partição.
+       *
+       * @throws std::runtime_error se os bytes forem inválidos.
+       */
+      static FrequencyTable deserialize(std::span<std::uint8_t const> bytes) {
+         ByteReader reader(bytes);
+         reader.readHeader(tag, version);
+         reader.readType<TYPE>();
+
+         FrequencyTable table;
+         auto total = reader.read<std::uint64_t>();
+         auto values = reader.readAlignedArray<TYPE>();
+         auto counts = reader.readAlignedArray<std::uint64_t>();
+
+         if (values.size() != counts.size()) {
+            throw std::runtime_error("Serialized columns have wrong size");
+         }
+
+         std::uint64_t sum = 0;
+         auto& partition = table.partitions[0];
+         partition.reserve(values.size());
+         for (std::size_t i = 0; i < values.size(); ++i) {
+            if (!partition.emplace(values[i], counts[i]).second) {
+               throw std::runtime_error("Serialized values are not distinct");
+            }
+            sum += counts[i];
+         }
+
+         if (sum != total) {
+            throw std::runtime_error("Serialized counts do not match size");
+         }
+         table.total = total;
+
+         return table;
+      }
+   };
+}
+
+#endif /// FREQUENCY_TABLE_HPP_
@@ -0,0 +1,352 @@
+/**
+ * @file Generator.hpp
+ * @author Pedro Lucas (pedrolucas.jsrn@gmail.com)
+ * @brief Arquivo de cabeçalho para a classe Generator e as fontes de lotes
+ * baseadas em corrotinas.
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef GENERATOR_HPP_
+#define GENERATOR_HPP_
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace stats {
+   /**
+    * @class Generator
+    * @brief Uma sequência de valores produzida sob demanda por uma corrotina
+    * com co_yield.
+    *
+    * A corrotina só roda quando o próximo valor é pedido, então um produtor
+    * lento (leitura de arquivo, socket, descompressão) e a agregação se
+    * alternam na mesma thread, sem callbacks e sem buffers intermediários.
+    * O valor entregue é uma referência ao objeto do co_yield, válida até o
+    * próximo pedido.
+    *
+    * @tparam VALUE Tipo dos valores produzidos.
+    */
+   template <typename VALUE>
+   class Generator {
+  public:
+      /**
+       * @brief O estado da corrotina, exigido pelo compilador.
+       */
+      struct promise_type {
+         VALUE const* current = nullptr;
+         std::exception_ptr error;
+
+         Generator get_return_object() {
+            return Generator(
+              std::coroutine_handle<promise_type>::from_promise(*this));
+         }
+
+         std::suspend_always initial_suspend() noexcept { return {}; }
+
+         std::suspend_always final_suspend() noexcept { return {}; }
+
+         std::suspend_always yield_value(VALUE const& value) noexcept {
+            current = std::addressof(value);
+            return {};
+         }
+
+         void return_void() noexcept { }
+
+         void unhandled_exception() { error = std::current_exception(); }
+
+         /**
+          * @brief O gerador é síncrono: co_await não é permitido no corpo.
+          */
+         template <typename AWAITABLE>
+         std::suspend_never await_transform(AWAITABLE&&) = delete;
+      };
+
+      /**
+       * @class Iterator
+       * @brief Um iterador de entrada sobre os valores do gerador.
+       */
+      class Iterator {
+     private:
+         Generator* generator = nullptr;
+
+     public:
+         using iterator_category = std::input_iterator_tag;
+         using difference_type = std::ptrdiff_t;
+         using value_type = VALUE;
+         using reference = VALUE const&;
+         using pointer = VALUE const*;
+
+         Iterator() = default;
+
+         /**
+          * @brief Construtor com o gerador percorrido.
+          *
+          * @param generator O gerador.
+          */
+         explicit Iterator(Generator& generator) : generator(&generator) { }
+
+         reference operator*() const { return generator->value(); }
+
+         pointer operator->() const {
+            return std::addressof(generator->value());
+         }
+
+         Iterator& operator++() {
+            generator->next();
+            return *this;
+         }
+
+         void operator++(int) { ++*this; }
+
+         bool operator==(std::default_sentinel_t) const {
+            return generator == nullptr || generator->done();
+         }
+      };
+
+  private:
+      std::coroutine_handle<promise_type> handle;
+      bool started = false;
+
+      /**
+       * @brief Construtor usado pela corrotina.
+       *
+       * @param handle O identificador da corrotina.
+       */
+      explicit Generator(std::coroutine_handle<promise_type> handle)
+          : handle(handle) { }
+
+  public:
+      Generator(Generator const&) = delete;
+      Generator& operator=(Generator const&) = delete;
+
+      /**
+       * @brief Construtor de movimento.
+       *
+       * @param other O gerador movido.
+       */
+      Generator(Generator&& other) noexcept
+          : handle(std::exchange(other.handle, nullptr)),
+            started(other.started) { }
+
+      /**
+       * @brief Atribuição por movimento.
+       *
+       * @param other O gerador movido.
+       *
+       * @return A referência do objeto de Generator atual.
+       */
+      Generator& operator=(Generator&& other) noexcept {
+         if (this != &other) {
+            if (handle) {
+               handle.destroy();
+            }
+
+            handle = std::exchange(other.handle, nullptr);
+            started = other.started;
+         }
+
+         return *this;
+      }
+
+      /**
+       * @brief Destrutor que destrói a corrotina, mesmo se ela não terminou.
+       */
+      ~Generator() {
+         if (handle) {
+            handle.destroy();
+         }
+      }
+
+      /**
+       * @brief Avança a corrotina até o próximo co_yield.
+       *
+       * @return True se há um novo valor e False se a corrotina terminou.
+       *
+       * @throws A exceção lançada pela corrotina, se houver.
+       */
+      bool next() {
+         if (!handle || handle.done()) {
+            return false;
+         }
+
+         started = true;
+         handle.resume();
+
+         if (auto error = std::exchange(handle.promise().error, nullptr)) {
+            std::rethrow_exception(error);
+         }
+
+         return !handle.done();
+      }
+
+      /**
+       * @brief Retorna o valor atual, produzido pelo último next().
+       *
+       * @return O valor atual.
+       */
+      VALUE const& value() const { return *handle.promise().current; }
+
+      /**
+       * @brief Informa se a corrotina terminou.
+       *
+       * @return True se não há mais valores e False caso contrário.
+       */
+      bool done() const { return !handle || handle.done(); }
+
+      /**
+       * @brief Inicia a iteração, produzindo o primeiro valor.
+       *
+       * @return O iterador no primeiro valor.
+       *
+       * @throws std::runtime_error se a iteração já tiver começado.
+       */
+      Iterator begin() {
+         if (started) {
+            throw std::runtime_error("Generator has already started");
+         }
+
+         next();
+         return Iterator(*this);
+      }
+
+      /**
+       * @brief Retorna o fim da iteração.
+       *
+       * @return A sentinela de fim.
+       */
+      std::default_sentinel_t end() const { return std::default_sentinel; }
+   };
+
+   /**
+    * @brief Um gerador de lotes de valores.
+    *
+    * @tparam TYPE Tipo dos valores.
+    */
+   template <typename TYPE>
+   using BatchGenerator = Generator<std::span<TYPE const>>;
+
+   /**
+    * @brief Agrupa os valores de um gerador em lotes de tamanho fixo.
+    *
+    * O buffer do lote é reutilizado, então cada lote só é válido até o
+    * próximo ser pedido.
+    *
+    * @tparam TYPE Tipo dos valores.
+    *
+    * @param values O gerador de valores.
+    * @param batchSize O tamanho de cada lote, exceto talvez o último. O
+    * padrão é 4096.
+    *
+    * @return O gerador de lotes.
+    *
+    * @throws std::runtime_error se batchSize for 0.
+    */
+   template <typename TYPE>
+   BatchGenerator<TYPE> batched(
+     Generator<TYPE> values, std::size_t batchSize = 4096) {
+      if (batchSize == 0) {
+         throw std::runtime_error("Batch size must be positive");
+      }
+
+      std::vector<TYPE> buffer;
+      buffer.reserve(batchSize);
+
+      for (auto const& value : values) {
+         buffer.push_back(value);
+
+         if (buffer.size() == batchSize) {
+            co_yield std::span<TYPE const>(buffer);
+            buffer.clear();
+         }
+      }
+
+      if (!buffer.empty()) {
+         co_yield std::span<TYPE const>(buffer);
+      }
+   }
+
+   /**
+    * @brief Entrega um lote de valores a um acumulador.
+    *
+    * Usa pushBatch(span) quando o acumulador o tem (StreamingStatistics,
+    * QuantileSketch, HyperLogLog e outros), de modo que o laço interno
+    * continua vetorizado, addValues(first, last) caso contrário
+    * (Statistics) e, na falta dos dois, push(value) para cada valor.
+    *
+    * @tparam TYPE Tipo dos valores.
+    * @tparam ACCUMULATOR Tipo do acumulador.
+    *
+    * @param accumulator O acumulador.
+    * @param values Os valores.
+    */
+   template <typename TYPE, typename ACCUMULATOR>
+   void feedBatch(ACCUMULATOR& accumulator, std::span<TYPE const> values) {
+      if constexpr (requires { accumulator.pushBatch(values); }) {
+         accumulator.pushBatch(values);
+      } else if constexpr (requires {
+                              accumulator.addValues(
+                                values.begin(), values.end());
+                           }) {
+         accumulator.addValues(values.begin(), values.end());
+      } else {
+         for (auto value : values) {
+            accumulator.push(value);
+         }
+      }
+   }
+
+   /**
+    * @brief Consome um gerador de lotes, entregando cada lote inteiro ao
+    * acumulador com feedBatch().
+    *
+    * @tparam TYPE Tipo dos valores.
+    * @tparam ACCUMULATOR Tipo do acumulador.
+    *
+    * @param source O gerador de lotes.
+    * @param accumulator O acumulador.
+    *
+    * @return A referência do acumulador.
+    */
+   template <typename TYPE, typename ACCUMULATOR>
+   ACCUMULATOR& accumulate(
+     BatchGenerator<TYPE>& source, ACCUMULATOR& accumulator) {
+      while (source.next()) {
+         feedBatch(accumulator, source.value());
+      }
+
+      return accumulator;
+   }
+
+   /**
+    * @brief Consome um gerador de valores em lotes de tamanho fixo.
+    *
+    * @tparam TYPE Tipo dos valores.
+    * @tparam ACCUMULATOR Tipo do acumulador.
+    *
+    * @param source O gerador de valores.
+    * @param accumulator O acumulador.
+    * @param batchSize O tamanho de cada lote. O padrão é 4096.
+    *
+    * @return A referência do acumulador.
+    */
+   template <typename TYPE, typename ACCUMULATOR>
+   ACCUMULATOR& accumulate(Generator<TYPE> source,
+     ACCUMULATOR& accumulator,
+     std::size_t batchSize = 4096) {
+      auto batches = batched(std::move(source), batchSize);
+      return accumulate(batches, accumulator);
+   }
+}
+
+#endif /// GENERATOR_HPP_
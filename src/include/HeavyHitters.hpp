@@ -0,0 +1,519 @@
+/**
+ * @file HeavyHitters.hpp
+ * @author Pedro Lucas (pedrolucas.jsrn@gmail.com)
+ * @brief Arquivo de cabeçalho para a classe HeavyHitters.
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef HEAVY_HITTERS_HPP_
+#define HEAVY_HITTERS_HPP_
+
+#include "Serialization.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace stats {
+   /**
+    * @class HeavyHitters
+    * @brief Um esboço Space-Saving com memória fixa que estima a moda e os
+    * valores mais frequentes de um fluxo.
+    *
+    * O esboço guarda no máximo `capacity` contadores. Um valor novo, com o
+    * esboço cheio, substitui o contador de menor contagem e herda essa
+    * contagem como erro. Para todo valor monitorado, a frequência real fica
+    * entre `count - error` e `count`, e o erro nunca passa de n / capacity.
+    * Logo, todo valor com frequência maior que n / capacity é monitorado.
+    *
+    * @see https://doi.org/10.1007/978-3-540-30570-5_27
+    *
+    * @tparam TYPE Define o tipo de dados. Deve ser um tipo numérico.
+    */
+   template <typename TYPE>
+   class HeavyHitters {
+      static_assert(std::is_arithmetic_v<TYPE>, "TYPE must be a numeric type");
+
+  public:
+      /**
+       * @brief Um valor monitorado com a sua contagem estimada.
+       */
+      struct Counter {
+         TYPE value;
+         std::uint64_t count;
+         std::uint64_t error;
+      };
+
+  private:
+      static constexpr std::uint32_t tag = serializationTag("HVYH");
+      static constexpr std::uint16_t version = 1;
+
+      std::size_t capacity;
+      std::uint64_t total = 0;
+      std::vector<Counter> counters;
+      std::vector<std::size_t> heap;
+      std::vector<std::size_t> position;
+      std::unordered_map<TYPE, std::size_t> index;
+      std::vector<std::pair<TYPE, std::uint64_t>> batchBuffer;
+
+      /**
+       * @brief Checa se a capacidade é válida.
+       *
+       * @throws std::runtime_error se a capacidade for zero.
+       */
+      void checkCapacity() const {
+         if (capacity == 0) {
+            throw std::runtime_error("Heavy hitters capacity is zero");
+         }
+      }
+
+      /**
+       * @brief Checa se o esboço não está vazio.
+       *
+       * @throws std::runtime_error se o esboço estiver vazio.
+       */
+      void ensureNotEmpty() const {
+         if (counters.empty()) {
+            throw std::runtime_error("Values are empty");
+         }
+      }
+
+      /**
+       * @brief Troca dois elementos do heap mantendo as posições.
+       */
+      void swapHeap(std::size_t a, std::size_t b) {
+         std::swap(heap[a], heap[b]);
+         position[heap[a]] = a;
+         position[heap[b]] = b;
+      }
+
+      /**
+       * @brief Desce um elemento do heap de mínimo até a sua posição.
+       *
+       * @param node A posição do elemento no heap.
+       */
+      void siftDown(std::size_t node) {
+         while (true) {
+            std::size_t smallest = node;
+            std::size_t left = 2 * node + 1;
+            std::size_t right = left + 1;
+
+            if (left < heap.size()
+              && counters[heap[left]].count < counters[heap[smallest]].count) {
+               smallest = left;
+            }
+
+            if (right < heap.size()
+              && counters[heap[right]].count < counters[heap[smallest]].count) {
+               smallest = right;
+            }
+
+            if (smallest == node) {
+               return;
+            }
+
+            swapHeap(node, smallest);
+            node = smallest;
+         }
+      }
+
+      /**
+       * @brief Sobe um elemento do heap de mínimo até a sua posição.
+       *
+       * @param node A posição do elemento no heap.
+       */
+      void siftUp(std::size_t node) {
+         while (node > 0) {
+            std::size_t parent = (node - 1) / 2;
+            if (counters[heap[parent]].count <= counters[heap[node]].count) {
+               return;
+            }
+
+            swapHeap(node, parent);
+            node = parent;
+         }
+      }
+
+      /**
+       * @brief Insere um contador novo, com o esboço ainda não cheio.
+       *
+       * @param counter O contador.
+       */
+      void addCounter(Counter const& counter) {
+         std::size_t slot = counters.size();
+         counters.push_back(counter);
+         heap.push_back(slot);
+         position.push_back(heap.size() - 1);
+         index.emplace(counter.value, slot);
+         siftUp(heap.size() - 1);
+      }
+
+      /**
+       * @brief Reconstrói o esboço a partir de uma lista de contadores,
+       * mantendo apenas os de maior contagem.
+       *
+       * @param candidates Os contadores candidatos.
+       */
+      void rebuild(std::vector<Counter>& candidates) {
+         if (candidates.size() > capacity) {
+            std::nth_element(candidates.begin(),
+              candidates.begin() + capacity,
+              candidates.end(),
+              [](Counter const& a, Counter const& b) {
+                 return a.count > b.count;
+              });
+            candidates.resize(capacity);
+         }
+
+         counters.clear();
+         heap.clear();
+         position.clear();
+         index.clear();
+
+         for (auto const& counter : candidates) {
+            addCounter(counter);
+         }
+      }
+
+  public:
+      /**
+       * @brief Construtor com a capacidade do esboço.
+       *
+       * @param capacity O número máximo de valores monitorados. O padrão é
+       * 1024.
+       *
+       * @throws std::runtime_error se a capacidade for zero.
+       */
+      HeavyHitters(std::size_t capacity = 1024) : capacity(capacity) {
+         checkCapacity();
+         counters.reserve(capacity);
+         heap.reserve(capacity);
+         position.reserve(capacity);
+         index.reserve(capacity);
+      }
+
+      /**
+       * @brief Adiciona um valor ao esboço.
+       *
+       * @param value O valor a ser adicionado.
+       * @param weight Quantas ocorrências do valor adicionar. O padrão é 1.
+       *
+       * @return A referência do objeto de HeavyHitters atual.
+       */
+      HeavyHitters& push(TYPE value, std::uint64_t weight = 1) {
+         total += weight;
+
+         auto found = index.find(value);
+         if (found != index.end()) {
+            counters[found->second].count += weight;
+            siftDown(position[found->second]);
+            return *this;
+         }
+
+         if (counters.size() < capacity) {
+            addCounter({ value, weight, 0 });
+            return *this;
+         }
+
+         std::size_t slot = heap[0];
+         Counter& smallest = counters[slot];
+         index.erase(smallest.value);
+         smallest = { value, smallest.count + weight, smallest.count };
+         index.emplace(value, slot);
+         siftDown(0);
+
+         return *this;
+      }
+
+      /**
+       * @brief Adiciona um lote de valores ao esboço.
+       *
+       * O lote é ordenado e os valores iguais são agrupados antes da
+       * atualização, de modo que cada valor distinto do lote custa uma única
+       * atualização do esboço.
+       *
+       * @param values Os valores a serem adicionados.
+       *
+       * @return A referência do objeto de HeavyHitters atual.
+       */
+      HeavyHitters& pushBatch(std::span<TYPE const> values) {
+         std::vector<TYPE> sorted(values.begin(), values.end());
+         std::sort(sorted.begin(), sorted.end());
+
+         batchBuffer.clear();
+         for (auto const& value : sorted) {
+            if (!batchBuffer.empty() && batchBuffer.back().first == value) {
+               ++batchBuffer.back().second;
+            } else {
+               batchBuffer.emplace_back(value, 1);
+            }
+         }
+
+         // Os valores mais frequentes do lote entram por último para não
+         // serem substituídos pelos raros do mesmo lote.
+         std::stable_sort(batchBuffer.begin(), batchBuffer.end(),
+           [](auto const& a, auto const& b) { return a.second < b.second; });
+
+         for (auto const& [value, weight] : batchBuffer) {
+            push(value, weight);
+         }
+
+         return *this;
+      }
+
+      /**
+       * @brief Adiciona um range de valores ao esboço.
+       *
+       * @tparam ItInput Tipo do iterador de entrada.
+       *
+       * @param first Primeiro valor do range.
+       * @param last Ultimo valor do range.
+       *
+       * @return A referência do objeto de HeavyHitters atual.
+       */
+      template <typename ItInput,
+        typename = typename std::iterator_traits<ItInput>::iterator_category>
+      HeavyHitters& pushBatch(ItInput first, ItInput last) {
+         std::vector<TYPE> values(first, last);
+         return pushBatch(std::span<TYPE const>(values));
+      }
+
+      /**
+       * @brief Junta outro esboço a este.
+       *
+       * Um valor ausente de um dos esboços recebe, naquele esboço, a menor
+       * contagem monitorada (um limite superior da sua frequência), que
+       * também é somada ao erro. O resultado mantém as garantias do
+       * Space-Saving sobre a união dos fluxos.
+       *
+       * @param other O esboço a ser juntado.
+       *
+       * @return A referência do objeto de HeavyHitters atual.
+       */
+      HeavyHitters& merge(HeavyHitters const& other) {
+         std::uint64_t ownFloor = minimumCount();
+         std::uint64_t otherFloor = other.minimumCount();
+
+         std::vector<Counter> candidates;
+         candidates.reserve(counters.size() + other.counters.size());
+
+         for (auto counter : counters) {
+            auto found = other.index.find(counter.value);
+            if (found != other.index.end()) {
+               counter.count += other.counters[found->second].count;
+               counter.error += other.counters[found->second].error;
+            } else {
+               counter.count += otherFloor;
+               counter.error += otherFloor;
+            }
+
+            candidates.push_back(counter);
+         }
+
+         for (auto counter : other.counters) {
+            if (index.find(counter.value) == index.end()) {
+               counter.count += ownFloor;
+               counter.error += ownFloor;
+               candidates.push_back(counter);
+            }
+         }
+
+         total += other.total;
+         rebuild(candidates);
+
+         return *this;
+      }
+
+      /**
+       * @brief Retorna o número de valores vistos.
+       *
+       * @return O total de ocorrências adicionadas.
+       */
+      std::uint64_t size() const { return total; }
+
+      /**
+       * @brief Retorna a capacidade do esboço.
+       *
+       * @return O número máximo de valores monitorados.
+       */
+      std::size_t getCapacity() const { return capacity; }
+
+      /**
+       * @brief Retorna o limite do erro de qualquer contagem.
+       *
+       * @return O erro máximo, n / capacity.
+       */
+      std::uint64_t errorBound() const { return total / capacity; }
+
+      /**
+       * @brief Retorna a menor contagem monitorada.
+       *
+       * @return A menor contagem, ou 0 se o esboço ainda não estiver cheio.
+       */
+      std::uint64_t minimumCount() const {
+         return counters.size() < capacity ? 0 : counters[heap[0]].count;
+      }
+
+      /**
+       * @brief Estima a frequência de um valor.
+       *
+       * @param value O valor consultado.
+       *
+       * @return Um limite superior da frequência do valor.
+       */
+      std::uint64_t frequency(TYPE value) const {
+         auto found = index.find(value);
+         return found == index.end() ? minimumCount()
+                                     : counters[found->second].count;
+      }
+
+      /**
+       * @brief Estima a moda do fluxo.
+       *
+       * @return O valor de maior contagem estimada.
+       *
+       * @throws std::runtime_error se o esboço estiver vazio.
+       */
+      TYPE mode() const {
+         ensureNotEmpty();
+
+         return std::max_element(counters.begin(),
+           counters.end(),
+           [](Counter const& a, Counter const& b) { return a.count < b.count; })
+           ->value;
+      }
+
+      /**
+       * @brief Retorna os valores mais frequentes.
+       *
+       * @param k O número de valores desejados.
+       *
+       * @return Até k contadores em ordem decrescente de contagem.
+       */
+      std::vector<Counter> topK(std::size_t k) const {
+         std::vector<Counter> result(counters);
+         k = std::min(k, result.size());
+
+         std::partial_sort(result.begin(),
+           result.begin() + k,
+           result.end(),
+           [](Counter const& a, Counter const& b) { return a.count > b.count; });
+         result.resize(k);
+
+         return result;
+      }
+
+      /**
+       * @brief Retorna os valores cuja frequência garantidamente passa de uma
+       * fração do fluxo.
+       *
+       * @param fraction A fração mínima, entre 0 e 1.
+       *
+       * @return Os contadores com `count - error` acima de fraction * n, em
+       * ordem decrescente de contagem.
+       */
+      std::vector<Counter> guaranteedAbove(double fraction) const {
+         std::vector<Counter> result;
+         double threshold = fraction * total;
+
+         for (auto const& counter : counters) {
+            if (counter.count - counter.error > threshold) {
+               result.push_back(counter);
+            }
+         }
+
+         std::sort(result.begin(), result.end(),
+           [](Counter const& a, Counter const& b) { return a.count > b.count; });
+
+         return result;
+      }
+
+      /**
+       * @brief Serializa o esboço em um formato binário compacto.
+       *
+       * Os contadores são gravados em colunas (valores, contagens e erros),
+       * sem os bytes de preenchimento de Counter.
+       *
+       * @return Os bytes do esboço.
+       */
+      std::vector<std::uint8_t> serialize() const {
+         std::vector<TYPE> values;
+         std::vector<std::uint64_t> counts;
+         std::vector<std::uint64_t> errors;
+
+         for (auto const& counter : counters) {
+            values.push_back(counter.value);
+            counts.push_back(counter.count);
+            errors.push_back(counter.error);
+         }
+
+         ByteWriter writer;
+         writer.writeHeader(tag, version);
+         writer.writeType<TYPE>();
+         writer.write(static_cast<std::uint64_t>(capacity));
+         writer.write(total);
+         writer.writeAlignedArray(std::span<TYPE const>(values));
+         writer.writeAlignedArray(std::span<std::uint64_t const>(counts));
+         writer.writeAlignedArray(std::span<std::uint64_t const>(errors));
+
+         return writer.release();
+      }
+
+      /**
+       * @brief Reconstrói um esboço a partir dos bytes de serialize().
+       *
+       * @param bytes Os bytes do esboço.
+       *
+       * @return O esboço reconstruído.
+       *
+       * @throws std::runtime_error se os bytes forem inválidos.
+       */
+      static HeavyHitters deserialize(std::span<std::uint8_t const> bytes) {
+         ByteReader reader(bytes);
+         reader.readHeader(tag, version);
+         reader.readType<TYPE>();
+
+         auto capacity = reader.read<std::uint64_t>();
+         auto total = reader.read<std::uint64_t>();
+         auto values = reader.readAlignedArray<TYPE>();
+         auto counts = reader.readAlignedArray<std::uint64_t>();
+         auto errors = reader.readAlignedArray<std::uint64_t>();
+
+         if (values.size() != counts.size() || values.size() != errors.size()
+           || values.size() > capacity) {
+            throw std::runtime_error("Serialized columns have wrong size");
+         }
+
+         // Reserva só os contadores gravados: a capacidade lida não passou
+         // por nenhuma checagem e não deve decidir quanta memória alocar.
+         HeavyHitters sketch(std::max<std::size_t>(values.size(), 1));
+         sketch.capacity = capacity;
+         sketch.checkCapacity();
+         sketch.total = total;
+
+         std::vector<Counter> candidates;
+         candidates.reserve(values.size());
+         for (std::size_t i = 0; i < values.size(); ++i) {
+            candidates.push_back({ values[i], counts[i], errors[i] });
+         }
+         sketch.rebuild(candidates);
+
+         if (sketch.index.size() != sketch.counters.size()) {
+            throw std::runtime_error("Serialized values are not distinct");
+         }
+
+         return sketch;
+      }
+   };
+}
+
+#endif /// HEAVY_HITTERS_HPP_
@@ -0,0 +1,551 @@
+/**
+ * @file HyperLogLog.hpp
+ * @author Pedro Lucas (pedrolucas.jsrn@gmail.com)
+ * @brief Arquivo de cabeçalho para a classe HyperLogLog.
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef HYPER_LOG_LOG_HPP_
+#define HYPER_LOG_LOG_HPP_
+
+#include "Serialization.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace stats {
+   /**
+    * @class HyperLogLog
+    * @brief Um estimador HyperLogLog++ do número de valores distintos de um
+    * fluxo.
+    *
+    * Enquanto poucos valores foram vistos, o estimador usa a representação
+    * esparsa do HyperLogLog++: uma lista ordenada de índices com precisão 25,
+    * estimada por contagem linear, que é quase exata e ocupa menos memória que
+    * os registradores. Quando a lista passaria a ocupar mais que os 2^p
+    * registradores densos, ela é convertida.
+    *
+    * Na representação densa a estimativa usa o estimador melhorado de Ertl,
+    * que dispensa as tabelas empíricas de correção de viés do HyperLogLog++ e
+    * tem erro relativo padrão de aproximadamente 1,04 / sqrt(2^p).
+    *
+    * @see https://research.google/pubs/pub40671/
+    * @see https://arxiv.org/abs/1702.01284
+    *
+    * @tparam TYPE Define o tipo de dados. Deve ser um tipo numérico.
+    */
+   template <typename TYPE>
+   class HyperLogLog {
+      static_assert(std::is_arithmetic_v<TYPE>, "TYPE must be a numeric type");
+
+  private:
+      static constexpr std::uint32_t tag = serializationTag("HLLP");
+      static constexpr std::uint16_t version = 2;
+      static constexpr int sparsePrecision = 25;
+      static constexpr int minimumPrecision = 4;
+      static constexpr int maximumPrecision = 18;
+
+      int precision;
+      bool sparse = true;
+      std::vector<std::uint8_t> registers;
+      std::vector<std::uint32_t> sparseList;
+      std::vector<std::uint32_t> sparseBuffer;
+
+      /**
+       * @brief Checa se a precisão é válida.
+       *
+       * @throws std::runtime_error se a precisão estiver fora de [4, 18].
+       */
+      void checkPrecision() const {
+         if (precision < minimumPrecision || precision > maximumPrecision) {
+            throw std::runtime_error("Precision is not between 4 and 18");
+         }
+      }
+
+      /**
+       * @brief Retorna o número de registradores densos.
+       *
+       * @return 2^p.
+       */
+      std::size_t registerCount() const { return std::size_t { 1 } << precision; }
+
+      /**
+       * @brief Codifica um hash para a lista esparsa: o índice com precisão 25
+       * nos bits altos e o número de zeros à esquerda do restante nos 6 bits
+       * baixos.
+       *
+       * @param hashed O hash.
+       *
+       * @return O hash codificado.
+       */
+      static std::uint32_t encodeSparse(std::uint64_t hashed) {
+         auto index = static_cast<std::uint32_t>(hashed >> (64 - sparsePrecision));
+         std::uint64_t rest = hashed << sparsePrecision;
+         auto rho = static_cast<std::uint32_t>(
+           std::min(std::countl_zero(rest), 64 - sparsePrecision) + 1);
+
+         return index << 6 | rho;
+      }
+
+      /**
+       * @brief Valida uma lista esparsa lida de bytes serializados.
+       *
+       * @param list A lista de codificações.
+       *
+       * @throws std::runtime_error se um índice ou número de zeros estiver
+       * fora do intervalo ou se a lista não for estritamente crescente.
+       */
+      static void checkSparseList(std::vector<std::uint32_t> const& list) {
+         for (std::size_t i = 0; i < list.size(); ++i) {
+            std::uint32_t rho = list[i] & 0x3F;
+            if (list[i] >> 6 >= std::uint32_t { 1 } << sparsePrecision) {
+               throw std::runtime_error("Serialized sparse index is invalid");
+            }
+
+            if (rho == 0 || rho > 64 - sparsePrecision + 1) {
+               throw std::runtime_error("Serialized sparse value is invalid");
+            }
+
+            if (i > 0 && list[i - 1] >> 6 >= list[i] >> 6) {
+               throw std::runtime_error("Serialized sparse list is not sorted");
+            }
+         }
+      }
+
+      /**
+       * @brief Atualiza um registrador denso com um hash.
+       *
+       * @param hashed O hash.
+       */
+      void insertDense(std::uint64_t hashed) {
+         std::size_t index = hashed >> (64 - precision);
+         std::uint64_t rest = hashed << precision;
+         auto rho = static_cast<std::uint8_t>(
+           std::min(std::countl_zero(rest), 64 - precision) + 1);
+
+         registers[index] = std::max(registers[index], rho);
+      }
+
+      /**
+       * @brief Ordena o buffer esparso, junta-o à lista e remove índices
+       * repetidos, mantendo o maior número de zeros de cada índice.
+       */
+      void flushSparseBuffer() {
+         if (sparseBuffer.empty()) {
+            return;
+         }
+
+         std::sort(sparseBuffer.begin(), sparseBuffer.end());
+         std::vector<std::uint32_t> merged;
+         merged.reserve(sparseList.size() + sparseBuffer.size());
+         std::merge(sparseList.begin(),
+           sparseList.end(),
+           sparseBuffer.begin(),
+           sparseBuffer.end(),
+           std::back_inserter(merged));
+         sparseBuffer.clear();
+
+         // Codificações com o mesmo índice são adjacentes e a última tem o
+         // maior número de zeros.
+         std::size_t kept = 0;
+         for (std::size_t i = 0; i < merged.size(); ++i) {
+            if (i + 1 < merged.size() && merged[i] >> 6 == merged[i + 1] >> 6) {
+               continue;
+            }
+
+            merged[kept++] = merged[i];
+         }
+
+         merged.resize(kept);
+         sparseList = std::move(merged);
+
+         if (sparseList.size() * sizeof(std::uint32_t) >= registerCount()) {
+            toDense();
+         }
+      }
+
+      /**
+       * @brief Converte a representação esparsa para a densa.
+       */
+      void toDense() {
+         registers.assign(registerCount(), 0);
+         int extraBits = sparsePrecision - precision;
+
+         auto apply = [this, extraBits](std::uint32_t encoded) {
+            std::uint32_t index = encoded >> 6;
+            std::uint32_t low = index & ((std::uint32_t { 1 } << extraBits) - 1);
+            std::size_t denseIndex = index >> extraBits;
+            auto rho = static_cast<std::uint8_t>(low != 0
+                ? std::countl_zero(low) - (32 - extraBits) + 1
+                : extraBits + (encoded & 0x3F));
+
+            registers[denseIndex] = std::max(registers[denseIndex], rho);
+         };
+
+         for (auto encoded : sparseList) {
+            apply(encoded);
+         }
+
+         for (auto encoded : sparseBuffer) {
+            apply(encoded);
+         }
+
+         sparse = false;
+         sparseList.clear();
+         sparseList.shrink_to_fit();
+         sparseBuffer.clear();
+         sparseBuffer.shrink_to_fit();
+      }
+
+      /**
+       * @brief Calcula o máximo elemento a elemento de dois vetores de
+       * registradores, com SSE2/AVX2 quando disponíveis.
+       *
+       * @param target Os registradores de destino.
+       * @param source Os registradores de origem.
+       * @param size O número de registradores.
+       */
+      static void mergeRegisters(
+        std::uint8_t* target, std::uint8_t const* source, std::size_t size) {
+         std::size_t i = 0;
+
+#if defined(__AVX2__)
+         for (; i + 32 <= size; i += 32) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<__m256i*>(target + i));
+            __m256i b
+              = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(source + i));
+            _mm256_storeu_si256(
+              reinterpret_cast<__m256i*>(target + i), _mm256_max_epu8(a, b));
+         }
+#elif defined(__SSE2__)
+         for (; i + 16 <= size; i += 16) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<__m128i*>(target + i));
+            __m128i b
+              = _mm_loadu_si128(reinterpret_cast<__m128i const*>(source + i));
+            _mm_storeu_si128(
+              reinterpret_cast<__m128i*>(target + i), _mm_max_epu8(a, b));
+         }
+#endif
+
+         for (; i < size; ++i) {
+            target[i] = std::max(target[i], source[i]);
+         }
+      }
+
+      /**
+       * @brief Função auxiliar sigma do estimador de Ertl.
+       */
+      static double sigma(double x) {
+         if (x == 1) {
+            return std::numeric_limits<double>::infinity();
+         }
+
+         double y = 1;
+         double z = x;
+         double previous;
+
+         do {
+            x *= x;
+            previous = z;
+            z += x * y;
+            y += y;
+         } while (z != previous);
+
+         return z;
+      }
+
+      /**
+       * @brief Função auxiliar tau do estimador de Ertl.
+       */
+      static double tau(double x) {
+         if (x == 0 || x == 1) {
+            return 0;
+         }
+
+         double y = 1;
+         double z = 1 - x;
+         double previous;
+
+         do {
+            x = std::sqrt(x);
+            previous = z;
+            y *= 0.5;
+            z -= std::pow(1 - x, 2) * y;
+         } while (z != previous);
+
+         return z / 3;
+      }
+
+  public:
+      /**
+       * @brief Construtor com a precisão do estimador.
+       *
+       * @param precision O logaritmo do número de registradores, entre 4 e 18.
+       * O padrão é 14 (16 KiB, erro padrão de ~0,81%).
+       *
+       * @throws std::runtime_error se a precisão estiver fora de [4, 18].
+       */
+      HyperLogLog(int precision = 14) : precision(precision) {
+         checkPrecision();
+      }
+
+      /**
+       * @brief Adiciona um valor ao estimador.
+       *
+       * @param value O valor a ser adicionado.
+       *
+       * @return A referência do objeto de HyperLogLog atual.
+       */
+      HyperLogLog& push(TYPE value) {
+         std::uint64_t hashed = hashValue(value);
+
+         if (!sparse) {
+            insertDense(hashed);
+            return *this;
+         }
+
+         sparseBuffer.push_back(encodeSparse(hashed));
+         if (sparseBuffer.size() * sizeof(std::uint32_t) * 4 >= registerCount()) {
+            flushSparseBuffer();
+         }
+
+         return *this;
+      }
+
+      /**
+       * @brief Adiciona um range de valores ao estimador.
+       *
+       * @param values Os valores a serem adicionados.
+       *
+       * @return A referência do objeto de HyperLogLog atual.
+       */
+      HyperLogLog& pushBatch(std::span<TYPE const> values) {
+         std::size_t i = 0;
+
+         for (; sparse && i < values.size(); ++i) {
+            push(values[i]);
+         }
+
+         for (; i < values.size(); ++i) {
+            insertDense(hashValue(values[i]));
+         }
+
+         return *this;
+      }
+
+      /**
+       * @brief Adiciona um range de valores ao estimador.
+       *
+       * @tparam ItInput Tipo do iterador de entrada.
+       *
+       * @param first Primeiro valor do range.
+       * @param last Ultimo valor do range.
+       *
+       * @return A referência do objeto de HyperLogLog atual.
+       */
+      template <typename ItInput,
+        typename = typename std::iterator_traits<ItInput>::iterator_category>
+      HyperLogLog& pushBatch(ItInput first, ItInput last) {
+         for (; first != last; ++first) {
+            push(*first);
+         }
+
+         return *this;
+      }
+
+      /**
+       * @brief Junta outro estimador a este.
+       *
+       * @param other O estimador a ser juntado. Deve ter a mesma precisão.
+       *
+       * @return A referência do objeto de HyperLogLog atual.
+       *
+       * @throws std::runtime_error se as precisões forem diferentes.
+       */
+      HyperLogLog& merge(HyperLogLog const& other) {
+         if (precision != other.precision) {
+            throw std::runtime_error("HyperLogLog precisions are different");
+         }
+
+         // Inserir em um vetor a partir dele mesmo não é permitido. Juntar
+         // um estimador a si mesmo não muda os registradores.
+         if (&other == this) {
+            flushSparseBuffer();
+            return *this;
+         }
+
+         if (other.sparse) {
+            if (sparse) {
+               sparseBuffer.insert(sparseBuffer.end(),
+                 other.sparseList.begin(),
+                 other.sparseList.end());
+               sparseBuffer.insert(sparseBuffer.end(),
+                 other.sparseBuffer.begin(),
+                 other.sparseBuffer.end());
+               flushSparseBuffer();
+            } else {
+               HyperLogLog copy(other);
+               copy.toDense();
+               mergeRegisters(
+                 registers.data(), copy.registers.data(), registerCount());
+            }
+
+            return *this;
+         }
+
+         if (sparse) {
+            toDense();
+         }
+
+         mergeRegisters(
+           registers.data(), other.registers.data(), registerCount());
+
+         return *this;
+      }
+
+      /**
+       * @brief Informa se o estimador ainda usa a representação esparsa.
+       *
+       * @return True se a representação é esparsa e False caso contrário.
+       */
+      bool isSparse() const { return sparse; }
+
+      /**
+       * @brief Retorna a precisão do estimador.
+       *
+       * @return O logaritmo do número de registradores.
+       */
+      int getPrecision() const { return precision; }
+
+      /**
+       * @brief Estima o número de valores distintos vistos.
+       *
+       * @return A estimativa do número de valores distintos.
+       */
+      double estimate() const {
+         if (sparse) {
+            HyperLogLog copy(*this);
+            copy.flushSparseBuffer();
+
+            if (copy.sparse) {
+               double m = static_cast<double>(std::uint64_t { 1 } << sparsePrecision);
+               double empty = m - copy.sparseList.size();
+               return m * std::log(m / empty);
+            }
+
+            return copy.estimate();
+         }
+
+         int q = 64 - precision;
+         std::vector<std::size_t> histogram(q + 2, 0);
+         for (auto value : registers) {
+            ++histogram[value];
+         }
+
+         double m = static_cast<double>(registerCount());
+         double z = m * tau(1 - histogram[q + 1] / m);
+         for (int k = q; k >= 1; --k) {
+            z = 0.5 * (z + histogram[k]);
+         }
+
+         z += m * sigma(histogram[0] / m);
+
+         return m * m / (2 * std::log(2.0) * z);
+      }
+
+      /**
+       * @brief Estima o número de valores distintos vistos.
+       *
+       * @return A estimativa arredondada do número de valores distintos.
+       */
+      std::uint64_t distinctCount() const {
+         return static_cast<std::uint64_t>(std::llround(estimate()));
+      }
+
+      /**
+       * @brief Serializa o estimador em um formato binário compacto.
+       *
+       * A representação esparsa é serializada como a lista ordenada de
+       * índices e a densa como os 2^p registradores.
+       *
+       * @return Os bytes do estimador.
+       */
+      std::vector<std::uint8_t> serialize() const {
+         HyperLogLog copy(*this);
+         copy.flushSparseBuffer();
+
+         ByteWriter writer;
+         writer.writeHeader(tag, version);
+         writer.writeType<TYPE>();
+         writer.write(static_cast<std::uint8_t>(copy.precision));
+         writer.write(static_cast<std::uint8_t>(copy.sparse));
+
+         if (copy.sparse) {
+            writer.writeArray(std::span<std::uint32_t const>(copy.sparseList));
+         } else {
+            writer.writeArray(std::span<std::uint8_t const>(copy.registers));
+         }
+
+         return writer.release();
+      }
+
+      /**
+       * @brief Reconstrói um estimador a partir dos bytes de serialize().
+       *
+       * @param bytes Os bytes do estimador.
+       *
+       * @return O estimador reconstruído.
+       *
+       * @throws std::runtime_error se os bytes forem inválidos.
+       */
+      static HyperLogLog deserialize(std::span<std::uint8_t const> bytes) {
+         ByteReader reader(bytes);
+         reader.readHeader(tag, version);
+         reader.readType<TYPE>();
+
+         int precision = reader.read<std::uint8_t>();
+         if (precision < minimumPrecision || precision > maximumPrecision) {
+            throw std::runtime_error("Serialized precision is invalid");
+         }
+
+         HyperLogLog estimator(precision);
+         estimator.sparse = reader.read<std::uint8_t>() != 0;
+
+         if (estimator.sparse) {
+            estimator.sparseList = reader.readArray<std::uint32_t>();
+            checkSparseList(estimator.sparseList);
+         } else {
+            estimator.registers = reader.readArray<std::uint8_t>();
+            if (estimator.registers.size() != estimator.registerCount()) {
+               throw std::runtime_error("Serialized registers have wrong size");
+            }
+
+            for (auto value : estimator.registers) {
+               if (value > 64 - precision + 1) {
+                  throw std::runtime_error("Serialized register is invalid");
+               }
+            }
+         }
+
+         return estimator;
+      }
+   };
+}
+
+#endif /// HYPER_LOG_LOG_HPP_
@@ -0,0 +1,428 @@
+/**
+ * @file IngestionQueue.hpp
+ * @author Pedro Lucas (pedrolucas.jsrn@gmail.com)
+ * @brief Arquivo de cabeçalho para as classes IngestionQueue e
+ * BackgroundAggregator.
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef INGESTION_QUEUE_HPP_
+#define INGESTION_QUEUE_HPP_
+
+#include "Generator.hpp"
+#include "StreamingStatistics.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace stats {
+   /**
+    * @class IngestionQueue
+    * @brief Uma fila circular limitada, sem locks, com vários produtores e um
+    * único consumidor.
+    *
+    * Cada posição guarda um número de sequência que diz se ela está livre
+    * para o produtor da volta atual ou pronta para o consumidor, como na fila
+    * limitada de Vyukov. Produtores disputam apenas o índice de escrita, com
+    * uma comparação-e-troca; o consumidor não usa operações atômicas de
+    * leitura-modificação-escrita.
+    *
+    * @tparam TYPE Define o tipo de dados. Deve ser um tipo numérico.
+    */
+   template <typename TYPE>
+   class IngestionQueue {
+      static_assert(std::is_arithmetic_v<TYPE>, "TYPE must be a numeric type");
+
+  private:
+      static constexpr std::size_t cacheLineSize = 64;
+
+      /**
+       * @brief Uma posição da fila.
+       */
+      struct Cell {
+         std::atomic<std::size_t> sequence;
+         TYPE value;
+      };
+
+      std::size_t mask;
+      std::unique_ptr<Cell[]> cells;
+      alignas(cacheLineSize) std::atomic<std::size_t> enqueuePosition { 0 };
+      alignas(cacheLineSize) std::atomic<std::size_t> dequeuePosition { 0 };
+
+  public:
+      /**
+       * @brief Construtor com a capacidade da fila.
+       *
+       * @param capacity O número de posições. Deve ser uma potência de 2.
+       *
+       * @throws std::runtime_error se a capacidade não for uma potência de 2.
+       */
+      IngestionQueue(std::size_t capacity) : mask(capacity - 1) {
+         if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+            throw std::runtime_error("Queue capacity is not a power of two");
+         }
+
+         cells.reset(new Cell[capacity]);
+
+         for (std::size_t i = 0; i < capacity; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+         }
+      }
+
+      IngestionQueue(IngestionQueue const&) = delete;
+      IngestionQueue& operator=(IngestionQueue const&) = delete;
+
+      /**
+       * @brief Tenta inserir um valor na fila. Pode ser chamado por várias
+       * threads.
+       *
+       * @param value O valor.
+       *
+       * @return True se o valor foi inserido e False se a fila estava cheia.
+       */
+      bool tryPush(TYPE value) {
+         std::size_t position = enqueuePosition.load(std::memory_order_relaxed);
+
+         while (true) {
+            Cell& cell = cells[position & mask];
+            std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            auto difference = static_cast<std::ptrdiff_t>(sequence - position);
+
+            if (difference == 0) {
+               if (enqueuePosition.compare_exchange_weak(
+                     position, position + 1, std::memory_order_relaxed)) {
+                  cell.value = value;
+                  cell.sequence.store(position + 1, std::memory_order_release);
+                  return true;
+               }
+            } else if (difference < 0) {
+               return false;
+            } else {
+               position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+         }
+      }
+
+      /**
+       * @brief Retira até `output.size()` valores da fila. Deve ser chamado
+       * apenas pela thread consumidora.
+       *
+       * @param output Destino dos valores.
+       *
+       * @return O número de valores retirados.
+       */
+      std::size_t popBatch(std::span<TYPE> output) {
+         std::size_t position = dequeuePosition.load(std::memory_order_relaxed);
+         std::size_t taken = 0;
+
+         while (taken < output.size()) {
+            Cell& cell = cells[position & mask];
+            if (cell.sequence.load(std::memory_order_acquire) != position + 1) {
+               break;
+            }
+
+            output[taken++] = cell.value;
+            cell.sequence.store(position + mask + 1, std::memory_order_release);
+            ++position;
+         }
+
+         dequeuePosition.store(position, std::memory_order_release);
+         return taken;
+      }
+
+      /**
+       * @brief Retorna quantos valores foram inseridos desde a criação.
+       *
+       * @return O número de inserções.
+       */
+      std::size_t pushed() const {
+         return enqueuePosition.load(std::memory_order_acquire);
+      }
+
+      /**
+       * @brief Retorna quantos valores foram retirados desde a criação.
+       *
+       * @return O número de retiradas.
+       */
+      std::size_t popped() const {
+         return dequeuePosition.load(std::memory_order_acquire);
+      }
+
+      /**
+       * @brief Retorna o número aproximado de valores na fila.
+       *
+       * @return A profundidade da fila.
+       */
+      std::size_t depth() const {
+         std::size_t head = popped();
+         std::size_t tail = pushed();
+
+         return tail > head ? tail - head : 0;
+      }
+
+      /**
+       * @brief Retorna a capacidade da fila.
+       *
+       * @return O número de posições.
+       */
+      std::size_t capacity() const { return mask + 1; }
+   };
+
+   /**
+    * @brief Política aplicada quando a fila de ingestão está cheia.
+    */
+   enum class OverflowPolicy {
+      /** Descarta o valor. */
+      Drop,
+      /** A partir de metade da capacidade aceita só um a cada `sampleRate`
+          valores; com a fila cheia, descarta. */
+      Sample,
+      /** Espera até haver espaço. */
+      Block
+   };
+
+   /**
+    * @class BackgroundAggregator
+    * @brief Uma classe que recebe valores de várias threads por uma
+    * IngestionQueue e os agrega em uma thread própria.
+    *
+    * Os produtores só escrevem na fila e nunca esperam pela agregação (exceto
+    * com OverflowPolicy::Block e a fila cheia). A thread agregadora retira os
+    * valores em lotes, aplica cada lote de uma vez ao acumulador e publica
+    * uma cópia dele em intervalos regulares e quando flush() espera por ela.
+    * Assim um fluxo lento de valores não copia o acumulador a cada lote, o
+    * que com Statistics custaria uma cópia de todos os valores guardados.
+    *
+    * @tparam TYPE Define o tipo de dados. Deve ser um tipo numérico.
+    * @tparam ACCUMULATOR O acumulador. Deve ser copiável e ter
+    * `pushBatch(std::span<TYPE const>)` ou `addValues(first, last)`, como
+    * StreamingStatistics, QuantileSketch, HeavyHitters ou Statistics.
+    */
+   template <typename TYPE, typename ACCUMULATOR = StreamingStatistics<TYPE>>
+   class BackgroundAggregator {
+  private:
+      IngestionQueue<TYPE> queue;
+      OverflowPolicy policy;
+      std::size_t sampleRate;
+      std::chrono::milliseconds publishInterval;
+
+      ACCUMULATOR accumulator;
+      ACCUMULATOR published;
+      mutable std::mutex publishedMutex;
+
+      std::atomic<std::uint64_t> droppedValues { 0 };
+      std::atomic<std::uint64_t> sampledOutValues { 0 };
+      std::atomic<std::size_t> sampleCounter { 0 };
+      std::atomic<std::size_t> appliedPosition { 0 };
+      mutable std::atomic<std::size_t> flushTarget { 0 };
+      std::atomic<bool> running { true };
+      std::thread worker;
+
+      /**
+       * @brief Publica uma cópia do acumulador para os leitores.
+       */
+      void publish() {
+         std::lock_guard lock(publishedMutex);
+         published = accumulator;
+      }
+
+      /**
+       * @brief Laço da thread agregadora.
+       *
+       * @param batchSize O tamanho máximo de cada lote.
+       */
+      void run(std::size_t batchSize) {
+         std::vector<TYPE> batch(batchSize);
+         auto lastPublish = std::chrono::steady_clock::now();
+         bool dirty = false;
+         int idleRounds = 0;
+
+         while (true) {
+            bool stopping = !running.load(std::memory_order_acquire);
+            std::size_t taken = queue.popBatch(batch);
+
+            if (taken > 0) {
+               feedBatch(
+                 accumulator, std::span<TYPE const>(batch.data(), taken));
+               dirty = true;
+               idleRounds = 0;
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            bool drained = taken < batchSize;
+            bool requested = drained
+              && flushTarget.load(std::memory_order_acquire)
+                > appliedPosition.load(std::memory_order_relaxed);
+            if (dirty && (requested || now - lastPublish >= publishInterval)) {
+               publish();
+               appliedPosition.store(queue.popped(), std::memory_order_release);
+               lastPublish = now;
+               dirty = false;
+            }
+
+            if (!drained) {
+               continue;
+            }
+
+            if (stopping && queue.depth() == 0) {
+               return;
+            }
+
+            if (++idleRounds < 64) {
+               std::this_thread::yield();
+            } else {
+               std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+         }
+      }
+
+  public:
+      /**
+       * @brief Construtor que inicia a thread agregadora.
+       *
+       * @param capacity A capacidade da fila. Deve ser uma potência de 2. O
+       * padrão é 65536.
+       * @param policy A política para a fila cheia. O padrão é Drop.
+       * @param sampleRate Com OverflowPolicy::Sample, aceita um a cada
+       * `sampleRate` valores quando a fila passa da metade. O padrão é 8.
+       * @param publishInterval O intervalo máximo entre publicações. O padrão
+       * é 100 ms.
+       * @param batchSize O tamanho máximo de cada lote. O padrão é 4096.
+       * @param accumulator O acumulador inicial.
+       *
+       * @throws std::runtime_error se a capacidade não for uma potência de 2
+       * ou se sampleRate ou batchSize forem zero.
+       */
+      BackgroundAggregator(std::size_t capacity = 65536,
+        OverflowPolicy policy = OverflowPolicy::Drop,
+        std::size_t sampleRate = 8,
+        std::chrono::milliseconds publishInterval
+        = std::chrono::milliseconds(100),
+        std::size_t batchSize = 4096,
+        ACCUMULATOR accumulator = ACCUMULATOR())
+          : queue(capacity)
+          , policy(policy)
+          , sampleRate(sampleRate)
+          , publishInterval(publishInterval)
+          , accumulator(accumulator)
+          , published(accumulator) {
+         if (sampleRate == 0 || batchSize == 0) {
+            throw std::runtime_error("Sample rate or batch size is zero");
+         }
+
+         worker = std::thread([this, batchSize] { run(batchSize); });
+      }
+
+      BackgroundAggregator(BackgroundAggregator const&) = delete;
+      BackgroundAggregator& operator=(BackgroundAggregator const&) = delete;
+
+      /**
+       * @brief Destrutor que agrega os valores pendentes e encerra a thread
+       * agregadora.
+       */
+      ~BackgroundAggregator() {
+         running.store(false, std::memory_order_release);
+         worker.join();
+      }
+
+      /**
+       * @brief Envia um valor para a agregação. Pode ser chamado por várias
+       * threads.
+       *
+       * @param value O valor.
+       *
+       * @return True se o valor entrou na fila e False se foi descartado pela
+       * política.
+       */
+      bool push(TYPE value) {
+         if (policy == OverflowPolicy::Sample
+           && queue.depth() > queue.capacity() / 2) {
+            auto offered
+              = sampleCounter.fetch_add(1, std::memory_order_relaxed) + 1;
+            if (offered % sampleRate != 0) {
+               sampledOutValues.fetch_add(1, std::memory_order_relaxed);
+               return false;
+            }
+         }
+
+         if (queue.tryPush(value)) {
+            return true;
+         }
+
+         if (policy == OverflowPolicy::Block) {
+            do {
+               std::this_thread::yield();
+            } while (!queue.tryPush(value));
+
+            return true;
+         }
+
+         droppedValues.fetch_add(1, std::memory_order_relaxed);
+         return false;
+      }
+
+      /**
+       * @brief Espera até que todos os valores enviados antes da chamada
+       * estejam refletidos no acumulado publicado.
+       */
+      void flush() const {
+         std::size_t target = queue.pushed();
+         std::size_t requested = flushTarget.load(std::memory_order_relaxed);
+         while (requested < target
+           && !flushTarget.compare_exchange_weak(
+             requested, target, std::memory_order_release)) { }
+
+         while (appliedPosition.load(std::memory_order_acquire) < target) {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+         }
+      }
+
+      /**
+       * @brief Retorna a última cópia publicada do acumulador.
+       *
+       * @return O acumulado publicado.
+       */
+      ACCUMULATOR snapshot() const {
+         std::lock_guard lock(publishedMutex);
+         return published;
+      }
+
+      /**
+       * @brief Retorna quantos valores foram descartados com a fila cheia.
+       *
+       * @return O número de descartes.
+       */
+      std::uint64_t dropped() const {
+         return droppedValues.load(std::memory_order_relaxed);
+      }
+
+      /**
+       * @brief Retorna quantos valores a política de amostragem recusou.
+       *
+       * @return O número de valores recusados pela amostragem.
+       */
+      std::uint64_t sampledOut() const {
+         return sampledOutValues.load(std::memory_order_relaxed);
+      }
+
+      /**
+       * @brief Retorna o número aproximado de valores esperando na fila.
+       *
+       * @return A profundidade da fila.
+       */
+      std::size_t queueDepth() const { return queue.depth(); }
+   };
+}
+
+#endif /// INGESTION_QUEUE_HPP_
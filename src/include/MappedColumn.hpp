@@ -0,0 +1,302 @@
+/**
+ * @file MappedColumn.hpp
+ * @author Pedro Lucas (pedrolucas.jsrn@gmail.com)
+ * @brief Arquivo de cabeçalho para a classe MappedColumn.
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef MAPPED_COLUMN_HPP_
+#define MAPPED_COLUMN_HPP_
+
+#include "Serialization.hpp"
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace stats {
+   /**
+    * @class MappedColumn
+    * @brief Uma coluna de valores lida de um arquivo mapeado em memória, sem
+    * cópia e sem alocação no heap.
+    *
+    * O arquivo é um vetor little-endian de TYPE, opcionalmente precedido de
+    * um cabeçalho de 32 bytes com a marca "SCOL", a versão, o tipo e a
+    * contagem dos valores. Sem o cabeçalho, a contagem vem do tamanho do
+    * arquivo. As páginas são lidas pelo sistema sob demanda, com as dicas
+    * MADV_SEQUENTIAL e MADV_HUGEPAGE, então um arquivo maior que a memória
+    * pode ser percorrido por StatisticsView, StreamingStatistics::pushBatch
+    * ou qualquer função que receba um std::span.
+    *
+    * @tparam TYPE Define o tipo de dados. Deve ser um tipo numérico.
+    */
+   template <typename TYPE>
+   class MappedColumn {
+      static_assert(std::is_arithmetic_v<TYPE>, "TYPE must be a numeric type");
+      static_assert(std::endian::native == std::endian::little,
+        "MappedColumn requires a little-endian machine");
+
+  private:
+      static constexpr std::uint32_t tag = serializationTag("SCOL");
+      static constexpr std::uint16_t version = 1;
+      void* address = nullptr;
+      std::size_t mappedBytes = 0;
+      std::span<TYPE const> data;
+
+      /**
+       * @brief Monta a mensagem de um erro do sistema.
+       *
+       * @param message A descrição da operação.
+       * @param path O caminho do arquivo.
+       *
+       * @return A mensagem com o caminho e a descrição do errno.
+       */
+      static std::string systemError(
+        std::string const& message, std::string const& path) {
+         return message + " '" + path + "': " + std::strerror(errno);
+      }
+
+      /**
+       * @brief Monta o cabeçalho do arquivo.
+       *
+       * @param count O número de valores.
+       *
+       * @return Os bytes do cabeçalho.
+       */
+      static ByteWriter header(std::uint64_t count) {
+         ByteWriter writer;
+         writer.writeHeader(tag, version);
+         writer.write(static_cast<std::uint16_t>(sizeof(TYPE)));
+         writer.write(
+           static_cast<std::uint8_t>(std::is_floating_point_v<TYPE>));
+         writer.write(static_cast<std::uint8_t>(std::is_signed_v<TYPE>));
+         writer.write(count);
+
+         while (writer.getBytes().size() < headerSize) {
+            writer.write(std::uint8_t { 0 });
+         }
+
+         return writer;
+      }
+
+  public:
+      /**
+       * @brief O tamanho do cabeçalho opcional, em bytes.
+       */
+      static constexpr std::size_t headerSize = 32;
+
+      /**
+       * @brief Encontra os valores em um arquivo de coluna a partir dos seus
+       * primeiros bytes.
+       *
+       * @param head Os primeiros bytes do arquivo (até 32).
+       * @param fileBytes O tamanho do arquivo.
+       *
+       * @return A posição do primeiro valor, em bytes, e o número de valores.
+       *
+       * @throws std::runtime_error se o cabeçalho for de outro tipo ou se o
+       * tamanho não for compatível com TYPE.
+       */
+      static std::pair<std::size_t, std::size_t> layout(
+        std::span<std::uint8_t const> head, std::size_t fileBytes) {
+         std::uint32_t fileTag = 0;
+         if (fileBytes >= headerSize && head.size() >= headerSize) {
+            std::memcpy(&fileTag, head.data(), sizeof(fileTag));
+         }
+
+         if (fileTag != tag) {
+            if (fileBytes % sizeof(TYPE) != 0) {
+               throw std::runtime_error(
+                 "Column file size is not a multiple of the type size");
+            }
+
+            return { 0, fileBytes / sizeof(TYPE) };
+         }
+
+         ByteReader reader(head.first(headerSize));
+         reader.readHeader(tag, version);
+         auto typeSize = reader.read<std::uint16_t>();
+         auto floatingPoint = reader.read<std::uint8_t>();
+         auto isSigned = reader.read<std::uint8_t>();
+         auto count = reader.read<std::uint64_t>();
+
+         if (typeSize != sizeof(TYPE)
+           || floatingPoint != std::is_floating_point_v<TYPE>
+           || isSigned != std::is_signed_v<TYPE>) {
+            throw std::runtime_error("Column file has another type");
+         }
+
+         if (count > (fileBytes - headerSize) / sizeof(TYPE)) {
+            throw std::runtime_error("Column file is truncated");
+         }
+
+         return { headerSize, count };
+      }
+
+      /**
+       * @brief Construtor de uma coluna vazia.
+       */
+      MappedColumn() = default;
+
+      /**
+       * @brief Mapeia um arquivo.
+       *
+       * @param path O caminho do arquivo.
+       * @param detectHeader Define se o cabeçalho "SCOL" é procurado. Use
+       * False para mapear bytes brutos, como um arquivo de texto que pode
+       * começar com esses caracteres. O padrão é True.
+       *
+       * @throws std::runtime_error se o arquivo não puder ser mapeado, se o
+       * cabeçalho for de outro tipo ou se o tamanho não for compatível com
+       * TYPE.
+       */
+      explicit MappedColumn(std::string const& path, bool detectHeader = true) {
+         int descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+         if (descriptor < 0) {
+            throw std::runtime_error(systemError("Could not open file", path));
+         }
+
+         struct stat status;
+         if (fstat(descriptor, &status) != 0) {
+            auto message = systemError("Could not stat file", path);
+            close(descriptor);
+            throw std::runtime_error(message);
+         }
+
+         mappedBytes = static_cast<std::size_t>(status.st_size);
+         if (mappedBytes == 0) {
+            close(descriptor);
+            return;
+         }
+
+         address
+           = mmap(nullptr, mappedBytes, PROT_READ, MAP_SHARED, descriptor, 0);
+         close(descriptor);
+
+         if (address == MAP_FAILED) {
+            address = nullptr;
+            throw std::runtime_error(systemError("Could not map file", path));
+         }
+
+#if defined(MADV_SEQUENTIAL)
+         madvise(address, mappedBytes, MADV_SEQUENTIAL);
+#endif
+#if defined(MADV_HUGEPAGE)
+         madvise(address, mappedBytes, MADV_HUGEPAGE);
+#endif
+
+         auto bytes = static_cast<std::uint8_t const*>(address);
+         std::pair<std::size_t, std::size_t> found;
+
+         try {
+            // Sem os primeiros bytes, layout trata o arquivo como bruto.
+            auto head = detectHeader ? std::min(headerSize, mappedBytes) : 0;
+            found = layout(std::span(bytes, head), mappedBytes);
+         } catch (...) {
+            munmap(address, mappedBytes);
+            address = nullptr;
+            throw;
+         }
+
+         data = std::span<TYPE const>(
+           reinterpret_cast<TYPE const*>(bytes + found.first), found.second);
+      }
+
+      MappedColumn(MappedColumn const&) = delete;
+      MappedColumn& operator=(MappedColumn const&) = delete;
+
+      /**
+       * @brief Construtor de movimento.
+       *
+       * @param other O objeto movido.
+       */
+      MappedColumn(MappedColumn&& other) noexcept
+          : address(std::exchange(other.address, nullptr)),
+            mappedBytes(std::exchange(other.mappedBytes, 0)),
+            data(std::exchange(other.data, {})) { }
+
+      /**
+       * @brief Atribuição por movimento.
+       *
+       * @param other O objeto movido.
+       *
+       * @return A referência do objeto de MappedColumn atual.
+       */
+      MappedColumn& operator=(MappedColumn&& other) noexcept {
+         if (this != &other) {
+            if (address != nullptr) {
+               munmap(address, mappedBytes);
+            }
+
+            address = std::exchange(other.address, nullptr);
+            mappedBytes = std::exchange(other.mappedBytes, 0);
+            data = std::exchange(other.data, {});
+         }
+
+         return *this;
+      }
+
+      /**
+       * @brief Destrutor que desfaz o mapeamento.
+       */
+      ~MappedColumn() {
+         if (address != nullptr) {
+            munmap(address, mappedBytes);
+         }
+      }
+
+      /**
+       * @brief Escreve os valores em um arquivo com cabeçalho.
+       *
+       * @param path O caminho do arquivo.
+       * @param values Os valores.
+       *
+       * @throws std::runtime_error se o arquivo não puder ser escrito.
+       */
+      static void write(std::string const& path, std::span<TYPE const> values) {
+         std::ofstream file(path, std::ios::binary | std::ios::trunc);
+         auto bytes = header(values.size()).release();
+
+         file.write(reinterpret_cast<char const*>(bytes.data()), bytes.size());
+         file.write(reinterpret_cast<char const*>(values.data()),
+           static_cast<std::streamsize>(values.size_bytes()));
+
+         if (!file) {
+            throw std::runtime_error("Could not write file '" + path + "'");
+         }
+      }
+
+      /**
+       * @brief Retorna os valores mapeados.
+       *
+       * @return Os valores, válidos enquanto o objeto existir.
+       */
+      std::span<TYPE const> values() const { return data; }
+
+      /**
+       * @brief Retorna o número de valores.
+       *
+       * @return O número de valores.
+       */
+      std::size_t size() const { return data.size(); }
+   };
+}
+
+#endif /// MAPPED_COLUMN_HPP_
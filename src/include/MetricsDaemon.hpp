@@ -0,0 +1,647 @@
+/**
+ * @file MetricsDaemon.hpp
+ * @author Pedro Lucas (pedrolucas.jsrn@gmail.com)
+ * @brief Arquivo de cabeçalho para a classe MetricsDaemon.
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef METRICS_DAEMON_HPP_
+#define METRICS_DAEMON_HPP_
+
+#include "QuantileSketch.hpp"
+#include "StreamingStatistics.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace stats {
+   /**
+    * @class MetricsDaemon
+    * @brief Um agregador de métricas local, no estilo do statsd, que recebe
+    * datagramas por UDP na interface de loopback e por um socket Unix.
+    *
+    * Cada datagrama tem uma ou mais linhas no formato
+    * `chave:valor[:valor...][|sufixo]`; o sufixo (tipo e taxa de amostragem
+    * do statsd) é ignorado e linhas inválidas são contadas e descartadas.
+    *
+    * Cada socket tem uma thread receptora que lê até 64 datagramas por
+    * chamada de recvmmsg() e separa as amostras por fragmento, pelo hash da
+    * chave. Ao fim de cada leitura em lote, os lotes de amostras são
+    * entregues às threads trabalhadoras com uma única trava por fragmento.
+    * Cada trabalhadora é dona das séries das suas chaves, um
+    * StreamingStatistics e um QuantileSketch por chave, então a agregação
+    * não disputa travas com as outras. Várias receptoras UDP podem dividir a
+    * mesma porta com SO_REUSEPORT.
+    */
+   class MetricsDaemon {
+  public:
+      /**
+       * @brief As estatísticas de uma chave.
+       */
+      struct Series {
+         StreamingStatistics<double> statistics;
+         QuantileSketch<double> sketch;
+      };
+
+  private:
+      static constexpr std::size_t batchMessages = 64;
+      static constexpr std::size_t messageBytes = 16384;
+
+      /**
+       * @brief Hash de chaves que aceita std::string e std::string_view.
+       */
+      struct KeyHash {
+         using is_transparent = void;
+
+         std::size_t operator()(std::string_view key) const {
+            return std::hash<std::string_view>()(key);
+         }
+      };
+
+      using SeriesMap
+        = std::unordered_map<std::string, Series, KeyHash, std::equal_to<>>;
+
+      /**
+       * @brief Uma amostra de um lote, com a chave guardada no texto do lote.
+       */
+      struct Sample {
+         std::uint32_t keyOffset;
+         std::uint32_t keyLength;
+         double value;
+      };
+
+      /**
+       * @brief As amostras de um fragmento lidas por uma receptora.
+       */
+      struct Batch {
+         std::string keys;
+         std::vector<Sample> samples;
+      };
+
+      /**
+       * @brief Um fragmento das chaves, com a sua thread trabalhadora.
+       */
+      struct Shard {
+         std::mutex pendingMutex;
+         std::condition_variable pendingChanged;
+         std::vector<Batch> pending;
+
+         std::mutex seriesMutex;
+         SeriesMap series;
+
+         std::thread worker;
+      };
+
+      std::size_t sketchK;
+      std::vector<std::unique_ptr<Shard>> shards;
+      std::vector<int> sockets;
+      std::vector<std::thread> receivers;
+      std::string unixPath;
+      int wakeDescriptor = -1;
+      std::atomic<bool> stopping { false };
+      std::atomic<bool> draining { false };
+
+      std::atomic<std::uint64_t> datagramCount { 0 };
+      std::atomic<std::uint64_t> sampleCount { 0 };
+      std::atomic<std::uint64_t> malformedCount { 0 };
+
+      /**
+       * @brief Monta a mensagem de um erro do sistema.
+       *
+       * @param what A operação que falhou.
+       *
+       * @return A mensagem com a descrição de errno.
+       */
+      static std::string systemError(std::string const& what) {
+         return what + ": " + std::strerror(errno);
+      }
+
+      /**
+       * @brief Lê as linhas de um datagrama, guardando as amostras no lote
+       * do fragmento de cada chave.
+       *
+       * @param text O datagrama.
+       * @param batches Os lotes da receptora, um por fragmento.
+       */
+      void parseDatagram(std::string_view text, std::vector<Batch>& batches) {
+         std::uint64_t samples = 0;
+         std::uint64_t malformed = 0;
+
+         while (!text.empty()) {
+            std::size_t lineEnd = text.find('\n');
+            std::string_view line = text.substr(0, lineEnd);
+            text.remove_prefix(
+              lineEnd == std::string_view::npos ? text.size() : lineEnd + 1);
+
+            if (!line.empty() && line.back() == '\r') {
+               line.remove_suffix(1);
+            }
+            if (line.empty()) {
+               continue;
+            }
+
+            line = line.substr(0, line.find('|'));
+            std::size_t colon = line.find(':');
+            if (colon == 0 || colon == std::string_view::npos
+              || colon == line.size() - 1) {
+               ++malformed;
+               continue;
+            }
+
+            std::string_view key = line.substr(0, colon);
+            auto& batch = batches[KeyHash()(key) % batches.size()];
+            std::size_t firstSample = batch.samples.size();
+            auto keyOffset = static_cast<std::uint32_t>(batch.keys.size());
+            char const* position = line.data() + colon + 1;
+            char const* end = line.data() + line.size();
+            bool valid = true;
+
+            while (valid) {
+               double value = 0;
+               auto result = std::from_chars(position, end, value);
+               valid = result.ec == std::errc()
+                 && (result.ptr == end || *result.ptr == ':');
+
+               if (valid) {
+                  batch.samples.push_back({ keyOffset,
+                    static_cast<std::uint32_t>(key.size()),
+                    value });
+               }
+               if (!valid || result.ptr == end) {
+                  break;
+               }
+               position = result.ptr + 1;
+            }
+
+            if (valid) {
+               batch.keys.append(key);
+               samples += batch.samples.size() - firstSample;
+            } else {
+               batch.samples.resize(firstSample);
+               ++malformed;
+            }
+         }
+
+         sampleCount.fetch_add(samples, std::memory_order_relaxed);
+         malformedCount.fetch_add(malformed, std::memory_order_relaxed);
+      }
+
+      /**
+       * @brief Entrega os lotes de uma receptora às trabalhadoras.
+       *
+       * @param batches Os lotes, um por fragmento. Saem vazios.
+       */
+      void handOff(std::vector<Batch>& batches) {
+         for (std::size_t index = 0; index < shards.size(); ++index) {
+            if (batches[index].samples.empty()) {
+               continue;
+            }
+
+            auto& shard = *shards[index];
+            {
+               std::lock_guard lock(shard.pendingMutex);
+               shard.pending.push_back(std::move(batches[index]));
+            }
+            shard.pendingChanged.notify_one();
+
+            batches[index] = Batch();
+         }
+      }
+
+      /**
+       * @brief Laço de uma thread receptora.
+       *
+       * @param descriptor O socket, não bloqueante.
+       */
+      void receive(int descriptor) {
+         std::vector<char> buffer(batchMessages * messageBytes);
+         std::vector<iovec> vectors(batchMessages);
+         std::vector<mmsghdr> messages(batchMessages);
+         std::vector<Batch> batches(shards.size());
+
+         for (std::size_t i = 0; i < batchMessages; ++i) {
+            vectors[i] = { buffer.data() + i * messageBytes, messageBytes };
+            messages[i] = {};
+            messages[i].msg_hdr.msg_iov = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+         }
+
+         while (!stopping.load(std::memory_order_acquire)) {
+            int count = recvmmsg(descriptor,
+              messages.data(),
+              static_cast<unsigned>(batchMessages),
+              0,
+              nullptr);
+
+            if (count < 0) {
+               if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                  std::array<pollfd, 2> waiting { {
+                    { descriptor, POLLIN, 0 },
+                    { wakeDescriptor, POLLIN, 0 },
+                  } };
+                  poll(waiting.data(), waiting.size(), -1);
+               }
+               continue;
+            }
+
+            for (int i = 0; i < count; ++i) {
+               auto& header = messages[i].msg_hdr;
+               if ((header.msg_flags & MSG_TRUNC) != 0) {
+                  malformedCount.fetch_add(1, std::memory_order_relaxed);
+               } else {
+                  parseDatagram(
+                    std::string_view(buffer.data() + i * messageBytes,
+                      messages[i].msg_len),
+                    batches);
+               }
+               header.msg_flags = 0;
+            }
+
+            datagramCount.fetch_add(count, std::memory_order_relaxed);
+            handOff(batches);
+         }
+      }
+
+      /**
+       * @brief Laço de uma thread trabalhadora.
+       *
+       * @param shard O fragmento da trabalhadora.
+       */
+      void work(Shard& shard) {
+         std::vector<Batch> taken;
+
+         while (true) {
+            {
+               std::unique_lock lock(shard.pendingMutex);
+               shard.pendingChanged.wait(lock, [&] {
+                  return !shard.pending.empty()
+                    || draining.load(std::memory_order_acquire);
+               });
+
+               if (shard.pending.empty()) {
+                  return;
+               }
+               taken.swap(shard.pending);
+            }
+
+            std::lock_guard lock(shard.seriesMutex);
+            for (auto const& batch : taken) {
+               std::string_view lastKey;
+               Series* series = nullptr;
+
+               for (auto const& sample : batch.samples) {
+                  std::string_view key(
+                    batch.keys.data() + sample.keyOffset, sample.keyLength);
+
+                  if (series == nullptr || key != lastKey) {
+                     auto found = shard.series.find(key);
+                     if (found == shard.series.end()) {
+                        Series created { {}, QuantileSketch<double>(sketchK) };
+                        found = shard.series
+                                  .emplace(std::string(key), std::move(created))
+                                  .first;
+                     }
+                     series = &found->second;
+                     lastKey = key;
+                  }
+
+                  series->statistics.push(sample.value);
+                  series->sketch.push(sample.value);
+               }
+            }
+
+            taken.clear();
+         }
+      }
+
+      /**
+       * @brief Configura um socket recém-criado e inicia a sua receptora.
+       *
+       * @param descriptor O socket, já associado ao endereço.
+       */
+      void startReceiver(int descriptor) {
+         if (stopping.load(std::memory_order_acquire)) {
+            close(descriptor);
+            throw std::runtime_error("Daemon is stopped");
+         }
+
+         int bufferBytes = 8 << 20;
+         setsockopt(descriptor,
+           SOL_SOCKET,
+           SO_RCVBUF,
+           &bufferBytes,
+           sizeof(bufferBytes));
+
+         sockets.push_back(descriptor);
+         receivers.emplace_back([this, descriptor] { receive(descriptor); });
+      }
+
+  public:
+      /**
+       * @brief Construtor que inicia as threads trabalhadoras. Os sockets
+       * são abertos com listenUdp() e listenUnix().
+       *
+       * @param shardCount O número de fragmentos e de trabalhadoras. O
+       * padrão é o número de processadores.
+       * @param sketchK O parâmetro k do QuantileSketch de cada chave. O
+       * padrão é 200.
+       *
+       * @throws std::runtime_error se shardCount for zero.
+       */
+      MetricsDaemon(
+        std::size_t shardCount = std::thread::hardware_concurrency(),
+        std::size_t sketchK = 200)
+          : sketchK(sketchK) {
+         if (shardCount == 0) {
+            throw std::runtime_error("Shard count is zero");
+         }
+
+         // Valida k antes de iniciar as threads.
+         QuantileSketch<double> validated(sketchK);
+
+         wakeDescriptor = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+         if (wakeDescriptor < 0) {
+            throw std::runtime_error(systemError("Could not create eventfd"));
+         }
+
+         for (std::size_t i = 0; i < shardCount; ++i) {
+            shards.push_back(std::make_unique<Shard>());
+         }
+         for (auto& shard : shards) {
+            shard->worker = std::thread([this, &shard] { work(*shard); });
+         }
+      }
+
+      MetricsDaemon(MetricsDaemon const&) = delete;
+      MetricsDaemon& operator=(MetricsDaemon const&) = delete;
+
+      /**
+       * @brief Destrutor que aplica as amostras já recebidas, encerra as
+       * threads, fecha os sockets e remove o socket Unix.
+       */
+      ~MetricsDaemon() { stop(); }
+
+      /**
+       * @brief Escuta uma porta UDP em 127.0.0.1.
+       *
+       * @param port A porta, ou 0 para uma porta livre (veja udpPort()).
+       * @param receiverCount O número de sockets e receptoras na mesma porta,
+       * com SO_REUSEPORT. O padrão é 1.
+       *
+       * @return Uma referência para o próprio objeto.
+       *
+       * @throws std::runtime_error se o socket não puder ser aberto ou se
+       * o daemon já tiver parado.
+       */
+      MetricsDaemon& listenUdp(
+        std::uint16_t port, std::size_t receiverCount = 1) {
+         for (std::size_t i = 0; i < std::max<std::size_t>(receiverCount, 1);
+              ++i) {
+            int descriptor = socket(
+              AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (descriptor < 0) {
+               throw std::runtime_error(systemError("Could not create socket"));
+            }
+
+            int one = 1;
+            setsockopt(descriptor, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+
+            sockaddr_in address {};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(port);
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+            if (bind(descriptor,
+                  reinterpret_cast<sockaddr*>(&address),
+                  sizeof(address))
+              != 0) {
+               auto message = systemError(
+                 "Could not bind UDP port " + std::to_string(port));
+               close(descriptor);
+               throw std::runtime_error(message);
+            }
+
+            socklen_t length = sizeof(address);
+            getsockname(
+              descriptor, reinterpret_cast<sockaddr*>(&address), &length);
+            port = ntohs(address.sin_port);
+
+            startReceiver(descriptor);
+         }
+
+         return *this;
+      }
+
+      /**
+       * @brief Escuta um socket Unix de datagramas. Um socket antigo no
+       * mesmo caminho é substituído.
+       *
+       * @param path O caminho do socket, removido pelo destrutor.
+       *
+       * @return Uma referência para o próprio objeto.
+       *
+       * @throws std::runtime_error se já houver um socket Unix, se o caminho
+       * for longo demais, se o socket não puder ser aberto ou se o daemon já
+       * tiver parado.
+       */
+      MetricsDaemon& listenUnix(std::string const& path) {
+         sockaddr_un address {};
+         if (!unixPath.empty()) {
+            throw std::runtime_error("Unix socket is already open");
+         }
+         if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+            throw std::runtime_error("Invalid Unix socket path '" + path + "'");
+         }
+
+         struct stat status;
+         if (lstat(path.c_str(), &status) == 0 && S_ISSOCK(status.st_mode)) {
+            unlink(path.c_str());
+         }
+
+         int descriptor
+           = socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+         if (descriptor < 0) {
+            throw std::runtime_error(systemError("Could not create socket"));
+         }
+
+         address.sun_family = AF_UNIX;
+         std::memcpy(address.sun_path, path.c_str(), path.size());
+
+         if (bind(descriptor,
+               reinterpret_cast<sockaddr*>(&address),
+               sizeof(address))
+           != 0) {
+            auto message = systemError("Could not bind '" + path + "'");
+            close(descriptor);
+            throw std::runtime_error(message);
+         }
+
+         unixPath = path;
+         startReceiver(descriptor);
+
+         return *this;
+      }
+
+      /**
+       * @brief Para de receber, aplica as amostras já recebidas, encerra as
+       * threads e fecha os sockets. As séries continuam disponíveis para
+       * snapshot(). Chamadas repetidas não fazem nada.
+       */
+      void stop() {
+         stopping.store(true, std::memory_order_release);
+         if (wakeDescriptor >= 0) {
+            std::uint64_t one = 1;
+            [[maybe_unused]] auto written
+              = write(wakeDescriptor, &one, sizeof(one));
+         }
+
+         for (auto& receiver : receivers) {
+            receiver.join();
+         }
+         receivers.clear();
+
+         // Só depois que as receptoras entregaram os últimos lotes.
+         draining.store(true, std::memory_order_release);
+
+         for (auto& shard : shards) {
+            {
+               std::lock_guard lock(shard->pendingMutex);
+            }
+            shard->pendingChanged.notify_all();
+            if (shard->worker.joinable()) {
+               shard->worker.join();
+            }
+         }
+
+         for (int descriptor : sockets) {
+            close(descriptor);
+         }
+         sockets.clear();
+
+         if (!unixPath.empty()) {
+            unlink(unixPath.c_str());
+            unixPath.clear();
+         }
+         if (wakeDescriptor >= 0) {
+            close(wakeDescriptor);
+            wakeDescriptor = -1;
+         }
+      }
+
+      /**
+       * @brief Retorna a porta UDP escutada.
+       *
+       * @return A porta, ou 0 se nenhuma porta UDP estiver aberta.
+       */
+      std::uint16_t udpPort() const {
+         for (int descriptor : sockets) {
+            sockaddr_in address {};
+            socklen_t length = sizeof(address);
+            if (getsockname(descriptor,
+                  reinterpret_cast<sockaddr*>(&address),
+                  &length)
+                == 0
+              && address.sin_family == AF_INET) {
+               return ntohs(address.sin_port);
+            }
+         }
+
+         return 0;
+      }
+
+      /**
+       * @brief Retorna uma cópia das séries de todas as chaves, ordenadas
+       * pela chave. Amostras ainda em trânsito entre as threads podem ficar
+       * para a próxima cópia.
+       *
+       * @param reset Define se as séries são zeradas, como no statsd, para
+       * que cada cópia cubra só o intervalo desde a anterior.
+       *
+       * @return Os pares de chave e séries.
+       */
+      std::vector<std::pair<std::string, Series>> snapshot(bool reset = false) {
+         std::vector<std::pair<std::string, Series>> result;
+
+         for (auto& shard : shards) {
+            SeriesMap taken;
+            {
+               std::lock_guard lock(shard->seriesMutex);
+               if (reset) {
+                  taken.swap(shard->series);
+               } else {
+                  taken = shard->series;
+               }
+            }
+
+            for (auto& [key, series] : taken) {
+               result.emplace_back(key, std::move(series));
+            }
+         }
+
+         std::sort(result.begin(),
+           result.end(),
+           [](auto const& a, auto const& b) { return a.first < b.first; });
+
+         return result;
+      }
+
+      /**
+       * @brief Retorna o número de datagramas recebidos.
+       *
+       * @return O número de datagramas.
+       */
+      std::uint64_t datagrams() const {
+         return datagramCount.load(std::memory_order_relaxed);
+      }
+
+      /**
+       * @brief Retorna o número de amostras válidas recebidas.
+       *
+       * @return O número de amostras.
+       */
+      std::uint64_t samples() const {
+         return sampleCount.load(std::memory_order_relaxed);
+      }
+
+      /**
+       * @brief Retorna o número de linhas inválidas e de datagramas
+       * truncados descartados.
+       *
+       * @return O número de descartes.
+       */
+      std::uint64_t malformed() const {
+         return malformedCount.load(std::memory_order_relaxed);
+      }
+   };
+}
+
+#endif /// METRICS_DAEMON_HPP_
@@ -0,0 +1,543 @@
+/**
+ * @file Numa.hpp
+ * @author Pedro Lucas (pedrolucas.jsrn@gmail.com)
+ * @brief Arquivo de cabeçalho para as classes NumaTopology e NumaExecutor.
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef NUMA_HPP_
+#define NUMA_HPP_
+
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <latch>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace stats {
+   /**
+    * @brief Define como as páginas de um conjunto de valores são distribuídas
+    * entre os nós NUMA.
+    */
+   enum class NumaPlacement {
+      /** Páginas alternadas entre todos os nós. Bom quando o padrão de acesso
+          não é conhecido. */
+      Interleave,
+      /** Uma fatia contígua por nó, a mesma fatia que as threads daquele nó
+          percorrem no NumaExecutor. */
+      Partitioned
+   };
+
+   /**
+    * @class NumaTopology
+    * @brief Os nós NUMA da máquina e os processadores de cada um.
+    *
+    * No Linux a topologia é lida de /sys/devices/system/node. Em outros
+    * sistemas, ou se a leitura falhar, a máquina é tratada como um único nó,
+    * e todas as operações de posicionamento de memória viram no-ops.
+    */
+   class NumaTopology {
+  public:
+      /**
+       * @brief Um nó NUMA.
+       */
+      struct Node {
+         int id;
+         std::vector<std::size_t> cpus;
+      };
+
+  private:
+      std::vector<Node> nodes;
+
+      /**
+       * @brief Lê uma lista do kernel no formato "0-3,8,10-11".
+       *
+       * @param text O texto da lista.
+       *
+       * @return Os números da lista.
+       */
+      static std::vector<std::size_t> parseList(std::string const& text) {
+         std::vector<std::size_t> numbers;
+         std::size_t position = 0;
+
+         while (position < text.size()) {
+            std::size_t end = text.find(',', position);
+            std::string item = text.substr(position,
+              end == std::string::npos ? std::string::npos : end - position);
+            position = end == std::string::npos ? text.size() : end + 1;
+
+            if (item.empty() || item.find_first_of("0123456789") != 0) {
+               continue;
+            }
+
+            std::size_t dash = item.find('-');
+            std::size_t first = std::stoul(item.substr(0, dash));
+            std::size_t last = dash == std::string::npos
+              ? first
+              : std::stoul(item.substr(dash + 1));
+
+            for (std::size_t number = first; number <= last; ++number) {
+               numbers.push_back(number);
+            }
+         }
+
+         return numbers;
+      }
+
+      /**
+       * @brief Aplica uma política de memória às páginas inteiras de um
+       * intervalo, movendo as páginas já alocadas.
+       *
+       * @param address O início do intervalo.
+       * @param bytes O tamanho do intervalo em bytes.
+       * @param policy A política (MPOL_BIND ou MPOL_INTERLEAVE).
+       * @param nodeIds Os nós permitidos.
+       *
+       * @return True se a política foi aplicada e False caso contrário.
+       */
+      static bool bindPages(void const* address,
+        std::size_t bytes,
+        int policy,
+        std::vector<int> const& nodeIds) {
+#if defined(__linux__) && defined(SYS_mbind)
+         auto page = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+         auto start = reinterpret_cast<std::uintptr_t>(address);
+         std::uintptr_t first = (start + page - 1) / page * page;
+         std::uintptr_t last = (start + bytes) / page * page;
+
+         if (last <= first) {
+            return false;
+         }
+
+         constexpr std::size_t bitsPerWord = 8 * sizeof(unsigned long);
+         std::vector<unsigned long> mask(1);
+         for (int id : nodeIds) {
+            std::size_t word = static_cast<std::size_t>(id) / bitsPerWord;
+            if (word >= mask.size()) {
+               mask.resize(word + 1);
+            }
+            mask[word] |= 1UL << (static_cast<std::size_t>(id) % bitsPerWord);
+         }
+
+         return syscall(SYS_mbind,
+                  first,
+                  last - first,
+                  policy,
+                  mask.data(),
+                  mask.size() * bitsPerWord + 1,
+                  MPOL_MF_MOVE)
+           == 0;
+#else
+         (void)address;
+         (void)bytes;
+         (void)policy;
+         (void)nodeIds;
+         return false;
+#endif
+      }
+
+  public:
+      /**
+       * @brief Construtor padrão: um único nó com todos os processadores.
+       */
+      NumaTopology() : nodes(1, Node { 0, {} }) {
+         std::size_t cpuCount
+           = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+         for (std::size_t cpu = 0; cpu < cpuCount; ++cpu) {
+            nodes[0].cpus.push_back(cpu);
+         }
+      }
+
+      /**
+       * @brief Construtor com os nós informados explicitamente.
+       *
+       * @param nodes Os nós.
+       *
+       * @throws std::runtime_error se não houver nós ou se algum nó não tiver
+       * processadores.
+       */
+      NumaTopology(std::vector<Node> nodes) : nodes(std::move(nodes)) {
+         if (this->nodes.empty()) {
+            throw std::runtime_error("Topology has no nodes");
+         }
+
+         for (auto const& node : this->nodes) {
+            if (node.cpus.empty()) {
+               throw std::runtime_error("Topology node has no CPUs");
+            }
+         }
+      }
+
+      /**
+       * @brief Lê a topologia da máquina. Nós só de memória, sem
+       * processadores, são ignorados.
+       *
+       * @return A topologia lida, ou um único nó se a leitura falhar.
+       */
+      static NumaTopology detect() {
+#if defined(__linux__)
+         std::string const root = "/sys/devices/system/node/";
+         std::ifstream online(root + "online");
+         std::string text;
+
+         if (online && std::getline(online, text)) {
+            std::vector<Node> nodes;
+
+            for (auto id : parseList(text)) {
+               std::ifstream cpuList(
+                 root + "node" + std::to_string(id) + "/cpulist");
+               std::string cpus;
+               std::getline(cpuList, cpus);
+
+               if (auto parsed = parseList(cpus); !parsed.empty()) {
+                  nodes.push_back({ static_cast<int>(id), std::move(parsed) });
+               }
+            }
+
+            if (!nodes.empty()) {
+               return NumaTopology(std::move(nodes));
+            }
+         }
+#endif
+
+         return NumaTopology();
+      }
+
+      /**
+       * @brief Retorna a topologia da máquina, lida na primeira chamada.
+       *
+       * @return A topologia.
+       */
+      static NumaTopology const& system() {
+         static NumaTopology const topology = detect();
+         return topology;
+      }
+
+      /**
+       * @brief Retorna o número de nós.
+       *
+       * @return O número de nós.
+       */
+      std::size_t nodeCount() const { return nodes.size(); }
+
+      /**
+       * @brief Informa se há mais de um nó.
+       *
+       * @return True se a máquina tem mais de um nó e False caso contrário.
+       */
+      bool isNuma() const { return nodes.size() > 1; }
+
+      /**
+       * @brief Retorna um nó.
+       *
+       * @param index A posição do nó, de 0 a nodeCount() - 1.
+       *
+       * @return O nó.
+       */
+      Node const& node(std::size_t index) const { return nodes.at(index); }
+
+      /**
+       * @brief Retorna a fatia de um intervalo [0, length) que cabe a um nó.
+       *
+       * As fronteiras entre fatias são múltiplos de `alignment`, de modo que
+       * blocos de `alignment` elementos nunca são divididos entre nós.
+       *
+       * @param index A posição do nó.
+       * @param length O tamanho do intervalo.
+       * @param alignment O alinhamento das fronteiras. O padrão é 1.
+       *
+       * @return O início e o fim (exclusivo) da fatia.
+       */
+      std::pair<std::size_t, std::size_t> slice(
+        std::size_t index, std::size_t length, std::size_t alignment = 1) const {
+         auto boundary = [&](std::size_t k) {
+            if (k >= nodes.size()) {
+               return length;
+            }
+
+            std::size_t position = length / nodes.size() * k
+              + length % nodes.size() * k / nodes.size();
+            return position - position % std::max<std::size_t>(alignment, 1);
+         };
+
+         return { boundary(index), boundary(index + 1) };
+      }
+
+      /**
+       * @brief Distribui as páginas de um conjunto de valores entre os nós.
+       *
+       * As páginas já tocadas são movidas; as demais são alocadas no nó certo
+       * no primeiro acesso. Só as páginas inteiras dentro do intervalo são
+       * afetadas. Com um único nó nada é feito.
+       *
+       * @tparam TYPE Tipo dos valores.
+       *
+       * @param values Os valores.
+       * @param placement A forma de distribuição.
+       * @param alignment O alinhamento das fatias de Partitioned, o mesmo
+       * usado pelo NumaExecutor. O padrão é 1.
+       *
+       * @return True se alguma página foi posicionada e False caso contrário.
+       */
+      template <typename TYPE>
+      bool place(std::span<TYPE const> values,
+        NumaPlacement placement,
+        std::size_t alignment = 1) const {
+         if (!isNuma() || values.empty()) {
+            return false;
+         }
+
+#if defined(__linux__)
+         if (placement == NumaPlacement::Interleave) {
+            std::vector<int> ids;
+            for (auto const& node : nodes) {
+               ids.push_back(node.id);
+            }
+
+            return bindPages(
+              values.data(), values.size_bytes(), MPOL_INTERLEAVE, ids);
+         }
+
+         bool placed = false;
+         for (std::size_t index = 0; index < nodes.size(); ++index) {
+            auto [first, last] = slice(index, values.size(), alignment);
+            auto part = values.subspan(first, last - first);
+            placed |= bindPages(
+              part.data(), part.size_bytes(), MPOL_BIND, { nodes[index].id });
+         }
+
+         return placed;
+#else
+         (void)placement;
+         (void)alignment;
+         return false;
+#endif
+      }
+   };
+
+   /**
+    * @class NumaExecutor
+    * @brief Executa trabalho paralelo com afinidade de nó NUMA.
+    *
+    * Há um ThreadPool por nó, com as threads fixadas nos processadores
+    * daquele nó. Um intervalo é dividido em uma fatia por nó (as mesmas
+    * fatias de NumaTopology::place com Partitioned), cada fatia é processada
+    * só pelas threads do seu nó, e os resultados são juntados primeiro dentro
+    * de cada nó e depois entre os nós. Com um único nó, o executor usa o pool
+    * padrão e se comporta como parallelFor e parallelReduce.
+    */
+   class NumaExecutor {
+  private:
+      NumaTopology topology;
+      std::vector<std::shared_ptr<ThreadPool>> pools;
+
+      /**
+       * @brief Retorna a referência do executor padrão.
+       *
+       * @return O ponteiro compartilhado do executor padrão.
+       */
+      static std::shared_ptr<NumaExecutor>& defaultExecutor() {
+         static std::shared_ptr<NumaExecutor> executor;
+         return executor;
+      }
+
+      /**
+       * @brief Retorna o mutex que protege o executor padrão.
+       *
+       * @return O mutex.
+       */
+      static std::mutex& defaultMutex() {
+         static std::mutex mutex;
+         return mutex;
+      }
+
+  public:
+      /**
+       * @brief Construtor que cria um pool por nó.
+       *
+       * @param topology A topologia. O padrão é a topologia da máquina.
+       */
+      NumaExecutor(NumaTopology topology = NumaTopology::system())
+          : topology(std::move(topology)) {
+         if (!this->topology.isNuma()) {
+            pools.push_back(ThreadPool::getDefault());
+            return;
+         }
+
+         for (std::size_t index = 0; index < this->topology.nodeCount();
+              ++index) {
+            pools.push_back(
+              std::make_shared<ThreadPool>(this->topology.node(index).cpus));
+         }
+      }
+
+      NumaExecutor(NumaExecutor const&) = delete;
+      NumaExecutor& operator=(NumaExecutor const&) = delete;
+
+      /**
+       * @brief Retorna o executor padrão, criando-o na primeira chamada com a
+       * topologia da máquina.
+       *
+       * @return O executor padrão.
+       */
+      static std::shared_ptr<NumaExecutor> getDefault() {
+         std::lock_guard lock(defaultMutex());
+         auto& executor = defaultExecutor();
+         if (!executor) {
+            executor = std::make_shared<NumaExecutor>();
+         }
+
+         return executor;
+      }
+
+      /**
+       * @brief Retorna a topologia usada.
+       *
+       * @return A topologia.
+       */
+      NumaTopology const& getTopology() const { return topology; }
+
+      /**
+       * @brief Retorna o número de nós.
+       *
+       * @return O número de nós.
+       */
+      std::size_t nodeCount() const { return topology.nodeCount(); }
+
+      /**
+       * @brief Retorna o pool de um nó.
+       *
+       * @param index A posição do nó.
+       *
+       * @return O pool.
+       */
+      ThreadPool& pool(std::size_t index) const { return *pools.at(index); }
+
+      /**
+       * @brief Executa uma função sobre a fatia de cada nó, com os nós em
+       * paralelo.
+       *
+       * A função de cada nó roda em uma thread daquele nó e pode usar
+       * parallelFor no pool recebido para dividir a fatia entre as threads do
+       * nó.
+       *
+       * @tparam FUNCTION Tipo da função, chamada como
+       * body(node, pool, first, last).
+       *
+       * @param length O tamanho do intervalo [0, length).
+       * @param alignment O alinhamento das fronteiras entre fatias.
+       * @param body A função.
+       */
+      template <typename FUNCTION>
+      void forEachNode(
+        std::size_t length, std::size_t alignment, FUNCTION&& body) const {
+         if (pools.size() == 1) {
+            body(std::size_t { 0 }, *pools[0], std::size_t { 0 }, length);
+            return;
+         }
+
+         // A espera não ajuda os pools, como TaskGroup::wait faria: a thread
+         // que chama não está fixada em nenhum nó, então o trabalho de um nó
+         // só pode rodar nas threads dele.
+         std::latch done(static_cast<std::ptrdiff_t>(pools.size()));
+         std::vector<std::exception_ptr> errors(pools.size());
+
+         for (std::size_t index = 0; index < pools.size(); ++index) {
+            auto [first, last] = topology.slice(index, length, alignment);
+            ThreadPool& nodePool = *pools[index];
+
+            auto task = [&, index, first, last] {
+               try {
+                  body(index, *pools[index], first, last);
+               } catch (...) {
+                  errors[index] = std::current_exception();
+               }
+               done.count_down();
+            };
+
+            // Uma trabalhadora do próprio nó roda a fatia dele diretamente,
+            // sem esperar por uma tarefa na sua própria fila.
+            if (nodePool.isWorkerThread()) {
+               task();
+            } else {
+               nodePool.submit(task);
+            }
+         }
+
+         done.wait();
+         for (auto& error : errors) {
+            if (error) {
+               std::rethrow_exception(error);
+            }
+         }
+      }
+
+      /**
+       * @brief Reduz o intervalo [0, length) de forma hierárquica: cada nó
+       * reduz a sua fatia com parallelReduce no próprio pool e os resultados
+       * dos nós são combinados na ordem dos nós.
+       *
+       * @tparam VALUE Tipo do resultado.
+       * @tparam MAP Tipo da função que reduz uma parte, chamada como
+       * map(first, last).
+       * @tparam COMBINE Tipo da função que junta dois resultados.
+       *
+       * @param length O tamanho do intervalo.
+       * @param grain O tamanho mínimo de cada parte.
+       * @param alignment O alinhamento das fronteiras entre fatias.
+       * @param identity O resultado de um intervalo vazio.
+       * @param map A função que reduz uma parte.
+       * @param combine A função que junta dois resultados.
+       *
+       * @return O resultado da redução.
+       */
+      template <typename VALUE, typename MAP, typename COMBINE>
+      VALUE reduce(std::size_t length,
+        std::size_t grain,
+        std::size_t alignment,
+        VALUE identity,
+        MAP&& map,
+        COMBINE&& combine) const {
+         std::vector<VALUE> partials(pools.size(), identity);
+
+         forEachNode(length,
+           alignment,
+           [&](std::size_t node,
+             ThreadPool& nodePool,
+             std::size_t first,
+             std::size_t last) {
+              partials[node] = parallelReduce(
+                nodePool, first, last, grain, identity, map, combine);
+           });
+
+         VALUE result = identity;
+         for (auto const& partial : partials) {
+            result = combine(result, partial);
+         }
+
+         return result;
+      }
+   };
+}
+
+#endif /// NUMA_HPP_
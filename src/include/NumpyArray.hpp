@@ -0,0 +1,537 @@
+/**
+ * @file NumpyArray.hpp
+ * @author Pedro Lucas (pedrolucas.jsrn@gmail.com)
+ * @brief Arquivo de cabeçalho para as classes NumpyArray e NpzArchive.
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef NUMPY_ARRAY_HPP_
+#define NUMPY_ARRAY_HPP_
+
+#include "MappedColumn.hpp"
+#include "Serialization.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace stats {
+   /**
+    * @class NpzArchive
+    * @brief Um arquivo .npz (um zip de arquivos .npy) mapeado em memória.
+    *
+    * Só o diretório central do zip é lido na abertura, incluindo as
+    * extensões zip64 usadas pelo NumPy em arquivos grandes. Os membros
+    * gravados sem compressão (np.savez) são acessados diretamente no
+    * mapeamento; membros comprimidos (np.savez_compressed) não são
+    * suportados.
+    */
+   class NpzArchive {
+  private:
+      /**
+       * @brief Um membro do zip.
+       */
+      struct Member {
+         std::string name;
+         std::uint16_t method = 0;
+         std::uint64_t compressedSize = 0;
+         std::uint64_t size = 0;
+         std::uint64_t localOffset = 0;
+      };
+
+      static constexpr std::uint32_t endSignature = 0x06054b50;
+      static constexpr std::uint32_t end64Signature = 0x06064b50;
+      static constexpr std::uint32_t locatorSignature = 0x07064b50;
+      static constexpr std::uint32_t centralSignature = 0x02014b50;
+      static constexpr std::uint32_t localSignature = 0x04034b50;
+      static constexpr std::uint32_t saturated = 0xffffffff;
+
+      std::shared_ptr<MappedColumn<std::uint8_t> const> file;
+      std::vector<Member> entries;
+
+      /**
+       * @brief Cria um leitor a partir de uma posição do arquivo.
+       *
+       * @param offset A posição.
+       *
+       * @return O leitor.
+       *
+       * @throws std::runtime_error se a posição estiver fora do arquivo.
+       */
+      ByteReader readerAt(std::uint64_t offset) const {
+         auto bytes = file->values();
+         if (offset > bytes.size()) {
+            throw std::runtime_error("Npz archive is truncated");
+         }
+
+         return ByteReader(bytes.subspan(offset));
+      }
+
+      /**
+       * @brief Encontra o registro de fim do diretório central.
+       *
+       * @return A posição do registro.
+       *
+       * @throws std::runtime_error se o arquivo não for um zip.
+       */
+      std::size_t findEnd() const {
+         auto bytes = file->values();
+         if (bytes.size() < 22) {
+            throw std::runtime_error("File is not an npz archive");
+         }
+
+         std::size_t last = bytes.size() - 22;
+         std::size_t first = last > 0xffff ? last - 0xffff : 0;
+
+         for (std::size_t position = last + 1; position-- > first;) {
+            std::uint32_t signature;
+            std::memcpy(&signature, bytes.data() + position, sizeof(signature));
+            if (signature == endSignature) {
+               return position;
+            }
+         }
+
+         throw std::runtime_error("File is not an npz archive");
+      }
+
+      /**
+       * @brief Lê o diretório central.
+       *
+       * @throws std::runtime_error se o zip estiver corrompido.
+       */
+      void readDirectory() {
+         std::size_t end = findEnd();
+         ByteReader endRecord = readerAt(end + 10);
+         std::uint64_t entryCount = endRecord.read<std::uint16_t>();
+         endRecord.read<std::uint32_t>();
+         std::uint64_t directoryOffset = endRecord.read<std::uint32_t>();
+
+         if (end >= 20 && readerAt(end - 20).read<std::uint32_t>()
+             == locatorSignature) {
+            ByteReader locator = readerAt(end - 12);
+            std::uint64_t end64 = locator.read<std::uint64_t>();
+
+            ByteReader end64Record = readerAt(end64);
+            if (end64Record.read<std::uint32_t>() != end64Signature) {
+               throw std::runtime_error("Npz archive is corrupt");
+            }
+
+            end64Record = readerAt(end64 + 32);
+            entryCount = end64Record.read<std::uint64_t>();
+            end64Record.read<std::uint64_t>();
+            directoryOffset = end64Record.read<std::uint64_t>();
+         }
+
+         ByteReader directory = readerAt(directoryOffset);
+         for (std::uint64_t entry = 0; entry < entryCount; ++entry) {
+            if (directory.read<std::uint32_t>() != centralSignature) {
+               throw std::runtime_error("Npz archive is corrupt");
+            }
+
+            Member member;
+            directory.read<std::uint32_t>();
+            directory.read<std::uint16_t>();
+            member.method = directory.read<std::uint16_t>();
+            directory.read<std::uint64_t>();
+            member.compressedSize = directory.read<std::uint32_t>();
+            member.size = directory.read<std::uint32_t>();
+            auto nameLength = directory.read<std::uint16_t>();
+            auto extraLength = directory.read<std::uint16_t>();
+            auto commentLength = directory.read<std::uint16_t>();
+            directory.read<std::uint64_t>();
+            member.localOffset = directory.read<std::uint32_t>();
+
+            member.name.resize(nameLength);
+            directory.readBytes(member.name.data(), nameLength);
+            std::vector<std::uint8_t> extra(extraLength);
+            directory.readBytes(extra.data(), extraLength);
+            std::vector<std::uint8_t> comment(commentLength);
+            directory.readBytes(comment.data(), commentLength);
+
+            ByteReader fields(extra);
+            while (fields.remaining() >= 4) {
+               auto id = fields.read<std::uint16_t>();
+               auto length = fields.read<std::uint16_t>();
+               std::vector<std::uint8_t> field(length);
+               fields.readBytes(field.data(), length);
+               if (id != 0x0001) {
+                  continue;
+               }
+
+               ByteReader zip64(field);
+               if (member.size == saturated) {
+                  member.size = zip64.read<std::uint64_t>();
+               }
+               if (member.compressedSize == saturated) {
+                  member.compressedSize = zip64.read<std::uint64_t>();
+               }
+               if (member.localOffset == saturated) {
+                  member.localOffset = zip64.read<std::uint64_t>();
+               }
+            }
+
+            entries.push_back(std::move(member));
+         }
+      }
+
+  public:
+      /**
+       * @brief Abre um arquivo .npz.
+       *
+       * @param path O caminho do arquivo.
+       *
+       * @throws std::runtime_error se o arquivo não puder ser mapeado ou não
+       * for um zip válido.
+       */
+      explicit NpzArchive(std::string const& path)
+          : file(std::make_shared<MappedColumn<std::uint8_t> const>(path)) {
+         readDirectory();
+      }
+
+      /**
+       * @brief Retorna os nomes dos arrays do arquivo, sem a extensão .npy.
+       *
+       * @return Os nomes, na ordem do arquivo.
+       */
+      std::vector<std::string> names() const {
+         std::vector<std::string> result;
+         for (auto const& entry : entries) {
+            std::string_view name = entry.name;
+            if (name.ends_with(".npy")) {
+               name.remove_suffix(4);
+            }
+            result.emplace_back(name);
+         }
+
+         return result;
+      }
+
+      /**
+       * @brief Retorna os bytes de um membro, que formam um arquivo .npy.
+       *
+       * @param name O nome do array, com ou sem a extensão .npy.
+       *
+       * @return Os bytes, válidos enquanto o mapeamento existir.
+       *
+       * @throws std::runtime_error se o membro não existir, for comprimido ou
+       * estiver fora do arquivo.
+       */
+      std::span<std::uint8_t const> member(std::string const& name) const {
+         auto found = std::find_if(
+           entries.begin(), entries.end(), [&](Member const& entry) {
+              return entry.name == name || entry.name == name + ".npy";
+           });
+
+         if (found == entries.end()) {
+            throw std::runtime_error("Npz archive has no array '" + name + "'");
+         }
+         if (found->method != 0) {
+            throw std::runtime_error(
+              "Compressed npz members are not supported");
+         }
+
+         ByteReader local = readerAt(found->localOffset);
+         if (local.read<std::uint32_t>() != localSignature) {
+            throw std::runtime_error("Npz archive is corrupt");
+         }
+
+         local = readerAt(found->localOffset + 26);
+         auto nameLength = local.read<std::uint16_t>();
+         auto extraLength = local.read<std::uint16_t>();
+         std::uint64_t offset
+           = found->localOffset + 30 + nameLength + extraLength;
+
+         auto bytes = file->values();
+         if (offset > bytes.size() || found->size > bytes.size() - offset) {
+            throw std::runtime_error("Npz archive is truncated");
+         }
+
+         return bytes.subspan(offset, found->size);
+      }
+
+      /**
+       * @brief Retorna o mapeamento do arquivo, para que os arrays lidos
+       * continuem válidos depois do objeto.
+       *
+       * @return O mapeamento compartilhado.
+       */
+      std::shared_ptr<MappedColumn<std::uint8_t> const> mapping() const {
+         return file;
+      }
+   };
+
+   /**
+    * @class NumpyArray
+    * @brief Um array do NumPy lido de um arquivo .npy ou de um membro de um
+    * .npz, sem cópia.
+    *
+    * O cabeçalho é lido e validado contra TYPE: o tipo (descr) deve ter o
+    * mesmo tamanho e a mesma natureza (inteiro com ou sem sinal, ou ponto
+    * flutuante), em ordem little-endian ou nativa, e arrays com mais de uma
+    * dimensão devem estar em ordem C. Os valores são então usados direto do
+    * mapeamento, em ordem C, por StatisticsView, StreamingStatistics e
+    * qualquer função que receba um std::span.
+    *
+    * O NumPy alinha os dados de um .npy em 64 bytes, mas um membro de .npz
+    * pode começar em qualquer posição; nesse caso os valores são copiados
+    * uma vez para um buffer alinhado e isZeroCopy() retorna False.
+    *
+    * @tparam TYPE Define o tipo de dados. Deve ser um tipo numérico.
+    */
+   template <typename TYPE>
+   class NumpyArray {
+      static_assert(std::is_arithmetic_v<TYPE>, "TYPE must be a numeric type");
+      static_assert(std::endian::native == std::endian::little,
+        "NumpyArray requires a little-endian machine");
+
+  private:
+      std::shared_ptr<MappedColumn<std::uint8_t> const> file;
+      std::vector<std::size_t> dimensions;
+      std::vector<TYPE> copy;
+      std::span<TYPE const> data;
+
+      /**
+       * @brief Encontra o valor de uma chave no dicionário do cabeçalho.
+       *
+       * @param header O dicionário.
+       * @param key A chave, sem aspas.
+       *
+       * @return O texto a partir do valor.
+       *
+       * @throws std::runtime_error se a chave não existir.
+       */
+      static std::string_view valueOf(
+        std::string_view header, std::string_view key) {
+         for (char quote : { '\'', '"' }) {
+            std::string quoted = quote + std::string(key) + quote;
+            std::size_t position = header.find(quoted);
+            if (position == std::string_view::npos) {
+               continue;
+            }
+
+            position = header.find(':', position + quoted.size());
+            if (position != std::string_view::npos) {
+               position = header.find_first_not_of(" ", position + 1);
+               return header.substr(std::min(position, header.size()));
+            }
+         }
+
+         throw std::runtime_error(
+           "Npy header has no '" + std::string(key) + "' key");
+      }
+
+      /**
+       * @brief Valida o tipo do array contra TYPE.
+       *
+       * @param descr O tipo do NumPy, por exemplo "<f8".
+       *
+       * @throws std::runtime_error se o tipo não corresponder a TYPE.
+       */
+      static void checkType(std::string_view descr) {
+         if (descr.size() < 3) {
+            throw std::runtime_error("Npy dtype is invalid");
+         }
+
+         char order = descr[0];
+         char kind = descr[1];
+         std::size_t size = 0;
+         for (char digit : descr.substr(2)) {
+            if (digit < '0' || digit > '9') {
+               throw std::runtime_error("Npy dtype is invalid");
+            }
+            size = size * 10 + (digit - '0');
+         }
+
+         char expectedKind = std::is_floating_point_v<TYPE> ? 'f'
+           : std::is_signed_v<TYPE>                         ? 'i'
+                                                            : 'u';
+
+         if (kind != expectedKind || size != sizeof(TYPE)) {
+            throw std::runtime_error("Npy dtype '" + std::string(descr)
+              + "' does not match the requested type");
+         }
+         if (order == '>' && size > 1) {
+            throw std::runtime_error("Big-endian npy arrays are not supported");
+         }
+         if (order != '<' && order != '=' && order != '|' && order != '>') {
+            throw std::runtime_error("Npy dtype is invalid");
+         }
+      }
+
+      /**
+       * @brief Lê o cabeçalho e encontra os valores.
+       *
+       * @param bytes Os bytes do arquivo .npy.
+       *
+       * @throws std::runtime_error se o cabeçalho for inválido ou não
+       * corresponder a TYPE.
+       */
+      void parse(std::span<std::uint8_t const> bytes) {
+         static constexpr std::string_view magic = "\x93NUMPY";
+         if (bytes.size() < magic.size() + 4
+           || std::memcmp(bytes.data(), magic.data(), magic.size()) != 0) {
+            throw std::runtime_error("File is not an npy array");
+         }
+
+         ByteReader reader(bytes.subspan(magic.size()));
+         auto major = reader.read<std::uint8_t>();
+         reader.read<std::uint8_t>();
+
+         std::size_t headerLength = 0;
+         if (major == 1) {
+            headerLength = reader.read<std::uint16_t>();
+         } else if (major == 2 || major == 3) {
+            headerLength = reader.read<std::uint32_t>();
+         } else {
+            throw std::runtime_error("Npy format version is unsupported");
+         }
+
+         std::size_t dataOffset = bytes.size() - reader.remaining();
+         if (headerLength > reader.remaining()) {
+            throw std::runtime_error("Npy header is truncated");
+         }
+
+         std::string_view header(
+           reinterpret_cast<char const*>(bytes.data()) + dataOffset,
+           headerLength);
+         dataOffset += headerLength;
+
+         std::string_view descr = valueOf(header, "descr");
+         if (descr.empty() || (descr[0] != '\'' && descr[0] != '"')) {
+            throw std::runtime_error(
+              "Structured npy dtypes are not supported");
+         }
+         descr = descr.substr(1, descr.find(descr[0], 1) - 1);
+         checkType(descr);
+
+         bool fortranOrder
+           = valueOf(header, "fortran_order").starts_with("True");
+
+         std::string_view shape = valueOf(header, "shape");
+         if (!shape.starts_with("(")) {
+            throw std::runtime_error("Npy shape is invalid");
+         }
+         shape = shape.substr(1, shape.find(')') - 1);
+
+         std::size_t count = 1;
+         for (std::size_t position = 0; position < shape.size();) {
+            position = shape.find_first_not_of(" ,", position);
+            if (position == std::string_view::npos) {
+               break;
+            }
+
+            std::size_t dimension = 0;
+            for (; position < shape.size() && shape[position] >= '0'
+                 && shape[position] <= '9';
+                 ++position) {
+               dimension = dimension * 10 + (shape[position] - '0');
+            }
+            if (position < shape.size() && shape[position] != ','
+              && shape[position] != ' ') {
+               throw std::runtime_error("Npy shape is invalid");
+            }
+
+            if (dimension != 0
+              && count > std::numeric_limits<std::size_t>::max() / dimension) {
+               throw std::runtime_error("Npy shape is too large");
+            }
+            count *= dimension;
+            dimensions.push_back(dimension);
+         }
+
+         if (fortranOrder && dimensions.size() > 1) {
+            throw std::runtime_error(
+              "Fortran-ordered npy arrays are not supported");
+         }
+         if (count > (bytes.size() - dataOffset) / sizeof(TYPE)) {
+            throw std::runtime_error("Npy array is truncated");
+         }
+
+         auto first = bytes.data() + dataOffset;
+         if (reinterpret_cast<std::uintptr_t>(first) % alignof(TYPE) != 0) {
+            copy.resize(count);
+            std::memcpy(copy.data(), first, count * sizeof(TYPE));
+            data = copy;
+         } else {
+            data = std::span<TYPE const>(
+              reinterpret_cast<TYPE const*>(first), count);
+         }
+      }
+
+  public:
+      /**
+       * @brief Mapeia um arquivo .npy.
+       *
+       * @param path O caminho do arquivo.
+       *
+       * @throws std::runtime_error se o arquivo não puder ser mapeado, não
+       * for um .npy válido ou não corresponder a TYPE.
+       */
+      explicit NumpyArray(std::string const& path)
+          : file(std::make_shared<MappedColumn<std::uint8_t> const>(path)) {
+         parse(file->values());
+      }
+
+      /**
+       * @brief Lê um array de um arquivo .npz.
+       *
+       * @param archive O arquivo .npz.
+       * @param name O nome do array, com ou sem a extensão .npy.
+       *
+       * @throws std::runtime_error se o membro não existir, for comprimido,
+       * não for um .npy válido ou não corresponder a TYPE.
+       */
+      NumpyArray(NpzArchive const& archive, std::string const& name)
+          : file(archive.mapping()) {
+         parse(archive.member(name));
+      }
+
+      NumpyArray(NumpyArray const&) = delete;
+      NumpyArray& operator=(NumpyArray const&) = delete;
+      NumpyArray(NumpyArray&&) = default;
+      NumpyArray& operator=(NumpyArray&&) = default;
+
+      /**
+       * @brief Retorna as dimensões do array.
+       *
+       * @return As dimensões, vazias para um escalar.
+       */
+      std::span<std::size_t const> shape() const { return dimensions; }
+
+      /**
+       * @brief Retorna os valores, em ordem C.
+       *
+       * @return Os valores, válidos enquanto o objeto existir.
+       */
+      std::span<TYPE const> values() const { return data; }
+
+      /**
+       * @brief Retorna o número de valores.
+       *
+       * @return O número de valores.
+       */
+      std::size_t size() const { return data.size(); }
+
+      /**
+       * @brief Informa se os valores são lidos direto do mapeamento.
+       *
+       * @return True se não houve cópia e False caso contrário.
+       */
+      bool isZeroCopy() const { return copy.empty(); }
+   };
+}
+
+#endif /// NUMPY_ARRAY_HPP_
@@ -0,0 +1,147 @@
+/**
+ * @file ParallelSort.hpp
+ * @author Pedro Lucas (pedrolucas.jsrn@gmail.com)
+ * @brief Arquivo de cabeçalho para a ordenação paralela por amostragem.
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef PARALLEL_SORT_HPP_
+#define PARALLEL_SORT_HPP_
+
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <random>
+#include <span>
+#include <vector>
+
+namespace stats {
+   /**
+    * @brief Abaixo deste tamanho parallelSort usa std::sort diretamente.
+    */
+   inline constexpr std::size_t parallelSortThreshold = 1 << 16;
+
+   /**
+    * @brief Ordena os valores em paralelo com ordenação por amostragem
+    * (sample sort).
+    *
+    * Uma amostra dos valores escolhe os separadores de P baldes. Os valores
+    * são divididos em P blocos; cada bloco conta e depois espalha os seus
+    * elementos nos baldes, em paralelo e sem travas, já que as posições de
+    * cada (bloco, balde) vêm de uma soma de prefixos das contagens. Por fim
+    * cada balde é ordenado com std::sort de forma independente. Valores
+    * iguais a um separador vão para um balde próprio, que não precisa ser
+    * ordenado, então muitos valores repetidos não desequilibram os baldes.
+    *
+    * Usa memória auxiliar do tamanho dos valores. A ordenação não é estável.
+    *
+    * @tparam TYPE Tipo dos valores.
+    * @tparam COMPARE Tipo da comparação.
+    *
+    * @param values Os valores a serem ordenados.
+    * @param pool O pool que executa as partes.
+    * @param compare A comparação. O padrão é std::less.
+    */
+   template <typename TYPE, typename COMPARE = std::less<>>
+   void parallelSort(
+     std::span<TYPE> values, ThreadPool& pool, COMPARE compare = COMPARE {}) {
+      constexpr std::size_t oversampling = 64;
+
+      std::size_t blocks = std::min(
+        pool.concurrency() * 4, values.size() / (parallelSortThreshold / 4));
+
+      if (values.size() < parallelSortThreshold || pool.size() == 0
+        || blocks < 2) {
+         std::sort(values.begin(), values.end(), compare);
+         return;
+      }
+
+      // Os separadores vêm de uma amostra ordenada, com semente fixa para
+      // que o particionamento seja sempre o mesmo.
+      std::mt19937_64 generator(values.size());
+      std::uniform_int_distribution<std::size_t> position(
+        0, values.size() - 1);
+      std::vector<TYPE> sample(blocks * oversampling);
+      for (auto& item : sample) {
+         item = values[position(generator)];
+      }
+      std::sort(sample.begin(), sample.end(), compare);
+
+      std::vector<TYPE> splitters;
+      for (std::size_t i = 1; i < blocks; ++i) {
+         auto const& candidate = sample[i * oversampling];
+         if (splitters.empty() || compare(splitters.back(), candidate)) {
+            splitters.push_back(candidate);
+         }
+      }
+
+      // O balde 2j guarda os valores entre os separadores j - 1 e j; o balde
+      // 2j + 1 guarda os valores iguais ao separador j.
+      std::size_t buckets = 2 * splitters.size() + 1;
+      auto bucketOf = [&](TYPE const& value) {
+         std::size_t j
+           = std::lower_bound(splitters.begin(), splitters.end(), value, compare)
+           - splitters.begin();
+         return j < splitters.size() && !compare(value, splitters[j])
+           ? 2 * j + 1
+           : 2 * j;
+      };
+      auto blockBegin = [&](std::size_t block) {
+         return values.size() * block / blocks;
+      };
+
+      std::vector<std::size_t> offsets(blocks * buckets, 0);
+      parallelFor(pool, 0, blocks, 1, [&](std::size_t first, std::size_t last) {
+         for (std::size_t block = first; block < last; ++block) {
+            std::size_t* counts = &offsets[block * buckets];
+            for (std::size_t i = blockBegin(block); i < blockBegin(block + 1);
+                 ++i) {
+               ++counts[bucketOf(values[i])];
+            }
+         }
+      });
+
+      std::vector<std::size_t> bucketBegin(buckets + 1, 0);
+      std::size_t total = 0;
+      for (std::size_t bucket = 0; bucket < buckets; ++bucket) {
+         bucketBegin[bucket] = total;
+         for (std::size_t block = 0; block < blocks; ++block) {
+            std::size_t count = offsets[block * buckets + bucket];
+            offsets[block * buckets + bucket] = total;
+            total += count;
+         }
+      }
+      bucketBegin[buckets] = total;
+
+      std::vector<TYPE> buffer(values.size());
+      parallelFor(pool, 0, blocks, 1, [&](std::size_t first, std::size_t last) {
+         for (std::size_t block = first; block < last; ++block) {
+            std::size_t* next = &offsets[block * buckets];
+            for (std::size_t i = blockBegin(block); i < blockBegin(block + 1);
+                 ++i) {
+               buffer[next[bucketOf(values[i])]++] = std::move(values[i]);
+            }
+         }
+      });
+
+      parallelFor(pool, 0, buckets, 1, [&](std::size_t first, std::size_t last) {
+         for (std::size_t bucket = first; bucket < last; ++bucket) {
+            auto begin = buffer.begin() + bucketBegin[bucket];
+            auto end = buffer.begin() + bucketBegin[bucket + 1];
+
+            if (bucket % 2 == 0) {
+               std::sort(begin, end, compare);
+            }
+
+            std::move(begin, end, values.begin() + bucketBegin[bucket]);
+         }
+      });
+   }
+}
+
+#endif /// PARALLEL_SORT_HPP_
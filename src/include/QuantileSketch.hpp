@@ -0,0 +1,513 @@
+/**
+ * @file QuantileSketch.hpp
+ * @author Pedro Lucas (pedrolucas.jsrn@gmail.com)
+ * @brief Arquivo de cabeçalho para a classe QuantileSketch.
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef QUANTILE_SKETCH_HPP_
+#define QUANTILE_SKETCH_HPP_
+
+#include "Serialization.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace stats {
+   /**
+    * @class QuantileSketch
+    * @brief Um esboço de quantis (KLL) com memória limitada para fluxos que
+    * não cabem na memória.
+    *
+    * O esboço mantém uma pilha de compactadores: o nível h guarda itens com
+    * peso 2^h e, ao encher, é ordenado e metade dos seus itens (pares ou
+    * ímpares, ao acaso) sobe para o nível seguinte. As capacidades decrescem
+    * geometricamente (fator 2/3) dos níveis altos para os baixos, então a
+    * memória é O(k) independente do tamanho do fluxo.
+    *
+    * Garantia de erro: para qualquer valor x, |rank(x) - posto real| fica
+    * abaixo de aproximadamente (3,3 / k) * n com 99% de confiança, ou seja,
+    * cerca de 1,65% de n para o k padrão de 200. Os valores mínimo e máximo são
+    * exatos.
+    *
+    * @see https://arxiv.org/abs/1603.05346
+    *
+    * @tparam TYPE Define o tipo de dados. Deve ser um tipo numérico.
+    */
+   template <typename TYPE>
+   class QuantileSketch {
+      static_assert(std::is_arithmetic_v<TYPE>, "TYPE must be a numeric type");
+
+  private:
+      static constexpr std::uint32_t tag = serializationTag("QKLL");
+      static constexpr std::uint16_t version = 2;
+      static constexpr double capacityDecay = 2.0 / 3.0;
+      static constexpr std::size_t minimumCapacity = 2;
+
+      std::size_t k;
+      std::uint64_t count = 0;
+      TYPE minValue = std::numeric_limits<TYPE>::max();
+      TYPE maxValue = std::numeric_limits<TYPE>::lowest();
+      std::vector<std::vector<TYPE>> levels;
+      std::vector<std::size_t> capacities;
+      std::size_t retained = 0;
+      std::size_t maximumRetained = 0;
+      std::uint64_t randomState;
+
+      /**
+       * @brief Checa se o parâmetro k é válido.
+       *
+       * @throws std::runtime_error se k for menor que 8.
+       */
+      void checkK() const {
+         if (k < 8) {
+            throw std::runtime_error("Sketch parameter k is less than 8");
+         }
+      }
+
+      /**
+       * @brief Checa se o esboço não está vazio.
+       *
+       * @throws std::runtime_error se o esboço estiver vazio.
+       */
+      void ensureNotEmpty() const {
+         if (count == 0) {
+            throw std::runtime_error("Values are empty");
+         }
+      }
+
+      /**
+       * @brief Sorteia um bit pseudoaleatório (splitmix64).
+       *
+       * @return 0 ou 1.
+       */
+      std::size_t randomBit() {
+         std::uint64_t z = (randomState += 0x9E3779B97F4A7C15ULL);
+         z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+         z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+         return (z ^ (z >> 31)) & 1;
+      }
+
+      /**
+       * @brief Adiciona um nível vazio e recalcula as capacidades.
+       */
+      void addLevel() {
+         levels.emplace_back();
+         capacities.resize(levels.size());
+         maximumRetained = 0;
+
+         std::size_t height = levels.size();
+         for (std::size_t h = 0; h < height; ++h) {
+            double capacity = std::ceil(
+              k * std::pow(capacityDecay, static_cast<double>(height - h - 1)));
+            capacities[h]
+              = std::max(minimumCapacity, static_cast<std::size_t>(capacity));
+            maximumRetained += capacities[h];
+         }
+      }
+
+      /**
+       * @brief Compacta o nível mais baixo que excede a sua capacidade,
+       * repetindo até que o esboço volte ao tamanho máximo.
+       */
+      void compress() {
+         while (retained >= maximumRetained) {
+            std::size_t h = 0;
+            while (levels[h].size() < capacities[h]) {
+               ++h;
+            }
+
+            if (h + 1 == levels.size()) {
+               addLevel();
+            }
+
+            auto& level = levels[h];
+            auto& next = levels[h + 1];
+            std::sort(level.begin(), level.end());
+
+            TYPE leftover {};
+            bool odd = level.size() % 2 == 1;
+            if (odd) {
+               leftover = level.back();
+               level.pop_back();
+            }
+
+            std::size_t before = level.size();
+            next.reserve(next.size() + before / 2);
+            for (std::size_t i = randomBit(); i < before; i += 2) {
+               next.push_back(level[i]);
+            }
+
+            level.clear();
+            if (odd) {
+               level.push_back(leftover);
+            }
+
+            retained -= before / 2;
+         }
+      }
+
+      /**
+       * @brief Junta os itens retidos com os seus pesos, ordenados por valor.
+       *
+       * @return Pares de valor e peso acumulado.
+       */
+      std::vector<std::pair<TYPE, std::uint64_t>> cumulativeWeights() const {
+         std::vector<std::pair<TYPE, std::uint64_t>> items;
+         items.reserve(retained);
+
+         for (std::size_t h = 0; h < levels.size(); ++h) {
+            for (auto const& value : levels[h]) {
+               items.emplace_back(value, std::uint64_t { 1 } << h);
+            }
+         }
+
+         std::sort(items.begin(), items.end(),
+           [](auto const& a, auto const& b) { return a.first < b.first; });
+
+         std::uint64_t total = 0;
+         for (auto& item : items) {
+            total += item.second;
+            item.second = total;
+         }
+
+         return items;
+      }
+
+  public:
+      /**
+       * @brief Construtor com o parâmetro de precisão.
+       *
+       * @param k Controla a precisão e a memória do esboço. O padrão é 200.
+       * @param seed Semente do gerador usado nas compactações.
+       *
+       * @throws std::runtime_error se k for menor que 8.
+       */
+      QuantileSketch(std::size_t k = 200, std::uint64_t seed = 0x5EED)
+          : k(k), randomState(seed) {
+         checkK();
+         addLevel();
+      }
+
+      /**
+       * @brief Adiciona um valor ao esboço.
+       *
+       * @param value O valor a ser adicionado.
+       *
+       * @return A referência do objeto de QuantileSketch atual.
+       */
+      QuantileSketch& push(TYPE value) {
+         ++count;
+         minValue = std::min(minValue, value);
+         maxValue = std::max(maxValue, value);
+
+         levels[0].push_back(value);
+         if (++retained >= maximumRetained) {
+            compress();
+         }
+
+         return *this;
+      }
+
+      /**
+       * @brief Adiciona um range de valores ao esboço.
+       *
+       * Os valores são copiados em blocos para o nível 0, até a capacidade
+       * livre do esboço, de modo que o custo por valor é uma cópia contígua
+       * e a compactação é feita uma vez por bloco.
+       *
+       * @param values Os valores a serem adicionados.
+       *
+       * @return A referência do objeto de QuantileSketch atual.
+       */
+      QuantileSketch& pushBatch(std::span<TYPE const> values) {
+         while (!values.empty()) {
+            std::size_t room = maximumRetained - retained;
+            auto block = values.first(std::min(room, values.size()));
+
+            auto [blockMin, blockMax]
+              = std::minmax_element(block.begin(), block.end());
+            minValue = std::min(minValue, *blockMin);
+            maxValue = std::max(maxValue, *blockMax);
+
+            levels[0].insert(levels[0].end(), block.begin(), block.end());
+            count += block.size();
+            retained += block.size();
+            compress();
+
+            values = values.subspan(block.size());
+         }
+
+         return *this;
+      }
+
+      /**
+       * @brief Adiciona um range de valores ao esboço.
+       *
+       * @tparam ItInput Tipo do iterador de entrada.
+       *
+       * @param first Primeiro valor do range.
+       * @param last Ultimo valor do range.
+       *
+       * @return A referência do objeto de QuantileSketch atual.
+       */
+      template <typename ItInput,
+        typename = typename std::iterator_traits<ItInput>::iterator_category>
+      QuantileSketch& pushBatch(ItInput first, ItInput last) {
+         if constexpr (std::contiguous_iterator<ItInput>) {
+            return pushBatch(std::span<TYPE const>(first, last));
+         } else {
+            for (; first != last; ++first) {
+               push(*first);
+            }
+
+            return *this;
+         }
+      }
+
+      /**
+       * @brief Junta outro esboço a este.
+       *
+       * O resultado tem a mesma garantia de erro de um esboço que tivesse
+       * recebido os dois fluxos.
+       *
+       * @param other O esboço a ser juntado.
+       *
+       * @return A referência do objeto de QuantileSketch atual.
+       */
+      QuantileSketch& merge(QuantileSketch const& other) {
+         if (other.count == 0) {
+            return *this;
+         }
+
+         // Inserir em um vetor a partir dele mesmo não é permitido.
+         if (&other == this) {
+            return merge(QuantileSketch(other));
+         }
+
+         while (levels.size() < other.levels.size()) {
+            addLevel();
+         }
+
+         for (std::size_t h = 0; h < other.levels.size(); ++h) {
+            levels[h].insert(
+              levels[h].end(), other.levels[h].begin(), other.levels[h].end());
+         }
+
+         count += other.count;
+         retained += other.retained;
+         minValue = std::min(minValue, other.minValue);
+         maxValue = std::max(maxValue, other.maxValue);
+         compress();
+
+         return *this;
+      }
+
+      /**
+       * @brief Retorna o número de valores vistos.
+       *
+       * @return O número de valores vistos.
+       */
+      std::uint64_t size() const { return count; }
+
+      /**
+       * @brief Retorna o número de itens guardados na memória.
+       *
+       * @return O número de itens retidos.
+       */
+      std::size_t retainedItems() const { return retained; }
+
+      /**
+       * @brief Retorna o parâmetro de precisão.
+       *
+       * @return O parâmetro k.
+       */
+      std::size_t getK() const { return k; }
+
+      /**
+       * @brief Estima o quantil p do fluxo.
+       *
+       * @param p A fração desejada, entre 0 e 1.
+       *
+       * @return O valor estimado cujo posto normalizado é p.
+       *
+       * @throws std::runtime_error se o esboço estiver vazio ou se p estiver
+       * fora de [0, 1].
+       */
+      TYPE quantile(double p) const {
+         ensureNotEmpty();
+         if (p < 0 || p > 1) {
+            throw std::runtime_error("Quantile is not between 0 and 1");
+         }
+
+         if (p == 0) {
+            return minValue;
+         }
+
+         if (p == 1) {
+            return maxValue;
+         }
+
+         auto items = cumulativeWeights();
+         auto target = static_cast<std::uint64_t>(std::ceil(p * count));
+         auto found = std::lower_bound(items.begin(), items.end(), target,
+           [](auto const& item, std::uint64_t value) {
+              return item.second < value;
+           });
+
+         return found == items.end() ? maxValue : found->first;
+      }
+
+      /**
+       * @brief Estima a mediana do fluxo.
+       *
+       * @return A mediana estimada.
+       *
+       * @throws std::runtime_error se o esboço estiver vazio.
+       */
+      TYPE median() const { return quantile(0.5); }
+
+      /**
+       * @brief Estima o posto de um valor.
+       *
+       * @param value O valor consultado.
+       *
+       * @return O número estimado de valores estritamente menores.
+       */
+      std::uint64_t rank(TYPE value) const {
+         std::uint64_t smaller = 0;
+
+         for (std::size_t h = 0; h < levels.size(); ++h) {
+            for (auto const& item : levels[h]) {
+               if (item < value) {
+                  smaller += std::uint64_t { 1 } << h;
+               }
+            }
+         }
+
+         return smaller;
+      }
+
+      /**
+       * @brief Retorna o menor valor visto.
+       *
+       * @return O menor valor.
+       *
+       * @throws std::runtime_error se o esboço estiver vazio.
+       */
+      TYPE min() const {
+         ensureNotEmpty();
+         return minValue;
+      }
+
+      /**
+       * @brief Retorna o maior valor visto.
+       *
+       * @return O maior valor.
+       *
+       * @throws std::runtime_error se o esboço estiver vazio.
+       */
+      TYPE max() const {
+         ensureNotEmpty();
+         return maxValue;
+      }
+
+      /**
+       * @brief Serializa o esboço em um formato binário compacto.
+       *
+       * @return Os bytes do esboço.
+       */
+      std::vector<std::uint8_t> serialize() const {
+         ByteWriter writer;
+         writer.writeHeader(tag, version);
+         writer.writeType<TYPE>();
+         writer.write(static_cast<std::uint32_t>(k));
+         writer.write(count);
+         writer.write(minValue);
+         writer.write(maxValue);
+         writer.write(randomState);
+         writer.write(static_cast<std::uint8_t>(levels.size()));
+
+         for (auto const& level : levels) {
+            writer.writeArray(std::span<TYPE const>(level));
+         }
+
+         return writer.release();
+      }
+
+      /**
+       * @brief Reconstrói um esboço a partir dos bytes de serialize().
+       *
+       * @param bytes Os bytes do esboço.
+       *
+       * @return O esboço reconstruído.
+       *
+       * @throws std::runtime_error se os bytes forem inválidos.
+       */
+      static QuantileSketch deserialize(std::span<std::uint8_t const> bytes) {
+         ByteReader reader(bytes);
+         reader.readHeader(tag, version);
+         reader.readType<TYPE>();
+
+         QuantileSketch sketch(reader.read<std::uint32_t>());
+         sketch.count = reader.read<std::uint64_t>();
+         sketch.minValue = reader.read<TYPE>();
+         sketch.maxValue = reader.read<TYPE>();
+         sketch.randomState = reader.read<std::uint64_t>();
+
+         // Um item do nível h pesa 2^h, e o peso total cabe em 64 bits.
+         auto height = reader.read<std::uint8_t>();
+         if (height == 0 || height > 63) {
+            throw std::runtime_error("Serialized sketch height is invalid");
+         }
+
+         while (sketch.levels.size() < height) {
+            sketch.addLevel();
+         }
+
+         std::uint64_t weight = 0;
+         sketch.retained = 0;
+         for (std::size_t h = 0; h < height; ++h) {
+            auto& level = sketch.levels[h];
+            level = reader.readArray<TYPE>();
+
+            auto room = std::numeric_limits<std::uint64_t>::max() - weight;
+            if (level.size() > room >> h) {
+               throw std::runtime_error(
+                 "Serialized level weights do not match the count");
+            }
+
+            weight += std::uint64_t { level.size() } << h;
+            sketch.retained += level.size();
+         }
+
+         // Cada nível pode passar da sua capacidade, mas o total retido
+         // fica sempre abaixo do máximo dado por k e pela altura.
+         if (sketch.retained >= sketch.maximumRetained) {
+            throw std::runtime_error(
+              "Serialized levels exceed the sketch capacity");
+         }
+
+         if (weight != sketch.count) {
+            throw std::runtime_error(
+              "Serialized level weights do not match the count");
+         }
+
+         return sketch;
+      }
+   };
+}
+
+#endif /// QUANTILE_SKETCH_HPP_
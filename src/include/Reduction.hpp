@@ -0,0 +1,309 @@
+/**
+ * @file Reduction.hpp
+ * @author Pedro Lucas (pedrolucas.jsrn@gmail.com)
+ * @brief Arquivo de cabeçalho para as funções de soma serial, paralela e
+ * determinística.
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef REDUCTION_HPP_
+#define REDUCTION_HPP_
+
+#include "Numa.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace stats {
+   /**
+    * @brief Define como as somas de Statistics são calculadas.
+    */
+   enum class ReductionMode {
+      /** Uma passada sequencial na thread atual. */
+      Serial,
+      /** Partes paralelas no ThreadPool. O resultado pode variar nos últimos
+          bits conforme o número de threads. */
+      Parallel,
+      /** Árvore de soma de formato fixo sobre blocos de tamanho fixo. O
+          resultado é idêntico bit a bit para qualquer número de threads. */
+      Deterministic
+   };
+
+   /**
+    * @brief O número de elementos de cada bloco da soma determinística.
+    */
+   inline constexpr std::size_t deterministicBlockSize = 4096;
+
+   /**
+    * @brief O número mínimo de elementos de cada parte da soma paralela.
+    */
+   inline constexpr std::size_t parallelGrain = 16384;
+
+   /**
+    * @brief Soma uma função dos valores em uma passada sequencial.
+    *
+    * @tparam TYPE Tipo dos valores.
+    * @tparam FUNCTION Tipo da função aplicada a cada valor.
+    *
+    * @param values Os valores.
+    * @param function A função.
+    *
+    * @return A soma.
+    */
+   template <typename TYPE, typename FUNCTION>
+   double serialSum(std::span<TYPE const> values, FUNCTION const& function) {
+      double sum = 0;
+
+      for (auto const& value : values) {
+         sum += function(value);
+      }
+
+      return sum;
+   }
+
+   /**
+    * @brief Soma uma função dos valores com uma árvore de formato fixo.
+    *
+    * O intervalo é dividido ao meio até ter no máximo 64 elementos, que são
+    * somados em quatro faixas intercaladas combinadas como
+    * (s0 + s1) + (s2 + s3). A ordem das operações depende só do número de
+    * valores, então o resultado não muda com a largura SIMD usada pelo
+    * compilador, e o erro cresce com O(log n) em vez de O(n).
+    *
+    * @tparam TYPE Tipo dos valores.
+    * @tparam FUNCTION Tipo da função aplicada a cada valor.
+    *
+    * @param values Os valores.
+    * @param function A função.
+    *
+    * @return A soma.
+    */
+   template <typename TYPE, typename FUNCTION>
+   double pairwiseSum(std::span<TYPE const> values, FUNCTION const& function) {
+      constexpr std::size_t leafSize = 64;
+      constexpr std::size_t lanes = 4;
+
+      if (values.size() > leafSize) {
+         std::size_t half = values.size() / 2;
+         return pairwiseSum(values.first(half), function)
+           + pairwiseSum(values.subspan(half), function);
+      }
+
+      std::array<double, lanes> sums {};
+      std::size_t blocked = values.size() - values.size() % lanes;
+
+      for (std::size_t i = 0; i < blocked; i += lanes) {
+         for (std::size_t lane = 0; lane < lanes; ++lane) {
+            sums[lane] += function(values[i + lane]);
+         }
+      }
+
+      for (std::size_t i = blocked; i < values.size(); ++i) {
+         sums[i - blocked] += function(values[i]);
+      }
+
+      return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+   }
+
+   /**
+    * @brief Soma uma função dos valores em paralelo, no ThreadPool.
+    *
+    * @tparam TYPE Tipo dos valores.
+    * @tparam FUNCTION Tipo da função aplicada a cada valor.
+    *
+    * @param values Os valores.
+    * @param function A função.
+    * @param pool O pool que executa as partes.
+    *
+    * @return A soma.
+    */
+   template <typename TYPE, typename FUNCTION>
+   double parallelSum(std::span<TYPE const> values,
+     FUNCTION const& function,
+     ThreadPool& pool) {
+      return parallelReduce(
+        pool,
+        0,
+        values.size(),
+        parallelGrain,
+        0.0,
+        [&](std::size_t first, std::size_t last) {
+           return serialSum(values.subspan(first, last - first), function);
+        },
+        [](double a, double b) { return a + b; });
+   }
+
+   /**
+    * @brief Soma, em paralelo, os blocos [firstBlock, lastBlock) da soma
+    * determinística.
+    *
+    * @tparam TYPE Tipo dos valores.
+    * @tparam FUNCTION Tipo da função aplicada a cada valor.
+    *
+    * @param values Os valores.
+    * @param function A função.
+    * @param pool O pool que executa os blocos.
+    * @param firstBlock O primeiro bloco.
+    * @param lastBlock O fim dos blocos (exclusivo).
+    * @param partials Destino da soma de cada bloco, indexado pelo bloco.
+    */
+   template <typename TYPE, typename FUNCTION>
+   void blockSums(std::span<TYPE const> values,
+     FUNCTION const& function,
+     ThreadPool& pool,
+     std::size_t firstBlock,
+     std::size_t lastBlock,
+     std::span<double> partials) {
+      parallelFor(pool,
+        firstBlock,
+        lastBlock,
+        4,
+        [&](std::size_t first, std::size_t last) {
+           for (std::size_t block = first; block < last; ++block) {
+              std::size_t begin = block * deterministicBlockSize;
+              std::size_t size
+                = std::min(deterministicBlockSize, values.size() - begin);
+              partials[block]
+                = pairwiseSum(values.subspan(begin, size), function);
+           }
+        });
+   }
+
+   /**
+    * @brief Soma uma função dos valores com resultado reprodutível.
+    *
+    * Os valores são divididos em blocos de deterministicBlockSize elementos,
+    * independentes do número de threads. Cada bloco é somado por
+    * pairwiseSum, em qualquer thread, e as somas dos blocos são combinadas
+    * por outra árvore de formato fixo. Assim o resultado é idêntico bit a bit
+    * com 1 ou 64 threads.
+    *
+    * Para que o resultado também seja o mesmo entre compilações para
+    * conjuntos de instruções diferentes, o código deve ser compilado sem
+    * contração de ponto flutuante (-ffp-contract=off, já definido no
+    * CMakeLists.txt) e sem -ffast-math.
+    *
+    * @tparam TYPE Tipo dos valores.
+    * @tparam FUNCTION Tipo da função aplicada a cada valor.
+    *
+    * @param values Os valores.
+    * @param function A função.
+    * @param pool O pool que executa os blocos.
+    *
+    * @return A soma.
+    */
+   template <typename TYPE, typename FUNCTION>
+   double deterministicSum(std::span<TYPE const> values,
+     FUNCTION const& function,
+     ThreadPool& pool) {
+      std::size_t blocks
+        = (values.size() + deterministicBlockSize - 1) / deterministicBlockSize;
+      std::vector<double> partials(blocks);
+
+      blockSums(values, function, pool, 0, blocks, std::span<double>(partials));
+
+      return pairwiseSum(std::span<double const>(partials),
+        [](double partial) { return partial; });
+   }
+
+   /**
+    * @brief Soma uma função dos valores no modo escolhido.
+    *
+    * @tparam TYPE Tipo dos valores.
+    * @tparam FUNCTION Tipo da função aplicada a cada valor.
+    *
+    * @param values Os valores.
+    * @param function A função.
+    * @param mode O modo de redução.
+    * @param pool O pool dos modos paralelos. Se for nulo, usa o pool padrão.
+    *
+    * @return A soma.
+    */
+   template <typename TYPE, typename FUNCTION>
+   double reduceSum(std::span<TYPE const> values,
+     FUNCTION const& function,
+     ReductionMode mode,
+     std::shared_ptr<ThreadPool> pool = nullptr) {
+      if (mode == ReductionMode::Serial) {
+         return serialSum(values, function);
+      }
+
+      if (!pool) {
+         pool = ThreadPool::getDefault();
+      }
+
+      return mode == ReductionMode::Parallel
+        ? parallelSum(values, function, *pool)
+        : deterministicSum(values, function, *pool);
+   }
+
+   /**
+    * @brief Soma uma função dos valores no modo escolhido, com cada nó NUMA
+    * percorrendo só a sua fatia dos valores.
+    *
+    * As fatias têm fronteiras em múltiplos de deterministicBlockSize, então o
+    * modo Deterministic dá exatamente o mesmo resultado da versão sem NUMA.
+    *
+    * @tparam TYPE Tipo dos valores.
+    * @tparam FUNCTION Tipo da função aplicada a cada valor.
+    *
+    * @param values Os valores.
+    * @param function A função.
+    * @param mode O modo de redução.
+    * @param executor O executor com um pool por nó.
+    *
+    * @return A soma.
+    */
+   template <typename TYPE, typename FUNCTION>
+   double reduceSum(std::span<TYPE const> values,
+     FUNCTION const& function,
+     ReductionMode mode,
+     NumaExecutor const& executor) {
+      if (mode == ReductionMode::Serial) {
+         return serialSum(values, function);
+      }
+
+      if (mode == ReductionMode::Parallel) {
+         return executor.reduce(
+           values.size(),
+           parallelGrain,
+           deterministicBlockSize,
+           0.0,
+           [&](std::size_t first, std::size_t last) {
+              return serialSum(values.subspan(first, last - first), function);
+           },
+           [](double a, double b) { return a + b; });
+      }
+
+      std::size_t blocks
+        = (values.size() + deterministicBlockSize - 1) / deterministicBlockSize;
+      std::vector<double> partials(blocks);
+
+      executor.forEachNode(values.size(),
+        deterministicBlockSize,
+        [&](std::size_t,
+          ThreadPool& nodePool,
+          std::size_t first,
+          std::size_t last) {
+           blockSums(values,
+             function,
+             nodePool,
+             first / deterministicBlockSize,
+             (last + deterministicBlockSize - 1) / deterministicBlockSize,
+             std::span<double>(partials));
+        });
+
+      return pairwiseSum(std::span<double const>(partials),
+        [](double partial) { return partial; });
+   }
+}
+
+#endif /// REDUCTION_HPP_
@@ -0,0 +1,690 @@
+/**
+ * @file ReservoirSampler.hpp
+ * @author Pedro Lucas (pedrolucas.jsrn@gmail.com)
+ * @brief Arquivo de cabeçalho para as classes ReservoirSampler e
+ * WeightedReservoirSampler.
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef RESERVOIR_SAMPLER_HPP_
+#define RESERVOIR_SAMPLER_HPP_
+
+#include "Serialization.hpp"
+#include "Statistics.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace stats {
+   /**
+    * @class ReservoirSampler
+    * @brief Uma classe que mantém uma amostra aleatória uniforme, de tamanho
+    * fixo, de um fluxo de tamanho desconhecido.
+    *
+    * Usa o Algoritmo L: depois que o reservatório enche, o índice do próximo
+    * item aceito é sorteado diretamente (salto geométrico), então a maior
+    * parte dos itens custa apenas uma comparação e os lotes pulam os itens
+    * rejeitados sem tocá-los.
+    *
+    * @see https://doi.org/10.1145/198429.198435
+    *
+    * @tparam TYPE Define o tipo de dados. Deve ser um tipo numérico.
+    */
+   template <typename TYPE>
+   class ReservoirSampler {
+      static_assert(std::is_arithmetic_v<TYPE>, "TYPE must be a numeric type");
+
+  private:
+      static constexpr std::uint32_t tag = serializationTag("RSVR");
+      static constexpr std::uint16_t version = 1;
+
+      std::size_t capacity;
+      std::vector<TYPE> reservoir;
+      std::uint64_t seen = 0;
+      std::uint64_t nextIndex = 0;
+      double threshold = 0;
+      std::mt19937_64 generator;
+
+      /**
+       * @brief Checa se a capacidade é válida.
+       *
+       * @throws std::runtime_error se a capacidade for zero.
+       */
+      void checkCapacity() const {
+         if (capacity == 0) {
+            throw std::runtime_error("Reservoir capacity is zero");
+         }
+      }
+
+      /**
+       * @brief Sorteia um número uniforme em (0, 1).
+       *
+       * @return O número sorteado.
+       */
+      double random() {
+         double value;
+         do {
+            value = std::generate_canonical<double, 53>(generator);
+         } while (value == 0);
+
+         return value;
+      }
+
+      /**
+       * @brief Sorteia o índice do próximo item aceito a partir do limiar
+       * atual.
+       */
+      void scheduleNext() {
+         double skip = std::floor(std::log(random()) / std::log1p(-threshold));
+         nextIndex = skip >= static_cast<double>(
+                       std::numeric_limits<std::uint64_t>::max() - seen)
+           ? std::numeric_limits<std::uint64_t>::max()
+           : seen + static_cast<std::uint64_t>(skip) + 1;
+      }
+
+      /**
+       * @brief Aceita o item atual, substituindo um elemento sorteado do
+       * reservatório, e sorteia o próximo salto.
+       *
+       * @param value O item aceito.
+       */
+      void accept(TYPE value) {
+         std::uniform_int_distribution<std::size_t> slot(0, capacity - 1);
+         reservoir[slot(generator)] = value;
+         threshold *= std::exp(std::log(random()) / capacity);
+         scheduleNext();
+      }
+
+      /**
+       * @brief Reinicia o limiar com a distribuição que ele teria depois de
+       * `seen` itens: o k-ésimo menor de `seen` uniformes, Beta(k, n - k + 1).
+       */
+      void resetThreshold() {
+         std::gamma_distribution<double> smaller(capacity);
+         std::gamma_distribution<double> larger(seen - capacity + 1.0);
+         double a = smaller(generator);
+         double b = larger(generator);
+         threshold = a / (a + b);
+         scheduleNext();
+      }
+
+  public:
+      /**
+       * @brief Construtor com o tamanho da amostra.
+       *
+       * @param capacity O tamanho máximo da amostra.
+       * @param seed Semente do gerador aleatório.
+       *
+       * @throws std::runtime_error se a capacidade for zero.
+       */
+      ReservoirSampler(std::size_t capacity, std::uint64_t seed = 0x5EED)
+          : capacity(capacity), generator(seed) {
+         checkCapacity();
+         reservoir.reserve(capacity);
+      }
+
+      /**
+       * @brief Oferece um item do fluxo ao reservatório.
+       *
+       * @param value O item.
+       *
+       * @return A referência do objeto de ReservoirSampler atual.
+       */
+      ReservoirSampler& push(TYPE value) {
+         ++seen;
+
+         if (reservoir.size() < capacity) {
+            reservoir.push_back(value);
+
+            if (reservoir.size() == capacity) {
+               threshold = std::exp(std::log(random()) / capacity);
+               scheduleNext();
+            }
+         } else if (seen == nextIndex) {
+            accept(value);
+         }
+
+         return *this;
+      }
+
+      /**
+       * @brief Oferece um lote de itens ao reservatório.
+       *
+       * Os itens entre dois aceites são pulados sem serem lidos.
+       *
+       * @param values Os itens.
+       *
+       * @return A referência do objeto de ReservoirSampler atual.
+       */
+      ReservoirSampler& pushBatch(std::span<TYPE const> values) {
+         std::size_t i = 0;
+
+         for (; i < values.size() && reservoir.size() < capacity; ++i) {
+            push(values[i]);
+         }
+
+         std::uint64_t batchStart = seen - i;
+         while (i < values.size()) {
+            std::uint64_t remaining = values.size() - i;
+            if (nextIndex - seen > remaining) {
+               seen += remaining;
+               break;
+            }
+
+            i = nextIndex - batchStart - 1;
+            seen = nextIndex;
+            accept(values[i++]);
+         }
+
+         return *this;
+      }
+
+      /**
+       * @brief Oferece um range de itens ao reservatório.
+       *
+       * @tparam ItInput Tipo do iterador de entrada.
+       *
+       * @param first Primeiro valor do range.
+       * @param last Ultimo valor do range.
+       *
+       * @return A referência do objeto de ReservoirSampler atual.
+       */
+      template <typename ItInput,
+        typename = typename std::iterator_traits<ItInput>::iterator_category>
+      ReservoirSampler& pushBatch(ItInput first, ItInput last) {
+         if constexpr (std::contiguous_iterator<ItInput>) {
+            return pushBatch(std::span<TYPE const>(first, last));
+         } else {
+            for (; first != last; ++first) {
+               push(*first);
+            }
+
+            return *this;
+         }
+      }
+
+      /**
+       * @brief Junta outro reservatório a este, como se os dois fluxos fossem
+       * um só.
+       *
+       * Cada posição da amostra final vem de um dos reservatórios com
+       * probabilidade proporcional ao número de itens que ele ainda
+       * representa, de modo que a amostra continua uniforme sobre a união
+       * dos fluxos. Serve para juntar reservatórios de várias threads.
+       *
+       * @param other O reservatório a ser juntado.
+       *
+       * @return A referência do objeto de ReservoirSampler atual.
+       */
+      ReservoirSampler& merge(ReservoirSampler const& other) {
+         if (other.seen == 0) {
+            return *this;
+         }
+
+         std::vector<TYPE> own(reservoir);
+         std::vector<TYPE> others(other.reservoir);
+         std::shuffle(own.begin(), own.end(), generator);
+         std::shuffle(others.begin(), others.end(), generator);
+
+         std::uint64_t ownWeight = seen;
+         std::uint64_t otherWeight = other.seen;
+         std::size_t target = std::min<std::uint64_t>(capacity, seen + other.seen);
+
+         reservoir.clear();
+         while (reservoir.size() < target) {
+            bool fromOwn = others.empty()
+              || (!own.empty()
+                && random() * (ownWeight + otherWeight) < ownWeight);
+
+            auto& source = fromOwn ? own : others;
+            auto& weight = fromOwn ? ownWeight : otherWeight;
+            reservoir.push_back(source.back());
+            source.pop_back();
+            --weight;
+         }
+
+         seen += other.seen;
+         if (reservoir.size() == capacity) {
+            resetThreshold();
+         }
+
+         return *this;
+      }
+
+      /**
+       * @brief Obter a amostra.
+       *
+       * @return Os itens do reservatório.
+       */
+      std::vector<TYPE> getSample() const { return reservoir; }
+
+      /**
+       * @brief Retorna o número de itens vistos no fluxo.
+       *
+       * @return O número de itens vistos.
+       */
+      std::uint64_t size() const { return seen; }
+
+      /**
+       * @brief Cria um objeto Statistics com a amostra.
+       *
+       * A amostra é marcada como dados de amostra, então a variância usa o
+       * denominador n - 1.
+       *
+       * @return Um Statistics que responde média, mediana, moda e quantis
+       * aproximados do fluxo.
+       */
+      Statistics<TYPE> toStatistics() const {
+         return Statistics<TYPE>(reservoir.begin(), reservoir.end(), false);
+      }
+
+      /**
+       * @brief Serializa o reservatório em um formato binário compacto.
+       *
+       * O estado interno do gerador aleatório não tem representação binária
+       * no padrão, então é gravada uma semente sorteada de uma cópia dele.
+       * O reservatório restaurado continua com outra sequência aleatória,
+       * mas com a mesma distribuição, e bytes iguais restauram reservatórios
+       * iguais.
+       *
+       * @return Os bytes do reservatório.
+       */
+      std::vector<std::uint8_t> serialize() const {
+         std::mt19937_64 copy(generator);
+
+         ByteWriter writer;
+         writer.writeHeader(tag, version);
+         writer.writeType<TYPE>();
+         writer.write(static_cast<std::uint64_t>(capacity));
+         writer.write(seen);
+         writer.write(nextIndex);
+         writer.write(threshold);
+         writer.write(static_cast<std::uint64_t>(copy()));
+         writer.writeAlignedArray(std::span<TYPE const>(reservoir));
+
+         return writer.release();
+      }
+
+      /**
+       * @brief Reconstrói um reservatório a partir dos bytes de serialize().
+       *
+       * @param bytes Os bytes do reservatório.
+       *
+       * @return O reservatório reconstruído.
+       *
+       * @throws std::runtime_error se os bytes forem inválidos.
+       */
+      static ReservoirSampler deserialize(std::span<std::uint8_t const> bytes) {
+         ByteReader reader(bytes);
+         reader.readHeader(tag, version);
+         reader.readType<TYPE>();
+
+         auto capacity = reader.read<std::uint64_t>();
+         auto seen = reader.read<std::uint64_t>();
+         auto nextIndex = reader.read<std::uint64_t>();
+         double threshold = reader.read<double>();
+         auto seed = reader.read<std::uint64_t>();
+         auto reservoir = reader.readAlignedArray<TYPE>();
+
+         if (reservoir.size() != std::min(capacity, seen)) {
+            throw std::runtime_error("Serialized reservoir has wrong size");
+         }
+
+         // Reserva só os itens gravados: a capacidade lida não passou por
+         // nenhuma checagem e não deve decidir quanta memória alocar.
+         ReservoirSampler sampler(
+           std::max<std::size_t>(reservoir.size(), 1), seed);
+         sampler.capacity = capacity;
+         sampler.checkCapacity();
+         sampler.reservoir = std::move(reservoir);
+
+         sampler.seen = seen;
+         sampler.nextIndex = nextIndex;
+         sampler.threshold = threshold;
+
+         return sampler;
+      }
+   };
+
+   /**
+    * @class WeightedReservoirSampler
+    * @brief Uma classe que mantém uma amostra ponderada, sem reposição, de
+    * tamanho fixo, de um fluxo de tamanho desconhecido.
+    *
+    * Usa o algoritmo A-ExpJ de Efraimidis e Spirakis: cada item recebe a
+    * chave u^(1/w) e a amostra são os itens de maiores chaves. Depois que o
+    * reservatório enche, sorteia-se quanto peso pode ser pulado até o próximo
+    * aceite, então a maior parte dos itens custa uma subtração.
+    *
+    * @see https://doi.org/10.1016/j.ipl.2005.11.003
+    *
+    * @tparam TYPE Define o tipo de dados. Deve ser um tipo numérico.
+    */
+   template <typename TYPE>
+   class WeightedReservoirSampler {
+      static_assert(std::is_arithmetic_v<TYPE>, "TYPE must be a numeric type");
+
+  private:
+      /**
+       * @brief Um item da amostra com o logaritmo da sua chave.
+       */
+      struct Entry {
+         double logKey;
+         TYPE value;
+
+         bool operator>(Entry const& other) const {
+            return logKey > other.logKey;
+         }
+      };
+
+      static constexpr std::uint32_t tag = serializationTag("WRSV");
+      static constexpr std::uint16_t version = 1;
+
+      std::size_t capacity;
+      std::vector<Entry> heap;
+      std::uint64_t seen = 0;
+      double totalWeight = 0;
+      double weightToSkip = 0;
+      std::mt19937_64 generator;
+
+      /**
+       * @brief Checa se a capacidade é válida.
+       *
+       * @throws std::runtime_error se a capacidade for zero.
+       */
+      void checkCapacity() const {
+         if (capacity == 0) {
+            throw std::runtime_error("Reservoir capacity is zero");
+         }
+      }
+
+      /**
+       * @brief Sorteia um número uniforme em (0, 1).
+       *
+       * @return O número sorteado.
+       */
+      double random() {
+         double value;
+         do {
+            value = std::generate_canonical<double, 53>(generator);
+         } while (value == 0);
+
+         return value;
+      }
+
+      /**
+       * @brief Sorteia o peso a ser pulado até o próximo aceite.
+       */
+      void scheduleJump() {
+         weightToSkip = std::log(random()) / heap.front().logKey;
+      }
+
+      /**
+       * @brief Insere um item no heap de mínimo por chave.
+       *
+       * @param entry O item.
+       */
+      void pushHeap(Entry const& entry) {
+         heap.push_back(entry);
+         std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+      }
+
+  public:
+      /**
+       * @brief Construtor com o tamanho da amostra.
+       *
+       * @param capacity O tamanho máximo da amostra.
+       * @param seed Semente do gerador aleatório.
+       *
+       * @throws std::runtime_error se a capacidade for zero.
+       */
+      WeightedReservoirSampler(
+        std::size_t capacity, std::uint64_t seed = 0x5EED)
+          : capacity(capacity), generator(seed) {
+         checkCapacity();
+         heap.reserve(capacity);
+      }
+
+      /**
+       * @brief Oferece um item ponderado do fluxo ao reservatório.
+       *
+       * @param value O item.
+       * @param weight O peso do item. Itens de peso zero nunca são escolhidos.
+       *
+       * @return A referência do objeto de WeightedReservoirSampler atual.
+       *
+       * @throws std::runtime_error se o peso for negativo.
+       */
+      WeightedReservoirSampler& push(TYPE value, double weight) {
+         if (weight < 0) {
+            throw std::runtime_error("Weight is negative");
+         }
+
+         ++seen;
+         totalWeight += weight;
+         if (weight == 0) {
+            return *this;
+         }
+
+         if (heap.size() < capacity) {
+            pushHeap({ std::log(random()) / weight, value });
+
+            if (heap.size() == capacity) {
+               scheduleJump();
+            }
+
+            return *this;
+         }
+
+         weightToSkip -= weight;
+         if (weightToSkip > 0) {
+            return *this;
+         }
+
+         // A nova chave é sorteada condicionada a superar a menor chave.
+         double minimum = std::exp(heap.front().logKey * weight);
+         double u = minimum + (1 - minimum) * random();
+
+         std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>());
+         heap.back() = { std::log(u) / weight, value };
+         std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+         scheduleJump();
+
+         return *this;
+      }
+
+      /**
+       * @brief Oferece um lote de itens ponderados ao reservatório.
+       *
+       * @param values Os itens.
+       * @param weights Os pesos, um para cada item.
+       *
+       * @return A referência do objeto de WeightedReservoirSampler atual.
+       *
+       * @throws std::runtime_error se os tamanhos forem diferentes ou se algum
+       * peso for negativo.
+       */
+      WeightedReservoirSampler& pushBatch(
+        std::span<TYPE const> values, std::span<double const> weights) {
+         if (values.size() != weights.size()) {
+            throw std::runtime_error("Values and weights have different sizes");
+         }
+
+         for (std::size_t i = 0; i < values.size(); ++i) {
+            push(values[i], weights[i]);
+         }
+
+         return *this;
+      }
+
+      /**
+       * @brief Junta outro reservatório a este, como se os dois fluxos fossem
+       * um só.
+       *
+       * As chaves são independentes entre os fluxos, então a amostra da união
+       * são os itens de maiores chaves dos dois reservatórios.
+       *
+       * @param other O reservatório a ser juntado.
+       *
+       * @return A referência do objeto de WeightedReservoirSampler atual.
+       */
+      WeightedReservoirSampler& merge(WeightedReservoirSampler const& other) {
+         for (auto const& entry : other.heap) {
+            if (heap.size() < capacity) {
+               pushHeap(entry);
+            } else if (entry.logKey > heap.front().logKey) {
+               std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>());
+               heap.back() = entry;
+               std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+            }
+         }
+
+         seen += other.seen;
+         totalWeight += other.totalWeight;
+         if (heap.size() == capacity) {
+            scheduleJump();
+         }
+
+         return *this;
+      }
+
+      /**
+       * @brief Obter a amostra.
+       *
+       * @return Os itens do reservatório.
+       */
+      std::vector<TYPE> getSample() const {
+         std::vector<TYPE> sample;
+         sample.reserve(heap.size());
+
+         for (auto const& entry : heap) {
+            sample.push_back(entry.value);
+         }
+
+         return sample;
+      }
+
+      /**
+       * @brief Retorna o número de itens vistos no fluxo.
+       *
+       * @return O número de itens vistos.
+       */
+      std::uint64_t size() const { return seen; }
+
+      /**
+       * @brief Retorna a soma dos pesos vistos no fluxo.
+       *
+       * @return A soma dos pesos.
+       */
+      double getTotalWeight() const { return totalWeight; }
+
+      /**
+       * @brief Cria um objeto Statistics com a amostra.
+       *
+       * @return Um Statistics com os itens da amostra, marcados como dados de
+       * amostra.
+       */
+      Statistics<TYPE> toStatistics() const {
+         auto sample = getSample();
+         return Statistics<TYPE>(sample.begin(), sample.end(), false);
+      }
+
+      /**
+       * @brief Serializa o reservatório em um formato binário compacto.
+       *
+       * Como em ReservoirSampler::serialize, o gerador aleatório é gravado
+       * como uma semente sorteada de uma cópia dele.
+       *
+       * @return Os bytes do reservatório.
+       */
+      std::vector<std::uint8_t> serialize() const {
+         std::mt19937_64 copy(generator);
+         std::vector<double> logKeys;
+         std::vector<TYPE> values;
+
+         for (auto const& entry : heap) {
+            logKeys.push_back(entry.logKey);
+            values.push_back(entry.value);
+         }
+
+         ByteWriter writer;
+         writer.writeHeader(tag, version);
+         writer.writeType<TYPE>();
+         writer.write(static_cast<std::uint64_t>(capacity));
+         writer.write(seen);
+         writer.write(totalWeight);
+         writer.write(weightToSkip);
+         writer.write(static_cast<std::uint64_t>(copy()));
+         writer.writeAlignedArray(std::span<double const>(logKeys));
+         writer.writeAlignedArray(std::span<TYPE const>(values));
+
+         return writer.release();
+      }
+
+      /**
+       * @brief Reconstrói um reservatório a partir dos bytes de serialize().
+       *
+       * @param bytes Os bytes do reservatório.
+       *
+       * @return O reservatório reconstruído.
+       *
+       * @throws std::runtime_error se os bytes forem inválidos.
+       */
+      static WeightedReservoirSampler deserialize(
+        std::span<std::uint8_t const> bytes) {
+         ByteReader reader(bytes);
+         reader.readHeader(tag, version);
+         reader.readType<TYPE>();
+
+         auto capacity = reader.read<std::uint64_t>();
+         auto seen = reader.read<std::uint64_t>();
+         double totalWeight = reader.read<double>();
+         double weightToSkip = reader.read<double>();
+         auto seed = reader.read<std::uint64_t>();
+         auto logKeys = reader.readAlignedArray<double>();
+         auto values = reader.readAlignedArray<TYPE>();
+
+         if (logKeys.size() != values.size() || values.size() > capacity) {
+            throw std::runtime_error("Serialized reservoir has wrong size");
+         }
+
+         // Como em ReservoirSampler::deserialize, reserva só os itens
+         // gravados.
+         WeightedReservoirSampler sampler(
+           std::max<std::size_t>(values.size(), 1), seed);
+         sampler.capacity = capacity;
+         sampler.checkCapacity();
+
+         for (std::size_t i = 0; i < values.size(); ++i) {
+            sampler.heap.push_back({ logKeys[i], values[i] });
+         }
+
+         if (!std::is_heap(sampler.heap.begin(),
+               sampler.heap.end(),
+               std::greater<Entry>())) {
+            throw std::runtime_error("Serialized reservoir is not a heap");
+         }
+
+         sampler.seen = seen;
+         sampler.totalWeight = totalWeight;
+         sampler.weightToSkip = weightToSkip;
+
+         return sampler;
+      }
+   };
+}
+
+#endif /// RESERVOIR_SAMPLER_HPP_
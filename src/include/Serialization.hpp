@@ -0,0 +1,447 @@
+/**
+ * @file Serialization.hpp
+ * @author Pedro Lucas (pedrolucas.jsrn@gmail.com)
+ * @brief Arquivo de cabeçalho para as ferramentas de serialização binária.
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef SERIALIZATION_HPP_
+#define SERIALIZATION_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace stats {
+   /**
+    * @class ByteWriter
+    * @brief Uma classe que escreve valores em um buffer binário compacto.
+    *
+    * Os valores são escritos na ordem de bytes nativa da máquina, que deve
+    * ser little-endian.
+    */
+   class ByteWriter {
+  private:
+      std::vector<std::uint8_t> buffer;
+
+  public:
+      /**
+       * @brief Escreve um valor trivialmente copiável.
+       *
+       * @tparam VALUE Tipo do valor.
+       *
+       * @param value O valor a ser escrito.
+       *
+       * @return A referência do objeto de ByteWriter atual.
+       */
+      template <typename VALUE>
+      ByteWriter& write(VALUE const& value) {
+         static_assert(std::is_trivially_copyable_v<VALUE>,
+           "VALUE must be trivially copyable");
+
+         return writeBytes(&value, sizeof(VALUE));
+      }
+
+      /**
+       * @brief Escreve um vetor de valores precedido do seu tamanho.
+       *
+       * @tparam VALUE Tipo dos valores.
+       *
+       * @param values Os valores a serem escritos.
+       *
+       * @return A referência do objeto de ByteWriter atual.
+       */
+      template <typename VALUE>
+      ByteWriter& writeArray(std::span<VALUE const> values) {
+         write<std::uint64_t>(values.size());
+         return writeArrayData(values);
+      }
+
+      /**
+       * @brief Escreve os valores de um vetor, sem o tamanho.
+       *
+       * @tparam VALUE Tipo dos valores.
+       *
+       * @param values Os valores a serem escritos.
+       *
+       * @return A referência do objeto de ByteWriter atual.
+       */
+      template <typename VALUE>
+      ByteWriter& writeArrayData(std::span<VALUE const> values) {
+         static_assert(std::is_trivially_copyable_v<VALUE>,
+           "VALUE must be trivially copyable");
+
+         return writeBytes(values.data(), values.size_bytes());
+      }
+
+      /**
+       * @brief Escreve bytes brutos.
+       *
+       * @param data Ponteiro para os bytes.
+       * @param size Número de bytes.
+       *
+       * @return A referência do objeto de ByteWriter atual.
+       */
+      ByteWriter& writeBytes(void const* data, std::size_t size) {
+         auto bytes = static_cast<std::uint8_t const*>(data);
+         buffer.insert(buffer.end(), bytes, bytes + size);
+
+         return *this;
+      }
+
+      /**
+       * @brief Escreve um vetor de valores precedido do seu tamanho, com os
+       * valores alinhados a alignof(VALUE) em relação ao início do buffer,
+       * para que possam ser lidos sem cópia por ByteReader::readArrayView.
+       *
+       * @tparam VALUE Tipo dos valores.
+       *
+       * @param values Os valores a serem escritos.
+       *
+       * @return A referência do objeto de ByteWriter atual.
+       */
+      template <typename VALUE>
+      ByteWriter& writeAlignedArray(std::span<VALUE const> values) {
+         write<std::uint64_t>(values.size());
+         align(alignof(VALUE));
+         return writeArrayData(values);
+      }
+
+      /**
+       * @brief Completa o buffer com zeros até um múltiplo do alinhamento.
+       *
+       * @param alignment O alinhamento, em bytes.
+       *
+       * @return A referência do objeto de ByteWriter atual.
+       */
+      ByteWriter& align(std::size_t alignment) {
+         buffer.resize((buffer.size() + alignment - 1) / alignment * alignment);
+
+         return *this;
+      }
+
+      /**
+       * @brief Reserva espaço para evitar realocações em escritas grandes.
+       *
+       * @param size O número total de bytes esperado.
+       *
+       * @return A referência do objeto de ByteWriter atual.
+       */
+      ByteWriter& reserve(std::size_t size) {
+         buffer.reserve(size);
+
+         return *this;
+      }
+
+      /**
+       * @brief Escreve a descrição de um tipo numérico: tamanho, se é de
+       * ponto flutuante e se tem sinal.
+       *
+       * @tparam TYPE O tipo descrito.
+       *
+       * @return A referência do objeto de ByteWriter atual.
+       */
+      template <typename TYPE>
+      ByteWriter& writeType() {
+         write(static_cast<std::uint8_t>(sizeof(TYPE)));
+         write(static_cast<std::uint8_t>(std::is_floating_point_v<TYPE>));
+         return write(static_cast<std::uint8_t>(std::is_signed_v<TYPE>));
+      }
+
+      /**
+       * @brief Escreve o cabeçalho de um objeto serializado.
+       *
+       * @param tag Identificador de quatro bytes do tipo do objeto.
+       * @param version Versão do formato.
+       *
+       * @return A referência do objeto de ByteWriter atual.
+       */
+      ByteWriter& writeHeader(std::uint32_t tag, std::uint16_t version) {
+         write(tag);
+         return write(version);
+      }
+
+      /**
+       * @brief Obter os bytes escritos.
+       *
+       * @return Os bytes escritos.
+       */
+      std::vector<std::uint8_t> getBytes() const { return buffer; }
+
+      /**
+       * @brief Move os bytes escritos para fora do objeto.
+       *
+       * @return Os bytes escritos.
+       */
+      std::vector<std::uint8_t> release() { return std::move(buffer); }
+   };
+
+   /**
+    * @class ByteReader
+    * @brief Uma classe que lê valores de um buffer escrito por ByteWriter.
+    */
+   class ByteReader {
+  private:
+      std::span<std::uint8_t const> bytes;
+      std::size_t offset = 0;
+
+      /**
+       * @brief Checa se ainda há bytes suficientes para leitura.
+       *
+       * @param size Número de bytes requisitados.
+       *
+       * @throws std::runtime_error se o buffer terminar antes.
+       */
+      void ensureAvailable(std::size_t size) const {
+         if (size > bytes.size() - offset) {
+            throw std::runtime_error("Serialized data is truncated");
+         }
+      }
+
+  public:
+      /**
+       * @brief Construtor com os bytes a serem lidos.
+       *
+       * @param bytes Os bytes a serem lidos.
+       */
+      ByteReader(std::span<std::uint8_t const> bytes) : bytes(bytes) { }
+
+      /**
+       * @brief Lê um valor trivialmente copiável.
+       *
+       * @tparam VALUE Tipo do valor.
+       *
+       * @return O valor lido.
+       *
+       * @throws std::runtime_error se o buffer terminar antes.
+       */
+      template <typename VALUE>
+      VALUE read() {
+         static_assert(std::is_trivially_copyable_v<VALUE>,
+           "VALUE must be trivially copyable");
+
+         VALUE value;
+         readBytes(&value, sizeof(VALUE));
+
+         return value;
+      }
+
+      /**
+       * @brief Lê um vetor de valores escrito por ByteWriter::writeArray.
+       *
+       * @tparam VALUE Tipo dos valores.
+       *
+       * @return Os valores lidos.
+       *
+       * @throws std::runtime_error se o buffer terminar antes.
+       */
+      template <typename VALUE>
+      std::vector<VALUE> readArray() {
+         auto size = read<std::uint64_t>();
+         if (size > (bytes.size() - offset) / sizeof(VALUE)) {
+            throw std::runtime_error("Serialized data is truncated");
+         }
+
+         std::vector<VALUE> values(size);
+         readBytes(values.data(), size * sizeof(VALUE));
+
+         return values;
+      }
+
+      /**
+       * @brief Lê um vetor escrito por ByteWriter::writeAlignedArray sem
+       * copiar os valores.
+       *
+       * @tparam VALUE Tipo dos valores.
+       *
+       * @return Os valores, válidos enquanto os bytes lidos existirem.
+       *
+       * @throws std::runtime_error se o buffer terminar antes ou se os bytes
+       * não estiverem alinhados para VALUE na memória.
+       */
+      template <typename VALUE>
+      std::span<VALUE const> readArrayView() {
+         static_assert(std::is_trivially_copyable_v<VALUE>,
+           "VALUE must be trivially copyable");
+
+         auto size = read<std::uint64_t>();
+         align(alignof(VALUE));
+         if (size > (bytes.size() - offset) / sizeof(VALUE)) {
+            throw std::runtime_error("Serialized data is truncated");
+         }
+
+         auto first = bytes.data() + offset;
+         if (reinterpret_cast<std::uintptr_t>(first) % alignof(VALUE) != 0) {
+            throw std::runtime_error("Serialized data is not aligned");
+         }
+
+         offset += size * sizeof(VALUE);
+         return std::span<VALUE const>(
+           reinterpret_cast<VALUE const*>(first), size);
+      }
+
+      /**
+       * @brief Lê um vetor escrito por ByteWriter::writeAlignedArray,
+       * copiando os valores.
+       *
+       * @tparam VALUE Tipo dos valores.
+       *
+       * @return Os valores lidos.
+       *
+       * @throws std::runtime_error se o buffer terminar antes.
+       */
+      template <typename VALUE>
+      std::vector<VALUE> readAlignedArray() {
+         auto size = read<std::uint64_t>();
+         align(alignof(VALUE));
+         if (size > (bytes.size() - offset) / sizeof(VALUE)) {
+            throw std::runtime_error("Serialized data is truncated");
+         }
+
+         std::vector<VALUE> values(size);
+         readBytes(values.data(), size * sizeof(VALUE));
+
+         return values;
+      }
+
+      /**
+       * @brief Pula os bytes de preenchimento escritos por ByteWriter::align.
+       *
+       * @param alignment O alinhamento, em bytes.
+       *
+       * @throws std::runtime_error se o buffer terminar antes.
+       */
+      void align(std::size_t alignment) {
+         std::size_t padding = (alignment - offset % alignment) % alignment;
+         ensureAvailable(padding);
+         offset += padding;
+      }
+
+      /**
+       * @brief Lê bytes brutos.
+       *
+       * @param data Destino dos bytes.
+       * @param size Número de bytes.
+       *
+       * @throws std::runtime_error se o buffer terminar antes.
+       */
+      void readBytes(void* data, std::size_t size) {
+         ensureAvailable(size);
+         if (size > 0) {
+            std::memcpy(data, bytes.data() + offset, size);
+         }
+
+         offset += size;
+      }
+
+      /**
+       * @brief Lê e valida o cabeçalho de um objeto serializado.
+       *
+       * @param tag Identificador esperado do tipo do objeto.
+       * @param version Versão máxima suportada do formato.
+       *
+       * @return A versão lida.
+       *
+       * @throws std::runtime_error se o identificador não corresponder ou se a
+       * versão não for suportada.
+       */
+      std::uint16_t readHeader(std::uint32_t tag, std::uint16_t version) {
+         if (read<std::uint32_t>() != tag) {
+            throw std::runtime_error("Serialized data has an unexpected tag");
+         }
+
+         auto readVersion = read<std::uint16_t>();
+         if (readVersion == 0 || readVersion > version) {
+            throw std::runtime_error("Serialized data version is unsupported");
+         }
+
+         return readVersion;
+      }
+
+      /**
+       * @brief Lê e valida a descrição escrita por ByteWriter::writeType.
+       *
+       * @tparam TYPE O tipo esperado.
+       *
+       * @throws std::runtime_error se o tipo serializado for outro.
+       */
+      template <typename TYPE>
+      void readType() {
+         auto size = read<std::uint8_t>();
+         auto floatingPoint = read<std::uint8_t>();
+         auto isSigned = read<std::uint8_t>();
+
+         if (size != sizeof(TYPE)
+           || floatingPoint != std::is_floating_point_v<TYPE>
+           || isSigned != std::is_signed_v<TYPE>) {
+            throw std::runtime_error("Serialized data has another TYPE");
+         }
+      }
+
+      /**
+       * @brief Retorna o número de bytes ainda não lidos.
+       *
+       * @return O número de bytes restantes.
+       */
+      std::size_t remaining() const { return bytes.size() - offset; }
+   };
+
+   /**
+    * @brief Cria o identificador de quatro bytes de um tipo serializado.
+    *
+    * @param name Nome de quatro caracteres.
+    *
+    * @return O identificador.
+    */
+   constexpr std::uint32_t serializationTag(char const (&name)[5]) {
+      return static_cast<std::uint32_t>(static_cast<std::uint8_t>(name[0]))
+        | static_cast<std::uint32_t>(static_cast<std::uint8_t>(name[1])) << 8
+        | static_cast<std::uint32_t>(static_cast<std::uint8_t>(name[2])) << 16
+        | static_cast<std::uint32_t>(static_cast<std::uint8_t>(name[3])) << 24;
+   }
+
+   /**
+    * @brief Calcula o hash de 64 bits de um valor numérico.
+    *
+    * Zeros com sinal são normalizados, de modo que 0.0 e -0.0 têm o mesmo
+    * hash, e os bits são misturados pela finalização do MurmurHash3. É o
+    * hash de HyperLogLog e das partições de FrequencyTable.
+    *
+    * @tparam TYPE O tipo do valor.
+    *
+    * @param value O valor.
+    *
+    * @return O hash do valor.
+    */
+   template <typename TYPE>
+   std::uint64_t hashValue(TYPE value) {
+      if constexpr (std::is_floating_point_v<TYPE>) {
+         if (value == 0) {
+            value = 0;
+         }
+      }
+
+      std::uint64_t bits = 0;
+      std::memcpy(&bits, &value, std::min(sizeof(TYPE), sizeof(bits)));
+
+      bits ^= bits >> 33;
+      bits *= 0xFF51AFD7ED558CCDULL;
+      bits ^= bits >> 33;
+      bits *= 0xC4CEB9FE1A85EC53ULL;
+      bits ^= bits >> 33;
+
+      return bits;
+   }
+}
+
+#endif /// SERIALIZATION_HPP_
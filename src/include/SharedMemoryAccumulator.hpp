@@ -0,0 +1,562 @@
+/**
+ * @file SharedMemoryAccumulator.hpp
+ * @author Pedro Lucas (pedrolucas.jsrn@gmail.com)
+ * @brief Arquivo de cabeçalho para a classe SharedMemoryAccumulator.
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef SHARED_MEMORY_ACCUMULATOR_HPP_
+#define SHARED_MEMORY_ACCUMULATOR_HPP_
+
+#include "Serialization.hpp"
+#include "StreamingStatistics.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace stats {
+   /**
+    * @class SharedMemoryAccumulator
+    * @brief Um acumulador de contagem, média, variância, mínimo e máximo em um
+    * segmento de memória compartilhada POSIX, alimentado por vários processos.
+    *
+    * O segmento tem um cabeçalho e um número fixo de posições (slots), uma
+    * por processo escritor, alinhadas à linha de cache. Cada processo ocupa
+    * uma posição na primeira escrita e só ele escreve nela, com o mesmo
+    * contador de sequência (seqlock) do ConcurrentAccumulator. Um processo
+    * leitor abre o segmento e junta as posições sem comunicação com os
+    * escritores e sem copiar os valores brutos.
+    *
+    * Processos criados por fork() depois de uma escrita ocupam uma posição
+    * nova na primeira escrita deles. Dentro de um processo, cada objeto deve
+    * ser alimentado por uma única thread; várias threads podem juntar os
+    * seus valores em um ConcurrentAccumulator e publicar lotes. As posições
+    * de processos encerrados continuam contando no total.
+    *
+    * @tparam TYPE Define o tipo de dados. Deve ser um tipo numérico.
+    */
+   template <typename TYPE>
+   class SharedMemoryAccumulator {
+      static_assert(std::is_arithmetic_v<TYPE>, "TYPE must be a numeric type");
+      static_assert(std::atomic<TYPE>::is_always_lock_free
+          && std::atomic<double>::is_always_lock_free
+          && std::atomic<std::uint64_t>::is_always_lock_free,
+        "Shared memory atomics must be lock-free");
+
+  private:
+      static constexpr std::size_t cacheLineSize = 64;
+      static constexpr std::uint32_t tag = serializationTag("SHMA");
+      static constexpr std::uint16_t version = 2;
+      static constexpr std::chrono::milliseconds readTimeout { 100 };
+
+      /**
+       * @brief O cabeçalho do segmento.
+       */
+      struct alignas(cacheLineSize) Header {
+         std::atomic<std::uint32_t> tag;
+         std::uint16_t version;
+         std::uint16_t typeSize;
+         std::uint8_t floatingPoint;
+         std::uint8_t isSigned;
+         std::uint8_t populationData;
+         std::uint32_t slotCount;
+         std::atomic<std::uint32_t> claimedSlots;
+      };
+
+      /**
+       * @brief A posição de um processo.
+       */
+      struct alignas(cacheLineSize) Slot {
+         std::atomic<std::uint64_t> sequence { 0 };
+         std::atomic<std::int32_t> owner { 0 };
+         std::atomic<std::uint64_t> count { 0 };
+         std::atomic<double> mean { 0 };
+         std::atomic<double> m2 { 0 };
+         std::atomic<TYPE> minValue { std::numeric_limits<TYPE>::max() };
+         std::atomic<TYPE> maxValue { std::numeric_limits<TYPE>::lowest() };
+      };
+
+      Header* header = nullptr;
+      Slot* slots = nullptr;
+      std::size_t mappedBytes = 0;
+      Slot* ownSlot = nullptr;
+      std::uint64_t ownGeneration = 0;
+
+      /**
+       * @brief Retorna o contador de fork() do processo, incrementado no
+       * processo filho a cada fork().
+       *
+       * @return A referência do contador.
+       */
+      static std::atomic<std::uint64_t>& forkGeneration() {
+         static std::atomic<std::uint64_t> generation { 1 };
+         static std::once_flag registered;
+         std::call_once(registered, [] {
+            pthread_atfork(nullptr, nullptr, [] {
+               generation.fetch_add(1, std::memory_order_relaxed);
+            });
+         });
+
+         return generation;
+      }
+
+      /**
+       * @brief Calcula o tamanho do segmento.
+       *
+       * @param slotCount O número de posições.
+       *
+       * @return O tamanho em bytes.
+       */
+      static std::size_t segmentSize(std::size_t slotCount) {
+         return sizeof(Header) + slotCount * sizeof(Slot);
+      }
+
+      /**
+       * @brief Monta a mensagem de um erro do sistema.
+       *
+       * @param message A descrição da operação.
+       *
+       * @return A mensagem com a descrição do errno.
+       */
+      static std::string systemError(std::string const& message) {
+         return message + ": " + std::strerror(errno);
+      }
+
+      /**
+       * @brief Mapeia um descritor de memória compartilhada e o fecha.
+       *
+       * @param descriptor O descritor.
+       * @param bytes O tamanho a ser mapeado.
+       */
+      void map(int descriptor, std::size_t bytes) {
+         void* address = mmap(
+           nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+         close(descriptor);
+
+         if (address == MAP_FAILED) {
+            throw std::runtime_error(
+              systemError("Could not map shared memory segment"));
+         }
+
+         mappedBytes = bytes;
+         header = static_cast<Header*>(address);
+         slots = reinterpret_cast<Slot*>(header + 1);
+      }
+
+      /**
+       * @brief Retorna a posição do processo atual, ocupando uma nova se
+       * necessário.
+       *
+       * @return A posição.
+       *
+       * @throws std::runtime_error se todas as posições estiverem ocupadas.
+       */
+      Slot& localSlot() {
+         auto generation = forkGeneration().load(std::memory_order_relaxed);
+         if (ownSlot != nullptr && ownGeneration == generation) {
+            return *ownSlot;
+         }
+
+         // Nunca passa de slotCount: um contador que desse a volta
+         // entregaria a posição 0, ainda em uso, a outro processo.
+         auto index = header->claimedSlots.load(std::memory_order_relaxed);
+         do {
+            if (index >= header->slotCount) {
+               throw std::runtime_error("No free shared memory slots");
+            }
+         } while (!header->claimedSlots.compare_exchange_weak(
+           index, index + 1, std::memory_order_relaxed));
+
+         ownSlot = &slots[index];
+         ownSlot->owner.store(getpid(), std::memory_order_relaxed);
+         ownGeneration = generation;
+
+         return *ownSlot;
+      }
+
+      /**
+       * @brief Lê o estado de uma posição, escrita apenas pelo processo
+       * atual.
+       *
+       * @param slot A posição.
+       *
+       * @return O estado atual.
+       */
+      StreamingStatistics<TYPE> loadOwned(Slot const& slot) const {
+         return StreamingStatistics<TYPE>::fromMoments(
+           slot.count.load(std::memory_order_relaxed),
+           slot.mean.load(std::memory_order_relaxed),
+           slot.m2.load(std::memory_order_relaxed),
+           slot.minValue.load(std::memory_order_relaxed),
+           slot.maxValue.load(std::memory_order_relaxed),
+           isPopulationData());
+      }
+
+      /**
+       * @brief Publica um novo estado de uma posição.
+       *
+       * @param slot A posição.
+       * @param state O novo estado.
+       */
+      static void store(Slot& slot, StreamingStatistics<TYPE> const& state) {
+         auto current = slot.sequence.load(std::memory_order_relaxed);
+         slot.sequence.store(current + 1, std::memory_order_relaxed);
+         std::atomic_thread_fence(std::memory_order_release);
+
+         slot.count.store(state.size(), std::memory_order_relaxed);
+         slot.mean.store(state.mean(), std::memory_order_relaxed);
+         slot.m2.store(
+           state.sumOfSquaredDeviations(), std::memory_order_relaxed);
+         slot.minValue.store(state.min(), std::memory_order_relaxed);
+         slot.maxValue.store(state.max(), std::memory_order_relaxed);
+
+         slot.sequence.store(current + 2, std::memory_order_release);
+      }
+
+      /**
+       * @brief Lê um estado consistente de uma posição a partir de outro
+       * processo.
+       *
+       * Se o escritor morreu no meio de uma escrita, a posição nunca volta a
+       * ficar consistente e é ignorada. A espera também termina depois de
+       * readTimeout, quando o escritor está parado no meio de uma escrita ou
+       * quando não é possível saber se ele existe (PID reutilizado ou de
+       * outro usuário).
+       *
+       * @param slot A posição.
+       *
+       * @return O estado lido, ou vazio se a posição foi ignorada.
+       */
+      std::optional<StreamingStatistics<TYPE>> loadShared(
+        Slot const& slot) const {
+         auto deadline = std::chrono::steady_clock::now() + readTimeout;
+
+         for (std::size_t attempt = 1;; ++attempt) {
+            auto before = slot.sequence.load(std::memory_order_acquire);
+
+            if (before % 2 == 0) {
+               auto state = loadOwned(slot);
+               std::atomic_thread_fence(std::memory_order_acquire);
+
+               if (slot.sequence.load(std::memory_order_relaxed) == before) {
+                  return state;
+               }
+            }
+
+            if (attempt % 1024 != 0) {
+               continue;
+            }
+
+            // EPERM não diz se o escritor existe; só ESRCH prova que morreu.
+            auto owner = slot.owner.load(std::memory_order_relaxed);
+            if (before % 2 != 0 && kill(owner, 0) != 0 && errno == ESRCH) {
+               return std::nullopt;
+            }
+
+            if (std::chrono::steady_clock::now() >= deadline) {
+               return std::nullopt;
+            }
+
+            std::this_thread::yield();
+         }
+      }
+
+      SharedMemoryAccumulator() = default;
+
+  public:
+      /**
+       * @brief Cria um segmento novo e o abre para escrita.
+       *
+       * @param name O nome do segmento, por exemplo "/metrics".
+       * @param slotCount O número máximo de processos escritores. O padrão é
+       * 64.
+       * @param populationData Define se os valores são de dados de população ou
+       * de uma amostra. O padrão é True.
+       *
+       * @return O acumulador.
+       *
+       * @throws std::runtime_error se o segmento já existir ou não puder ser
+       * criado.
+       */
+      static SharedMemoryAccumulator create(std::string const& name,
+        std::size_t slotCount = 64,
+        bool populationData = true) {
+         if (slotCount == 0
+           || slotCount > std::numeric_limits<std::uint32_t>::max()) {
+            throw std::runtime_error("Invalid shared memory slot count");
+         }
+
+         int descriptor
+           = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+         if (descriptor < 0) {
+            throw std::runtime_error(
+              systemError("Could not create shared memory segment"));
+         }
+
+         std::size_t bytes = segmentSize(slotCount);
+         if (ftruncate(descriptor, static_cast<off_t>(bytes)) != 0) {
+            auto message = systemError("Could not size shared memory segment");
+            close(descriptor);
+            shm_unlink(name.c_str());
+            throw std::runtime_error(message);
+         }
+
+         SharedMemoryAccumulator accumulator;
+         accumulator.map(descriptor, bytes);
+
+         Header* header = new (accumulator.header) Header {};
+         header->version = version;
+         header->typeSize = sizeof(TYPE);
+         header->floatingPoint = std::is_floating_point_v<TYPE>;
+         header->isSigned = std::is_signed_v<TYPE>;
+         header->populationData = populationData;
+         header->slotCount = static_cast<std::uint32_t>(slotCount);
+         for (std::size_t i = 0; i < slotCount; ++i) {
+            new (&accumulator.slots[i]) Slot {};
+         }
+
+         // A marca é escrita por último: quem abre o segmento só o usa depois
+         // de vê-la.
+         header->tag.store(tag, std::memory_order_release);
+
+         return accumulator;
+      }
+
+      /**
+       * @brief Abre um segmento existente, para escrita ou leitura.
+       *
+       * @param name O nome do segmento.
+       *
+       * @return O acumulador.
+       *
+       * @throws std::runtime_error se o segmento não existir, ainda não
+       * estiver inicializado ou tiver sido criado para outro tipo.
+       */
+      static SharedMemoryAccumulator open(std::string const& name) {
+         int descriptor = shm_open(name.c_str(), O_RDWR, 0);
+         if (descriptor < 0) {
+            throw std::runtime_error(
+              systemError("Could not open shared memory segment"));
+         }
+
+         struct stat status;
+         if (fstat(descriptor, &status) != 0
+           || static_cast<std::size_t>(status.st_size) < sizeof(Header)) {
+            close(descriptor);
+            throw std::runtime_error(
+              "Shared memory segment is not initialized");
+         }
+
+         SharedMemoryAccumulator accumulator;
+         accumulator.map(descriptor, status.st_size);
+
+         Header const& header = *accumulator.header;
+         if (header.tag.load(std::memory_order_acquire) != tag) {
+            throw std::runtime_error(
+              "Shared memory segment is not initialized");
+         }
+
+         if (header.version != version || header.typeSize != sizeof(TYPE)
+           || header.floatingPoint != std::is_floating_point_v<TYPE>
+           || header.isSigned != std::is_signed_v<TYPE>
+           || accumulator.mappedBytes < segmentSize(header.slotCount)) {
+            throw std::runtime_error(
+              "Shared memory segment has another layout");
+         }
+
+         return accumulator;
+      }
+
+      /**
+       * @brief Remove o nome de um segmento. Processos que já o abriram
+       * continuam usando-o até fechá-lo.
+       *
+       * @param name O nome do segmento.
+       *
+       * @return True se o nome foi removido e False caso contrário.
+       */
+      static bool remove(std::string const& name) {
+         return shm_unlink(name.c_str()) == 0;
+      }
+
+      SharedMemoryAccumulator(SharedMemoryAccumulator const&) = delete;
+      SharedMemoryAccumulator& operator=(SharedMemoryAccumulator const&)
+        = delete;
+
+      /**
+       * @brief Construtor de movimento.
+       *
+       * @param other O objeto movido.
+       */
+      SharedMemoryAccumulator(SharedMemoryAccumulator&& other) noexcept
+          : header(std::exchange(other.header, nullptr)),
+            slots(std::exchange(other.slots, nullptr)),
+            mappedBytes(std::exchange(other.mappedBytes, 0)),
+            ownSlot(std::exchange(other.ownSlot, nullptr)),
+            ownGeneration(other.ownGeneration) { }
+
+      /**
+       * @brief Atribuição por movimento.
+       *
+       * @param other O objeto movido.
+       *
+       * @return A referência do objeto de SharedMemoryAccumulator atual.
+       */
+      SharedMemoryAccumulator& operator=(
+        SharedMemoryAccumulator&& other) noexcept {
+         if (this != &other) {
+            if (header != nullptr) {
+               munmap(header, mappedBytes);
+            }
+
+            header = std::exchange(other.header, nullptr);
+            slots = std::exchange(other.slots, nullptr);
+            mappedBytes = std::exchange(other.mappedBytes, 0);
+            ownSlot = std::exchange(other.ownSlot, nullptr);
+            ownGeneration = other.ownGeneration;
+         }
+
+         return *this;
+      }
+
+      /**
+       * @brief Destrutor que desfaz o mapeamento. O segmento continua
+       * existindo até remove().
+       */
+      ~SharedMemoryAccumulator() {
+         if (header != nullptr) {
+            munmap(header, mappedBytes);
+         }
+      }
+
+      /**
+       * @brief Informa se os valores são de dados de população ou de amostra.
+       *
+       * @return True se os valores são de dados de população e False caso
+       * contrário.
+       */
+      bool isPopulationData() const { return header->populationData != 0; }
+
+      /**
+       * @brief Adiciona um valor na posição do processo atual.
+       *
+       * @param value O valor a ser adicionado.
+       *
+       * @return A referência do objeto de SharedMemoryAccumulator atual.
+       *
+       * @throws std::runtime_error se todas as posições estiverem ocupadas.
+       */
+      SharedMemoryAccumulator& push(TYPE value) {
+         Slot& slot = localSlot();
+         auto state = loadOwned(slot);
+         store(slot, state.push(value));
+
+         return *this;
+      }
+
+      /**
+       * @brief Adiciona um lote de valores na posição do processo atual, com
+       * uma única escrita na memória compartilhada.
+       *
+       * @param values Os valores a serem adicionados.
+       *
+       * @return A referência do objeto de SharedMemoryAccumulator atual.
+       *
+       * @throws std::runtime_error se todas as posições estiverem ocupadas.
+       */
+      SharedMemoryAccumulator& pushBatch(std::span<TYPE const> values) {
+         if (values.empty()) {
+            return *this;
+         }
+
+         Slot& slot = localSlot();
+         auto state = loadOwned(slot);
+         store(slot, state.pushBatch(values));
+
+         return *this;
+      }
+
+      /**
+       * @brief Junta as posições de todos os processos.
+       *
+       * Pode ser chamado enquanto outros processos escrevem. Cada posição é
+       * lida de forma consistente, mas posições diferentes podem refletir
+       * instantes ligeiramente diferentes. Posições que não ficam
+       * consistentes em readTimeout, como a de um escritor que morreu ou
+       * parou no meio de uma escrita, ficam de fora.
+       *
+       * @return O acumulado de todos os processos.
+       */
+      StreamingStatistics<TYPE> snapshot() const {
+         std::size_t skipped = 0;
+         return snapshot(skipped);
+      }
+
+      /**
+       * @brief Junta as posições de todos os processos e informa quantas
+       * ficaram de fora.
+       *
+       * @param skipped Recebe o número de posições ignoradas.
+       *
+       * @return O acumulado das posições lidas.
+       */
+      StreamingStatistics<TYPE> snapshot(std::size_t& skipped) const {
+         StreamingStatistics<TYPE> total(isPopulationData());
+         skipped = 0;
+
+         for (std::size_t i = 0; i < usedSlots(); ++i) {
+            if (auto state = loadShared(slots[i])) {
+               total.merge(*state);
+            } else {
+               ++skipped;
+            }
+         }
+
+         return total;
+      }
+
+      /**
+       * @brief Retorna o número máximo de processos escritores.
+       *
+       * @return O número de posições.
+       */
+      std::size_t slotCount() const { return header->slotCount; }
+
+      /**
+       * @brief Retorna o número de posições já ocupadas.
+       *
+       * @return O número de posições ocupadas.
+       */
+      std::size_t usedSlots() const {
+         return std::min<std::size_t>(
+           header->claimedSlots.load(std::memory_order_relaxed),
+           header->slotCount);
+      }
+   };
+}
+
+#endif /// SHARED_MEMORY_ACCUMULATOR_HPP_
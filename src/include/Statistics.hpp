@@ -12,12 +12,20 @@
 #ifndef STATISTICS_HPP_
 #define STATISTICS_HPP_
 
+#include "FrequencyTable.hpp"
+#include "ParallelSort.hpp"
+#include "Reduction.hpp"
+#include "Serialization.hpp"
+#include "StatisticsView.hpp"
 #include <algorithm>
+#include <atomic>
 #include <exception>
 #include <functional>
 #include <math.h>
+#include <memory>
+#include <span>
 #include <stdexcept>
-#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace stats {
@@ -26,6 +34,14 @@ namespace stats {
     * @brief Uma classe que fornece métodos de estatística como media, mediana e
     * moda.
     *
+    * Todas as consultas const podem ser chamadas por várias threads ao mesmo
+    * tempo sem travas. A cópia ordenada usada por mediana e quantis é criada
+    * sob demanda na primeira consulta e publicada uma única vez por uma troca
+    * atômica; se duas threads a criam ao mesmo tempo, a primeira publicação
+    * vence e a outra cópia é descartada. Os métodos que alteram o objeto
+    * (setValues, addValues e as configurações) exigem acesso exclusivo, como
+    * os contêineres da biblioteca padrão.
+    *
     * @tparam TYPE Define o tipo de dados. Deve ser um tipo numérico.
     */
    template <typename TYPE>
@@ -33,8 +49,17 @@ namespace stats {
       static_assert(std::is_arithmetic_v<TYPE>, "TYPE must be a numeric type");
 
   private:
+      static constexpr std::uint32_t tag = serializationTag("STAT");
+      static constexpr std::uint16_t version = 1;
+
       std::vector<TYPE> values;
       bool populationData;
+      ReductionMode reductionMode = ReductionMode::Serial;
+      std::shared_ptr<ThreadPool> pool;
+      std::shared_ptr<NumaExecutor> numaExecutor;
+      mutable std::atomic<std::shared_ptr<std::vector<TYPE> const>*> sorted {
+         nullptr
+      };
 
       /**
        * @brief Checa se os valores estão vazios.
@@ -47,6 +72,49 @@ namespace stats {
          }
       }
 
+      /**
+       * @brief Soma uma função dos valores no modo de redução atual.
+       *
+       * @tparam FUNCTION Tipo da função aplicada a cada valor.
+       *
+       * @param function A função.
+       *
+       * @return A soma.
+       */
+      template <typename FUNCTION>
+      double sumOf(FUNCTION const& function) const {
+         std::span<TYPE const> data(values);
+
+         return numaExecutor
+           ? reduceSum(data, function, reductionMode, *numaExecutor)
+           : reduceSum(data, function, reductionMode, pool);
+      }
+
+      /**
+       * @brief Descarta a cópia ordenada, depois de uma alteração dos
+       * valores.
+       */
+      void invalidate() {
+         delete sorted.exchange(nullptr, std::memory_order_acq_rel);
+      }
+
+      /**
+       * @brief Cria uma referência própria para a cópia ordenada de outro
+       * objeto.
+       *
+       * @param other O outro objeto.
+       *
+       * @return A nova referência, ou nulo se o outro não tiver cópia
+       * ordenada.
+       */
+      static std::shared_ptr<std::vector<TYPE> const>* shareSorted(
+        Statistics const& other) {
+         auto current = other.sorted.load(std::memory_order_acquire);
+         return current == nullptr
+           ? nullptr
+           : new std::shared_ptr<std::vector<TYPE> const>(*current);
+      }
+
   public:
       /**
        * @brief Construtor padrão.
@@ -86,6 +154,82 @@ namespace stats {
          setValues(list);
       }
 
+      /**
+       * @brief Construtor de cópia. A cópia ordenada, imutável, é
+       * compartilhada com o original.
+       *
+       * @param other O objeto copiado.
+       */
+      Statistics(Statistics const& other)
+          : values(other.values),
+            populationData(other.populationData),
+            reductionMode(other.reductionMode),
+            pool(other.pool),
+            numaExecutor(other.numaExecutor),
+            sorted(shareSorted(other)) { }
+
+      /**
+       * @brief Construtor de movimento.
+       *
+       * @param other O objeto movido.
+       */
+      Statistics(Statistics&& other) noexcept
+          : values(std::move(other.values)),
+            populationData(other.populationData),
+            reductionMode(other.reductionMode),
+            pool(std::move(other.pool)),
+            numaExecutor(std::move(other.numaExecutor)),
+            sorted(other.sorted.exchange(nullptr, std::memory_order_acq_rel)) {
+      }
+
+      /**
+       * @brief Destrutor.
+       */
+      ~Statistics() { invalidate(); }
+
+      /**
+       * @brief Atribuição por cópia.
+       *
+       * @param other O objeto copiado.
+       *
+       * @return A referência do objeto de Statistics atual.
+       */
+      Statistics& operator=(Statistics const& other) {
+         if (this != &other) {
+            values = other.values;
+            populationData = other.populationData;
+            reductionMode = other.reductionMode;
+            pool = other.pool;
+            numaExecutor = other.numaExecutor;
+            delete sorted.exchange(
+              shareSorted(other), std::memory_order_acq_rel);
+         }
+
+         return *this;
+      }
+
+      /**
+       * @brief Atribuição por movimento.
+       *
+       * @param other O objeto movido.
+       *
+       * @return A referência do objeto de Statistics atual.
+       */
+      Statistics& operator=(Statistics&& other) noexcept {
+         if (this != &other) {
+            values = std::move(other.values);
+            populationData = other.populationData;
+            reductionMode = other.reductionMode;
+            pool = std::move(other.pool);
+            numaExecutor = std::move(other.numaExecutor);
+            delete sorted.exchange(
+              other.sorted.exchange(nullptr, std::memory_order_acq_rel),
+              std::memory_order_acq_rel);
+         }
+
+         return *this;
+      }
+
       /**
        * @brief Obter os valores.
        *
@@ -93,6 +237,44 @@ namespace stats {
        */
       std::vector<TYPE> getValues() const { return values; }
 
+      /**
+       * @brief Obter os valores em ordem crescente.
+       *
+       * A cópia ordenada é criada na primeira chamada e reutilizada até a
+       * próxima alteração dos valores. Nos modos de redução paralelos a
+       * ordenação usa parallelSort no pool configurado. O ponteiro retornado
+       * continua válido mesmo se os valores forem alterados depois.
+       *
+       * @return Os valores ordenados.
+       */
+      std::shared_ptr<std::vector<TYPE> const> getSortedValues() const {
+         if (auto current = sorted.load(std::memory_order_acquire)) {
+            return *current;
+         }
+
+         auto copy = std::make_shared<std::vector<TYPE>>(values);
+         if (reductionMode == ReductionMode::Serial) {
+            std::sort(copy->begin(), copy->end());
+         } else {
+            parallelSort(std::span<TYPE>(*copy),
+              pool ? *pool : *ThreadPool::getDefault());
+         }
+
+         auto published
+           = new std::shared_ptr<std::vector<TYPE> const>(std::move(copy));
+         std::shared_ptr<std::vector<TYPE> const>* expected = nullptr;
+
+         if (sorted.compare_exchange_strong(expected,
+               published,
+               std::memory_order_acq_rel,
+               std::memory_order_acquire)) {
+            return *published;
+         }
+
+         delete published;
+         return *expected;
+      }
+
       /**
        * @brief Informa se os valores são de dados de população ou de amostra.
        *
@@ -115,6 +297,7 @@ namespace stats {
         typename = typename std::iterator_traits<ItInput>::iterator_category>
       Statistics& setValues(ItInput first, ItInput last) {
          values.assign(first, last);
+         invalidate();
 
          return *this;
       }
@@ -128,6 +311,26 @@ namespace stats {
        */
       Statistics& setValues(std::initializer_list<TYPE> list) {
          values.assign(list);
+         invalidate();
+
+         return *this;
+      }
+
+      /**
+       * @brief Adiciona um range de valores ao final dos valores atuais.
+       *
+       * @tparam ItInput Tipo do iterador de entrada.
+       *
+       * @param first Primeiro valor do range.
+       * @param last Ultimo valor do range.
+       *
+       * @return A referência do objeto de Statistics atual.
+       */
+      template <typename ItInput,
+        typename = typename std::iterator_traits<ItInput>::iterator_category>
+      Statistics& addValues(ItInput first, ItInput last) {
+         values.insert(values.end(), first, last);
+         invalidate();
 
          return *this;
       }
@@ -146,6 +349,67 @@ namespace stats {
          return *this;
       }
 
+      /**
+       * @brief Define como as somas de média e variância e as ordenações de
+       * mediana e quantis são calculadas.
+       *
+       * @param mode O modo de redução. Serial é o padrão; Parallel divide a
+       * soma entre as threads do pool; Deterministic também é paralelo, mas
+       * dá o mesmo resultado bit a bit para qualquer número de threads. Nos
+       * dois modos paralelos a ordenação usa parallelSort.
+       * @param pool O pool dos modos paralelos. Se for nulo, usa o pool padrão
+       * da biblioteca no momento de cada cálculo.
+       *
+       * @return A referência do objeto de Statistics atual.
+       */
+      Statistics& setReductionMode(
+        ReductionMode mode, std::shared_ptr<ThreadPool> pool = nullptr) {
+         reductionMode = mode;
+         this->pool = std::move(pool);
+
+         return *this;
+      }
+
+      /**
+       * @brief Retorna o modo de redução das somas.
+       *
+       * @return O modo de redução.
+       */
+      ReductionMode getReductionMode() const { return reductionMode; }
+
+      /**
+       * @brief Distribui os valores entre os nós NUMA e faz as somas
+       * paralelas seguirem a mesma distribuição.
+       *
+       * Com Partitioned, cada nó recebe uma fatia contígua dos valores e só as
+       * threads daquele nó a percorrem; os resultados são juntados primeiro
+       * por nó e depois entre os nós. Deve ser chamado depois de carregar os
+       * valores, já que uma realocação do vetor perde o posicionamento. Em
+       * máquinas com um único nó não faz nada.
+       *
+       * @param placement A forma de distribuição.
+       * @param executor O executor com um pool por nó. Se for nulo, usa o
+       * executor padrão da biblioteca.
+       *
+       * @return A referência do objeto de Statistics atual.
+       */
+      Statistics& setNumaPlacement(NumaPlacement placement,
+        std::shared_ptr<NumaExecutor> executor = nullptr) {
+         if (!executor) {
+            executor = NumaExecutor::getDefault();
+         }
+
+         if (!executor->getTopology().isNuma()) {
+            return *this;
+         }
+
+         executor->getTopology().place(
+           std::span<TYPE const>(values), placement, deterministicBlockSize);
+         numaExecutor = std::move(executor);
+
+         return *this;
+      }
+
       /**
        * @brief Retorna o tamanho do conjunto de dados.
        *
@@ -165,13 +429,7 @@ namespace stats {
        */
       double calculateSum(std::function<double(TYPE)> function
         = [](TYPE value) { return value; }) const {
-         double sum = 0;
-
-         for (auto const& value : values) {
-            sum += function(value);
-         }
-
-         return sum;
+         return sumOf(function);
       }
 
       /**
@@ -183,7 +441,10 @@ namespace stats {
        * estiver vazio retorna 0.
        */
       double mean() const {
-         return values.empty() ? 0 : calculateSum() / size();
+         return values.empty()
+           ? 0
+           : sumOf([](TYPE value) { return static_cast<double>(value); })
+             / size();
       }
 
       /**
@@ -195,21 +456,74 @@ namespace stats {
        *
        * @throws std::runtime_error se o conjunto de dados estiver vazio.
        */
-      double median() {
+      double median() const {
+         ensureNotEmpty();
+
+         auto ordered = getSortedValues();
+         auto const& data = *ordered;
+
+         std::size_t mid = data.size() / 2;
+         return data.size() % 2 == 0
+           ? static_cast<double>(data[mid - 1] + data[mid]) / 2
+           : static_cast<double>(data[mid]);
+      }
+
+      /**
+       * @brief Calcula o quantil p dos elementos do conjunto de dados.
+       *
+       * O quantil é interpolado linearmente entre os dois elementos mais
+       * próximos da posição p * (n - 1), de modo que quantile(0.5) coincide
+       * com a mediana.
+       *
+       * @param p A fração desejada, entre 0 e 1.
+       *
+       * @return O quantil p dos elementos do conjunto de dados.
+       *
+       * @throws std::runtime_error se o conjunto de dados estiver vazio ou se p
+       * estiver fora de [0, 1].
+       */
+      double quantile(double p) const {
          ensureNotEmpty();
+         if (p < 0 || p > 1) {
+            throw std::runtime_error("Quantile is not between 0 and 1");
+         }
+
+         auto ordered = getSortedValues();
+         auto const& data = *ordered;
+
+         double position = p * (data.size() - 1);
+         auto lower = static_cast<std::size_t>(position);
+         std::size_t upper = std::min(lower + 1, data.size() - 1);
+         double fraction = position - lower;
+
+         return data[lower]
+           + fraction * (static_cast<double>(data[upper]) - data[lower]);
+      }
+
+      /**
+       * @brief Conta a frequência de cada elemento do conjunto de dados.
+       *
+       * Nos modos de redução paralelos a contagem é particionada pelo hash e
+       * feita em paralelo no pool configurado.
+       *
+       * @return A tabela de frequências.
+       */
+      FrequencyTable<TYPE> frequencies() const {
+         std::span<TYPE const> data(values);
 
-         std::sort(values.begin(), values.end());
+         if (reductionMode == ReductionMode::Serial) {
+            return FrequencyTable<TYPE>(data);
+         }
 
-         int mid = values.size() / 2;
-         return values.size() % 2 == 0
-           ? static_cast<double>(values[mid - 1] + values[mid]) / 2
-           : static_cast<double>(values[mid]);
+         return FrequencyTable<TYPE>(
+           data, pool ? *pool : *ThreadPool::getDefault());
       }
 
       /**
        * @brief Calcula a moda dos elementos do conjunto de dados.
        *
-       * A moda é o elemento que mais se repete no conjunto de dados.
+       * A moda é o elemento que mais se repete no conjunto de dados. Em caso
+       * de empate, retorna o menor dos elementos empatados.
        *
        * @return A moda dos elementos do conjunto de dados.
        *
@@ -218,16 +532,21 @@ namespace stats {
       TYPE mode() const {
          ensureNotEmpty();
 
-         std::unordered_map<TYPE, int> frequency;
+         return frequencies().mode();
+      }
 
-         for (auto const& value : values) {
-            ++frequency[value];
-         }
+      /**
+       * @brief Conta os valores distintos do conjunto de dados.
+       *
+       * A contagem é exata. Para fluxos grandes demais para a memória, veja a
+       * estimativa da classe HyperLogLog.
+       *
+       * @return O número de valores distintos.
+       */
+      int distinctCount() const {
+         std::unordered_set<TYPE> distinct(values.begin(), values.end());
 
-         return std::max_element(frequency.begin(),
-           frequency.end(),
-           [](auto const& a, auto const& b) { return a.second < b.second; })
-           ->first;
+         return distinct.size();
       }
 
       /**
@@ -263,7 +582,7 @@ namespace stats {
          }
 
          double meanOfValues = mean();
-         double sumOfValues = calculateSum([meanOfValues](TYPE value) {
+         double sumOfValues = sumOf([meanOfValues](TYPE value) {
             return std::pow(value - meanOfValues, 2);
          });
 
@@ -292,6 +611,68 @@ namespace stats {
       double coefficientOfVariation() const {
          return mean() == 0 ? 0 : standardDeviation() / mean();
       }
+
+      /**
+       * @brief Serializa os valores em um formato binário compacto.
+       *
+       * Os valores são gravados alinhados, para que view() possa usá-los
+       * direto dos bytes. As configurações de redução e de NUMA não são
+       * gravadas.
+       *
+       * @return Os bytes do objeto.
+       */
+      std::vector<std::uint8_t> serialize() const {
+         ByteWriter writer;
+         writer.reserve(32 + values.size() * sizeof(TYPE));
+         writer.writeHeader(tag, version);
+         writer.writeType<TYPE>();
+         writer.write(static_cast<std::uint8_t>(populationData));
+         writer.writeAlignedArray(std::span<TYPE const>(values));
+
+         return writer.release();
+      }
+
+      /**
+       * @brief Reconstrói um objeto a partir dos bytes de serialize().
+       *
+       * @param bytes Os bytes do objeto.
+       *
+       * @return O objeto reconstruído.
+       *
+       * @throws std::runtime_error se os bytes forem inválidos.
+       */
+      static Statistics deserialize(std::span<std::uint8_t const> bytes) {
+         ByteReader reader(bytes);
+         reader.readHeader(tag, version);
+         reader.readType<TYPE>();
+
+         Statistics result(reader.read<std::uint8_t>() != 0);
+         result.values = reader.readAlignedArray<TYPE>();
+
+         return result;
+      }
+
+      /**
+       * @brief Cria uma visão sobre os bytes de serialize(), sem copiar os
+       * valores.
+       *
+       * @param bytes Os bytes do objeto, alinhados a alignof(TYPE) e válidos
+       * enquanto a visão for usada, por exemplo um arquivo mapeado.
+       *
+       * @return A visão.
+       *
+       * @throws std::runtime_error se os bytes forem inválidos ou não
+       * estiverem alinhados.
+       */
+      static StatisticsView<TYPE> view(std::span<std::uint8_t const> bytes) {
+         ByteReader reader(bytes);
+         reader.readHeader(tag, version);
+         reader.readType<TYPE>();
+
+         bool populationData = reader.read<std::uint8_t>() != 0;
+         return StatisticsView<TYPE>(
+           reader.readArrayView<TYPE>(), populationData);
+      }
    };
 }
 
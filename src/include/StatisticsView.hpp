@@ -0,0 +1,300 @@
+/**
+ * @file StatisticsView.hpp
+ * @author Pedro Lucas (pedrolucas.jsrn@gmail.com)
+ * @brief Arquivo de cabeçalho para a classe StatisticsView.
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef STATISTICS_VIEW_HPP_
+#define STATISTICS_VIEW_HPP_
+
+#include "FrequencyTable.hpp"
+#include "Reduction.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <unordered_set>
+#include <vector>
+
+namespace stats {
+   /**
+    * @class StatisticsView
+    * @brief Os métodos de estatística de Statistics sobre valores que não
+    * pertencem ao objeto, por exemplo uma MappedColumn.
+    *
+    * Média, variância, amplitude e frequências percorrem os valores onde
+    * eles estão, sem cópia. Mediana e quantis precisam reordenar os valores
+    * e trabalham sobre uma cópia temporária; para arquivos maiores que a
+    * memória, prefira QuantileSketch. Os valores devem continuar válidos
+    * enquanto a visão for usada.
+    *
+    * @tparam TYPE Define o tipo de dados. Deve ser um tipo numérico.
+    */
+   template <typename TYPE>
+   class StatisticsView {
+      static_assert(std::is_arithmetic_v<TYPE>, "TYPE must be a numeric type");
+
+  private:
+      std::span<TYPE const> values;
+      bool populationData;
+      ReductionMode reductionMode = ReductionMode::Serial;
+      std::shared_ptr<ThreadPool> pool;
+
+      /**
+       * @brief Checa se os valores estão vazios.
+       *
+       * @throws std::runtime_error se os valores estiverem vazios.
+       */
+      void ensureNotEmpty() const {
+         if (values.empty()) {
+            throw std::runtime_error("Values are empty");
+         }
+      }
+
+      /**
+       * @brief Soma uma função dos valores no modo de redução atual.
+       *
+       * @tparam FUNCTION Tipo da função aplicada a cada valor.
+       *
+       * @param function A função.
+       *
+       * @return A soma.
+       */
+      template <typename FUNCTION>
+      double sumOf(FUNCTION const& function) const {
+         return reduceSum(values, function, reductionMode, pool);
+      }
+
+  public:
+      /**
+       * @brief Construtor com os valores observados.
+       *
+       * @param values Os valores.
+       * @param populationData Define se os valores são de dados de população ou
+       * de uma amostra. O padrão é True.
+       */
+      StatisticsView(std::span<TYPE const> values = {},
+        bool populationData = true)
+          : values(values), populationData(populationData) { }
+
+      /**
+       * @brief Obter os valores observados.
+       *
+       * @return Os valores.
+       */
+      std::span<TYPE const> getValues() const { return values; }
+
+      /**
+       * @brief Informa se os valores são de dados de população ou de amostra.
+       *
+       * @return True se os valores são de dados de população e False caso
+       * contrário.
+       */
+      bool isPopulationData() const { return populationData; }
+
+      /**
+       * @brief Define se os valores são de dados de população ou de amostra.
+       *
+       * @param populationData Define se os valores são de dados de população ou
+       * de uma amostra. O padrão é True.
+       *
+       * @return A referência do objeto de StatisticsView atual.
+       */
+      StatisticsView& setPopulationData(bool populationData = true) {
+         this->populationData = populationData;
+
+         return *this;
+      }
+
+      /**
+       * @brief Define como as somas são calculadas, como em
+       * Statistics::setReductionMode.
+       *
+       * @param mode O modo de redução.
+       * @param pool O pool dos modos paralelos. Se for nulo, usa o pool padrão.
+       *
+       * @return A referência do objeto de StatisticsView atual.
+       */
+      StatisticsView& setReductionMode(
+        ReductionMode mode, std::shared_ptr<ThreadPool> pool = nullptr) {
+         reductionMode = mode;
+         this->pool = std::move(pool);
+
+         return *this;
+      }
+
+      /**
+       * @brief Retorna o tamanho do conjunto de dados.
+       *
+       * @return O tamanho do conjunto de dados.
+       */
+      std::size_t size() const { return values.size(); }
+
+      /**
+       * @brief Calcula a soma dos elementos com base em uma função.
+       *
+       * @param function Uma função que recebe um elemento e retorna o valor a
+       * ser somado. O padrão é o próprio elemento.
+       *
+       * @return A soma.
+       */
+      double calculateSum(std::function<double(TYPE)> function
+        = [](TYPE value) { return value; }) const {
+         return sumOf(function);
+      }
+
+      /**
+       * @brief Calcula a média dos elementos.
+       *
+       * @return A média. Se o conjunto estiver vazio retorna 0.
+       */
+      double mean() const {
+         return values.empty()
+           ? 0
+           : sumOf([](TYPE value) { return static_cast<double>(value); })
+             / size();
+      }
+
+      /**
+       * @brief Calcula a mediana dos elementos, sobre uma cópia dos valores.
+       *
+       * @return A mediana.
+       *
+       * @throws std::runtime_error se o conjunto de dados estiver vazio.
+       */
+      double median() const { return quantile(0.5); }
+
+      /**
+       * @brief Calcula o quantil p dos elementos, com a mesma interpolação de
+       * Statistics::quantile, sobre uma cópia dos valores.
+       *
+       * @param p A fração desejada, entre 0 e 1.
+       *
+       * @return O quantil p.
+       *
+       * @throws std::runtime_error se o conjunto de dados estiver vazio ou se p
+       * estiver fora de [0, 1].
+       */
+      double quantile(double p) const {
+         ensureNotEmpty();
+         if (p < 0 || p > 1) {
+            throw std::runtime_error("Quantile is not between 0 and 1");
+         }
+
+         std::vector<TYPE> copy(values.begin(), values.end());
+         double position = p * (copy.size() - 1);
+         std::size_t lower = static_cast<std::size_t>(position);
+         double fraction = position - lower;
+
+         std::nth_element(copy.begin(), copy.begin() + lower, copy.end());
+         double lowerValue = copy[lower];
+         if (fraction == 0) {
+            return lowerValue;
+         }
+
+         double upperValue
+           = *std::min_element(copy.begin() + lower + 1, copy.end());
+         return lowerValue + fraction * (upperValue - lowerValue);
+      }
+
+      /**
+       * @brief Conta a frequência de cada elemento. Nos modos de redução
+       * paralelos a contagem é feita em paralelo.
+       *
+       * @return A tabela de frequências.
+       */
+      FrequencyTable<TYPE> frequencies() const {
+         if (reductionMode == ReductionMode::Serial) {
+            return FrequencyTable<TYPE>(values);
+         }
+
+         return FrequencyTable<TYPE>(
+           values, pool ? *pool : *ThreadPool::getDefault());
+      }
+
+      /**
+       * @brief Calcula a moda dos elementos. Em caso de empate, retorna o
+       * menor dos elementos empatados.
+       *
+       * @return A moda.
+       *
+       * @throws std::runtime_error se o conjunto de dados estiver vazio.
+       */
+      TYPE mode() const {
+         ensureNotEmpty();
+
+         return frequencies().mode();
+      }
+
+      /**
+       * @brief Conta os valores distintos.
+       *
+       * @return O número de valores distintos.
+       */
+      std::size_t distinctCount() const {
+         std::unordered_set<TYPE> distinct(values.begin(), values.end());
+
+         return distinct.size();
+      }
+
+      /**
+       * @brief Calcula a amplitude dos elementos.
+       *
+       * @return A amplitude.
+       *
+       * @throws std::runtime_error se o conjunto de dados estiver vazio.
+       */
+      TYPE amplitude() const {
+         ensureNotEmpty();
+
+         auto [minValue, maxValue]
+           = std::minmax_element(values.begin(), values.end());
+         return *maxValue - *minValue;
+      }
+
+      /**
+       * @brief Calcula a variância dos elementos.
+       *
+       * @return A variância. Se o conjunto estiver vazio retorna 0.
+       */
+      double variance() const {
+         if (values.empty()) {
+            return 0;
+         }
+
+         double meanOfValues = mean();
+         double sumOfValues = sumOf([meanOfValues](TYPE value) {
+            return std::pow(value - meanOfValues, 2);
+         });
+
+         return populationData ? sumOfValues / size()
+                               : sumOfValues / (size() - 1);
+      }
+
+      /**
+       * @brief Calcula o desvio padrão dos elementos.
+       *
+       * @return O desvio padrão. Se o conjunto estiver vazio retorna 0.
+       */
+      double standardDeviation() const { return std::sqrt(variance()); }
+
+      /**
+       * @brief Calcula o coeficiente de variação dos elementos.
+       *
+       * @return O coeficiente de variação.
+       */
+      double coefficientOfVariation() const {
+         return mean() == 0 ? 0 : standardDeviation() / mean();
+      }
+   };
+}
+
+#endif /// STATISTICS_VIEW_HPP_
@@ -0,0 +1,522 @@
+/**
+ * @file StreamingStatistics.hpp
+ * @author Pedro Lucas (pedrolucas.jsrn@gmail.com)
+ * @brief Arquivo de cabeçalho para a classe StreamingStatistics.
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef STREAMING_STATISTICS_HPP_
+#define STREAMING_STATISTICS_HPP_
+
+#include "Serialization.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace stats {
+   /**
+    * @class StreamingStatistics
+    * @brief Uma classe que acumula contagem, média, variância, mínimo e máximo
+    * de um fluxo sem guardar os valores.
+    *
+    * A média e a soma dos quadrados dos desvios (M2) são atualizadas pelo
+    * método de Welford, e dois acumuladores são juntados pela fórmula de Chan,
+    * então o resultado não depende de como o fluxo foi dividido.
+    *
+    * @see https://en.wikipedia.org/wiki/Algorithms_for_calculating_variance
+    *
+    * @tparam TYPE Define o tipo de dados. Deve ser um tipo numérico.
+    */
+   template <typename TYPE>
+   class StreamingStatistics {
+      static_assert(std::is_arithmetic_v<TYPE>, "TYPE must be a numeric type");
+
+  private:
+      static constexpr std::size_t lanes = 4;
+      static constexpr std::uint32_t tag = serializationTag("SSTA");
+      static constexpr std::uint32_t manyTag = serializationTag("SSTM");
+      static constexpr std::uint16_t version = 1;
+
+      std::uint64_t count = 0;
+      double runningMean = 0;
+      double runningM2 = 0;
+      TYPE minValue = std::numeric_limits<TYPE>::max();
+      TYPE maxValue = std::numeric_limits<TYPE>::lowest();
+      bool populationData;
+
+      /**
+       * @brief Checa se o acumulador não está vazio.
+       *
+       * @throws std::runtime_error se nenhum valor foi acumulado.
+       */
+      void ensureNotEmpty() const {
+         if (count == 0) {
+            throw std::runtime_error("Values are empty");
+         }
+      }
+
+  public:
+      /**
+       * @brief Construtor padrão.
+       *
+       * @param populationData Define se os valores são de dados de população ou
+       * de uma amostra. O padrão é True.
+       */
+      StreamingStatistics(bool populationData = true)
+          : populationData(populationData) { }
+
+      /**
+       * @brief Construtor com um range de valores.
+       *
+       * @tparam ItInput Tipo do iterador de entrada.
+       *
+       * @param first Primeiro valor do range.
+       * @param last Ultimo valor do range.
+       * @param populationData Define se os valores são de dados de população ou
+       * de uma amostra. O padrão é True.
+       */
+      template <typename ItInput,
+        typename = typename std::iterator_traits<ItInput>::iterator_category>
+      StreamingStatistics(
+        ItInput first, ItInput last, bool populationData = true)
+          : populationData(populationData) {
+         pushBatch(first, last);
+      }
+
+      /**
+       * @brief Cria um acumulador a partir dos seus momentos.
+       *
+       * @param count O número de valores.
+       * @param mean A média dos valores.
+       * @param m2 A soma dos quadrados dos desvios em relação à média.
+       * @param minValue O menor valor.
+       * @param maxValue O maior valor.
+       * @param populationData Define se os valores são de dados de população ou
+       * de uma amostra. O padrão é True.
+       *
+       * @return O acumulador.
+       */
+      static StreamingStatistics fromMoments(std::uint64_t count,
+        double mean,
+        double m2,
+        TYPE minValue,
+        TYPE maxValue,
+        bool populationData = true) {
+         StreamingStatistics accumulator(populationData);
+         if (count > 0) {
+            accumulator.count = count;
+            accumulator.runningMean = mean;
+            accumulator.runningM2 = m2;
+            accumulator.minValue = minValue;
+            accumulator.maxValue = maxValue;
+         }
+
+         return accumulator;
+      }
+
+      /**
+       * @brief Adiciona um valor ao acumulador.
+       *
+       * @param value O valor a ser adicionado.
+       *
+       * @return A referência do objeto de StreamingStatistics atual.
+       */
+      StreamingStatistics& push(TYPE value) {
+         ++count;
+         double delta = value - runningMean;
+         runningMean += delta / count;
+         runningM2 += delta * (value - runningMean);
+         minValue = std::min(minValue, value);
+         maxValue = std::max(maxValue, value);
+
+         return *this;
+      }
+
+      /**
+       * @brief Adiciona um lote de valores ao acumulador.
+       *
+       * O lote é reduzido em duas passadas (soma e desvios) com acumuladores
+       * independentes por faixa, que o compilador consegue vetorizar, e o
+       * resultado é juntado ao acumulador pela fórmula de Chan.
+       *
+       * @param values Os valores a serem adicionados.
+       *
+       * @return A referência do objeto de StreamingStatistics atual.
+       */
+      StreamingStatistics& pushBatch(std::span<TYPE const> values) {
+         if (values.empty()) {
+            return *this;
+         }
+
+         std::size_t size = values.size();
+         std::size_t blocked = size - size % lanes;
+         std::array<double, lanes> sums {};
+         TYPE batchMin = values[0];
+         TYPE batchMax = values[0];
+
+         for (std::size_t i = 0; i < blocked; i += lanes) {
+            for (std::size_t lane = 0; lane < lanes; ++lane) {
+               sums[lane] += values[i + lane];
+            }
+         }
+
+         for (std::size_t i = blocked; i < size; ++i) {
+            sums[0] += values[i];
+         }
+
+         for (auto const& value : values) {
+            batchMin = std::min(batchMin, value);
+            batchMax = std::max(batchMax, value);
+         }
+
+         double batchMean = ((sums[0] + sums[1]) + (sums[2] + sums[3])) / size;
+         std::array<double, lanes> squares {};
+
+         for (std::size_t i = 0; i < blocked; i += lanes) {
+            for (std::size_t lane = 0; lane < lanes; ++lane) {
+               double delta = values[i + lane] - batchMean;
+               squares[lane] += delta * delta;
+            }
+         }
+
+         for (std::size_t i = blocked; i < size; ++i) {
+            double delta = values[i] - batchMean;
+            squares[0] += delta * delta;
+         }
+
+         double batchM2 = (squares[0] + squares[1]) + (squares[2] + squares[3]);
+
+         return merge(fromMoments(size, batchMean, batchM2, batchMin, batchMax));
+      }
+
+      /**
+       * @brief Adiciona um range de valores ao acumulador.
+       *
+       * @tparam ItInput Tipo do iterador de entrada.
+       *
+       * @param first Primeiro valor do range.
+       * @param last Ultimo valor do range.
+       *
+       * @return A referência do objeto de StreamingStatistics atual.
+       */
+      template <typename ItInput,
+        typename = typename std::iterator_traits<ItInput>::iterator_category>
+      StreamingStatistics& pushBatch(ItInput first, ItInput last) {
+         if constexpr (std::contiguous_iterator<ItInput>) {
+            return pushBatch(std::span<TYPE const>(first, last));
+         } else {
+            for (; first != last; ++first) {
+               push(*first);
+            }
+
+            return *this;
+         }
+      }
+
+      /**
+       * @brief Junta outro acumulador a este.
+       *
+       * @param other O acumulador a ser juntado.
+       *
+       * @return A referência do objeto de StreamingStatistics atual.
+       */
+      StreamingStatistics& merge(StreamingStatistics const& other) {
+         if (other.count == 0) {
+            return *this;
+         }
+
+         if (count == 0) {
+            count = other.count;
+            runningMean = other.runningMean;
+            runningM2 = other.runningM2;
+            minValue = other.minValue;
+            maxValue = other.maxValue;
+            return *this;
+         }
+
+         double total = static_cast<double>(count) + other.count;
+         double delta = other.runningMean - runningMean;
+         runningMean += delta * (other.count / total);
+         runningM2
+           += other.runningM2 + delta * delta * (count / total) * other.count;
+         count += other.count;
+         minValue = std::min(minValue, other.minValue);
+         maxValue = std::max(maxValue, other.maxValue);
+
+         return *this;
+      }
+
+      /**
+       * @brief Remove todos os valores acumulados.
+       *
+       * @return A referência do objeto de StreamingStatistics atual.
+       */
+      StreamingStatistics& clear() {
+         *this = StreamingStatistics(populationData);
+
+         return *this;
+      }
+
+      /**
+       * @brief Informa se os valores são de dados de população ou de amostra.
+       *
+       * @return True se os valores são de dados de população e False caso
+       * contrário.
+       */
+      bool isPopulationData() const { return populationData; }
+
+      /**
+       * @brief Define se os valores são de dados de população ou de amostra.
+       *
+       * @param populationData Define se os valores são de dados de população ou
+       * de uma amostra. O padrão é True.
+       *
+       * @return A referência do objeto de StreamingStatistics atual.
+       */
+      StreamingStatistics& setPopulationData(bool populationData = true) {
+         this->populationData = populationData;
+
+         return *this;
+      }
+
+      /**
+       * @brief Retorna o número de valores acumulados.
+       *
+       * @return O número de valores.
+       */
+      std::uint64_t size() const { return count; }
+
+      /**
+       * @brief Calcula a soma dos valores acumulados.
+       *
+       * @return A soma dos valores.
+       */
+      double sum() const { return runningMean * count; }
+
+      /**
+       * @brief Calcula a média dos valores acumulados.
+       *
+       * @return A média dos valores. Se o acumulador estiver vazio retorna 0.
+       */
+      double mean() const { return runningMean; }
+
+      /**
+       * @brief Retorna a soma dos quadrados dos desvios em relação à média.
+       *
+       * @return O momento M2.
+       */
+      double sumOfSquaredDeviations() const { return runningM2; }
+
+      /**
+       * @brief Calcula a variância dos valores acumulados.
+       *
+       * @return A variância dos valores. Se o acumulador estiver vazio retorna
+       * 0.
+       */
+      double variance() const {
+         if (count == 0 || (!populationData && count == 1)) {
+            return 0;
+         }
+
+         return populationData ? runningM2 / count : runningM2 / (count - 1);
+      }
+
+      /**
+       * @brief Calcula o desvio padrão dos valores acumulados.
+       *
+       * @return O desvio padrão dos valores. Se o acumulador estiver vazio
+       * retorna 0.
+       */
+      double standardDeviation() const { return std::sqrt(variance()); }
+
+      /**
+       * @brief Calcula o coeficiente de variação dos valores acumulados.
+       *
+       * @return O coeficiente de variação dos valores.
+       */
+      double coefficientOfVariation() const {
+         return mean() == 0 ? 0 : standardDeviation() / mean();
+      }
+
+      /**
+       * @brief Retorna o menor valor acumulado.
+       *
+       * @return O menor valor.
+       *
+       * @throws std::runtime_error se nenhum valor foi acumulado.
+       */
+      TYPE min() const {
+         ensureNotEmpty();
+         return minValue;
+      }
+
+      /**
+       * @brief Retorna o maior valor acumulado.
+       *
+       * @return O maior valor.
+       *
+       * @throws std::runtime_error se nenhum valor foi acumulado.
+       */
+      TYPE max() const {
+         ensureNotEmpty();
+         return maxValue;
+      }
+
+      /**
+       * @brief Calcula a amplitude dos valores acumulados.
+       *
+       * @return A diferença entre o maior e o menor valor.
+       *
+       * @throws std::runtime_error se nenhum valor foi acumulado.
+       */
+      TYPE amplitude() const {
+         ensureNotEmpty();
+         return maxValue - minValue;
+      }
+
+      /**
+       * @brief Serializa o acumulador em um formato binário compacto.
+       *
+       * @return Os bytes do acumulador.
+       */
+      std::vector<std::uint8_t> serialize() const {
+         ByteWriter writer;
+         writer.writeHeader(tag, version);
+         writer.writeType<TYPE>();
+         writer.write(static_cast<std::uint8_t>(populationData));
+         writer.write(count);
+         writer.write(runningMean);
+         writer.write(runningM2);
+         writer.write(minValue);
+         writer.write(maxValue);
+
+         return writer.release();
+      }
+
+      /**
+       * @brief Reconstrói um acumulador a partir dos bytes de serialize().
+       *
+       * @param bytes Os bytes do acumulador.
+       *
+       * @return O acumulador reconstruído.
+       *
+       * @throws std::runtime_error se os bytes forem inválidos.
+       */
+      static StreamingStatistics deserialize(
+        std::span<std::uint8_t const> bytes) {
+         ByteReader reader(bytes);
+         reader.readHeader(tag, version);
+         reader.readType<TYPE>();
+
+         StreamingStatistics accumulator(reader.read<std::uint8_t>() != 0);
+         accumulator.count = reader.read<std::uint64_t>();
+         accumulator.runningMean = reader.read<double>();
+         accumulator.runningM2 = reader.read<double>();
+         accumulator.minValue = reader.read<TYPE>();
+         accumulator.maxValue = reader.read<TYPE>();
+
+         return accumulator;
+      }
+
+      /**
+       * @brief Serializa muitos acumuladores de uma vez, por exemplo um por
+       * série.
+       *
+       * Os campos são gravados em colunas contíguas (todas as contagens,
+       * depois todas as médias e assim por diante), então a escrita e a
+       * leitura são cópias de memória em bloco.
+       *
+       * @param accumulators Os acumuladores.
+       *
+       * @return Os bytes dos acumuladores.
+       */
+      static std::vector<std::uint8_t> serializeMany(
+        std::span<StreamingStatistics const> accumulators) {
+         std::size_t size = accumulators.size();
+         std::vector<std::uint64_t> counts(size);
+         std::vector<double> means(size);
+         std::vector<double> m2s(size);
+         std::vector<TYPE> minimums(size);
+         std::vector<TYPE> maximums(size);
+         std::vector<std::uint8_t> population(size);
+
+         for (std::size_t i = 0; i < size; ++i) {
+            counts[i] = accumulators[i].count;
+            means[i] = accumulators[i].runningMean;
+            m2s[i] = accumulators[i].runningM2;
+            minimums[i] = accumulators[i].minValue;
+            maximums[i] = accumulators[i].maxValue;
+            population[i] = accumulators[i].populationData;
+         }
+
+         ByteWriter writer;
+         writer.reserve(128 + size * (25 + 2 * sizeof(TYPE)));
+         writer.writeHeader(manyTag, version);
+         writer.writeType<TYPE>();
+         writer.writeAlignedArray(std::span<std::uint64_t const>(counts));
+         writer.writeAlignedArray(std::span<double const>(means));
+         writer.writeAlignedArray(std::span<double const>(m2s));
+         writer.writeAlignedArray(std::span<TYPE const>(minimums));
+         writer.writeAlignedArray(std::span<TYPE const>(maximums));
+         writer.writeAlignedArray(std::span<std::uint8_t const>(population));
+
+         return writer.release();
+      }
+
+      /**
+       * @brief Reconstrói os acumuladores de serializeMany().
+       *
+       * @param bytes Os bytes dos acumuladores.
+       *
+       * @return Os acumuladores, na ordem original.
+       *
+       * @throws std::runtime_error se os bytes forem inválidos.
+       */
+      static std::vector<StreamingStatistics> deserializeMany(
+        std::span<std::uint8_t const> bytes) {
+         ByteReader reader(bytes);
+         reader.readHeader(manyTag, version);
+         reader.readType<TYPE>();
+
+         auto counts = reader.readAlignedArray<std::uint64_t>();
+         auto means = reader.readAlignedArray<double>();
+         auto m2s = reader.readAlignedArray<double>();
+         auto minimums = reader.readAlignedArray<TYPE>();
+         auto maximums = reader.readAlignedArray<TYPE>();
+         auto population = reader.readAlignedArray<std::uint8_t>();
+
+         std::size_t size = counts.size();
+         if (means.size() != size || m2s.size() != size
+           || minimums.size() != size || maximums.size() != size
+           || population.size() != size) {
+            throw std::runtime_error("Serialized columns have wrong size");
+         }
+
+         std::vector<StreamingStatistics> accumulators(size);
+         for (std::size_t i = 0; i < size; ++i) {
+            auto& accumulator = accumulators[i];
+            accumulator.count = counts[i];
+            accumulator.runningMean = means[i];
+            accumulator.runningM2 = m2s[i];
+            accumulator.minValue = minimums[i];
+            accumulator.maxValue = maximums[i];
+            accumulator.populationData = population[i] != 0;
+         }
+
+         return accumulators;
+      }
+   };
+}
+
+#endif /// STREAMING_STATISTICS_HPP_
@@ -0,0 +1,565 @@
+/**
+ * @file ThreadPool.hpp
+ * @author Pedro Lucas (pedrolucas.jsrn@gmail.com)
+ * @brief Arquivo de cabeçalho para as classes ThreadPool e TaskGroup.
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef THREAD_POOL_HPP_
+#define THREAD_POOL_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace stats {
+   /**
+    * @class ThreadPool
+    * @brief Um escalonador de tarefas com roubo de trabalho, compartilhado
+    * pelos caminhos paralelos da biblioteca.
+    *
+    * Cada thread trabalhadora tem a sua própria fila dupla: tarefas criadas
+    * por ela entram e saem pelo fim da fila (LIFO, boa localidade) e as
+    * threads ociosas roubam do início das filas das outras (FIFO, tarefas
+    * maiores). Quem espera um TaskGroup executa tarefas pendentes enquanto
+    * espera, então chamadas paralelas aninhadas reutilizam as mesmas threads
+    * em vez de criar novas.
+    *
+    * A biblioteca usa o pool padrão (getDefault()), que pode ser trocado por
+    * setDefault(), ou um pool passado explicitamente. O chamador também pode
+    * enviar as suas próprias tarefas para o mesmo pool.
+    */
+   class ThreadPool {
+  private:
+      static constexpr std::size_t cacheLineSize = 64;
+
+      /**
+       * @brief A fila de tarefas de uma thread trabalhadora.
+       */
+      struct alignas(cacheLineSize) Worker {
+         std::mutex mutex;
+         std::deque<std::function<void()>> tasks;
+      };
+
+      /**
+       * @brief Identifica o pool e a posição da thread atual, se ela for uma
+       * trabalhadora.
+       */
+      struct CurrentWorker {
+         ThreadPool const* pool = nullptr;
+         std::size_t index = 0;
+      };
+
+      std::vector<std::unique_ptr<Worker>> workers;
+      std::vector<std::thread> threads;
+      std::atomic<std::size_t> queuedTasks { 0 };
+      std::atomic<std::size_t> nextWorker { 0 };
+      std::atomic<bool> stopping { false };
+      std::mutex sleepMutex;
+      std::condition_variable wakeUp;
+
+      /**
+       * @brief Retorna a identificação da thread atual.
+       *
+       * @return A referência da identificação.
+       */
+      static CurrentWorker& currentWorker() {
+         thread_local CurrentWorker current;
+         return current;
+      }
+
+      /**
+       * @brief Retorna a referência do pool padrão.
+       *
+       * @return O ponteiro compartilhado do pool padrão.
+       */
+      static std::shared_ptr<ThreadPool>& defaultPool() {
+         static std::shared_ptr<ThreadPool> pool;
+         return pool;
+      }
+
+      /**
+       * @brief Retorna o mutex que protege o pool padrão.
+       *
+       * @return O mutex.
+       */
+      static std::mutex& defaultMutex() {
+         static std::mutex mutex;
+         return mutex;
+      }
+
+      /**
+       * @brief Fixa a thread atual em um processador.
+       *
+       * @param cpu O índice do processador.
+       */
+      static void pinCurrentThread(std::size_t cpu) {
+#if defined(__linux__)
+         cpu_set_t set;
+         CPU_ZERO(&set);
+         CPU_SET(cpu % CPU_SETSIZE, &set);
+         pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+         (void)cpu;
+#endif
+      }
+
+      /**
+       * @brief Retira uma tarefa do fim da própria fila ou rouba do início da
+       * fila de outra trabalhadora.
+       *
+       * @param self A posição da thread atual, ou workers.size() para threads
+       * externas.
+       * @param task Destino da tarefa encontrada.
+       *
+       * @return True se uma tarefa foi encontrada e False caso contrário.
+       */
+      bool findTask(std::size_t self, std::function<void()>& task) {
+         if (self < workers.size()) {
+            Worker& own = *workers[self];
+            std::lock_guard lock(own.mutex);
+
+            if (!own.tasks.empty()) {
+               task = std::move(own.tasks.back());
+               own.tasks.pop_back();
+               queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+               return true;
+            }
+         }
+
+         for (std::size_t offset = 1; offset <= workers.size(); ++offset) {
+            Worker& victim = *workers[(self + offset) % workers.size()];
+            std::unique_lock lock(victim.mutex, std::try_to_lock);
+
+            if (lock.owns_lock() && !victim.tasks.empty()) {
+               task = std::move(victim.tasks.front());
+               victim.tasks.pop_front();
+               queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+               return true;
+            }
+         }
+
+         return false;
+      }
+
+      /**
+       * @brief Laço de uma thread trabalhadora.
+       *
+       * @param index A posição da trabalhadora.
+       */
+      void run(std::size_t index) {
+         currentWorker() = { this, index };
+         std::function<void()> task;
+
+         while (true) {
+            if (findTask(index, task)) {
+               task();
+               task = nullptr;
+               continue;
+            }
+
+            std::unique_lock lock(sleepMutex);
+            wakeUp.wait(lock, [this] {
+               return stopping.load(std::memory_order_relaxed)
+                 || queuedTasks.load(std::memory_order_relaxed) > 0;
+            });
+
+            if (stopping.load(std::memory_order_relaxed)
+              && queuedTasks.load(std::memory_order_relaxed) == 0) {
+               return;
+            }
+         }
+      }
+
+      /**
+       * @brief Inicia as threads trabalhadoras.
+       *
+       * @param threadCount O número de threads.
+       * @param cpus Os processadores em que cada thread é fixada, em ordem.
+       * Vazio para não fixar as threads.
+       */
+      void start(std::size_t threadCount, std::vector<std::size_t> cpus) {
+         workers.reserve(threadCount);
+         for (std::size_t i = 0; i < threadCount; ++i) {
+            workers.push_back(std::make_unique<Worker>());
+         }
+
+         threads.reserve(threadCount);
+         for (std::size_t i = 0; i < threadCount; ++i) {
+            threads.emplace_back([this, i, cpus] {
+               if (!cpus.empty()) {
+                  pinCurrentThread(cpus[i % cpus.size()]);
+               }
+
+               run(i);
+            });
+         }
+      }
+
+  public:
+      /**
+       * @brief Construtor que inicia as threads trabalhadoras.
+       *
+       * @param threadCount O número de threads. Com 0, as tarefas rodam nas
+       * threads que as esperam. O padrão é o número de processadores.
+       * @param pinThreads Define se cada thread é fixada em um processador. O
+       * padrão é False.
+       */
+      ThreadPool(std::size_t threadCount = std::thread::hardware_concurrency(),
+        bool pinThreads = false) {
+         std::vector<std::size_t> cpus;
+         if (pinThreads) {
+            for (std::size_t i = 0; i < threadCount; ++i) {
+               cpus.push_back(i);
+            }
+         }
+
+         start(threadCount, std::move(cpus));
+      }
+
+      /**
+       * @brief Construtor que inicia uma thread fixada em cada processador da
+       * lista, por exemplo os processadores de um nó NUMA.
+       *
+       * @param cpus Os processadores.
+       */
+      explicit ThreadPool(std::vector<std::size_t> const& cpus) {
+         start(cpus.size(), cpus);
+      }
+
+      ThreadPool(ThreadPool const&) = delete;
+      ThreadPool& operator=(ThreadPool const&) = delete;
+
+      /**
+       * @brief Destrutor que executa as tarefas pendentes e encerra as
+       * threads.
+       */
+      ~ThreadPool() {
+         {
+            std::lock_guard lock(sleepMutex);
+            stopping.store(true, std::memory_order_relaxed);
+         }
+
+         wakeUp.notify_all();
+         for (auto& thread : threads) {
+            thread.join();
+         }
+      }
+
+      /**
+       * @brief Retorna o pool padrão da biblioteca, criando-o na primeira
+       * chamada com uma thread por processador.
+       *
+       * @return O pool padrão.
+       */
+      static std::shared_ptr<ThreadPool> getDefault() {
+         std::lock_guard lock(defaultMutex());
+         auto& pool = defaultPool();
+         if (!pool) {
+            pool = std::make_shared<ThreadPool>();
+         }
+
+         return pool;
+      }
+
+      /**
+       * @brief Troca o pool padrão da biblioteca.
+       *
+       * Operações já em andamento terminam no pool antigo.
+       *
+       * @param pool O novo pool padrão.
+       */
+      static void setDefault(std::shared_ptr<ThreadPool> pool) {
+         std::lock_guard lock(defaultMutex());
+         defaultPool() = std::move(pool);
+      }
+
+      /**
+       * @brief Retorna o número de threads trabalhadoras.
+       *
+       * @return O número de threads.
+       */
+      std::size_t size() const { return threads.size(); }
+
+      /**
+       * @brief Retorna o número de threads que podem executar tarefas ao mesmo
+       * tempo, contando a thread que espera.
+       *
+       * @return O grau de paralelismo.
+       */
+      std::size_t concurrency() const {
+         return std::max<std::size_t>(1, threads.size());
+      }
+
+      /**
+       * @brief Informa se a thread atual é uma trabalhadora deste pool.
+       *
+       * @return True se a thread atual pertence ao pool e False caso
+       * contrário.
+       */
+      bool isWorkerThread() const { return currentWorker().pool == this; }
+
+      /**
+       * @brief Envia uma tarefa para o pool.
+       *
+       * Tarefas enviadas por uma trabalhadora entram na fila dela; as demais
+       * são distribuídas em rodízio. Sem threads trabalhadoras, a tarefa
+       * roda imediatamente na thread atual.
+       *
+       * @param task A tarefa.
+       */
+      void submit(std::function<void()> task) {
+         if (workers.empty()) {
+            task();
+            return;
+         }
+
+         std::size_t target = isWorkerThread()
+           ? currentWorker().index
+           : nextWorker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+
+         // O contador sobe antes da inserção para nunca ficar abaixo do
+         // número real de tarefas nas filas.
+         {
+            std::lock_guard lock(sleepMutex);
+            queuedTasks.fetch_add(1, std::memory_order_relaxed);
+         }
+
+         {
+            std::lock_guard lock(workers[target]->mutex);
+            workers[target]->tasks.push_back(std::move(task));
+         }
+
+         wakeUp.notify_one();
+      }
+
+      /**
+       * @brief Executa uma tarefa pendente na thread atual, se houver.
+       *
+       * @return True se alguma tarefa foi executada e False caso contrário.
+       */
+      bool runPendingTask() {
+         std::function<void()> task;
+         std::size_t self
+           = isWorkerThread() ? currentWorker().index : workers.size();
+
+         if (workers.empty() || !findTask(self, task)) {
+            return false;
+         }
+
+         task();
+         return true;
+      }
+   };
+
+   /**
+    * @class TaskGroup
+    * @brief Um grupo de tarefas que podem ser esperadas juntas (fork-join).
+    *
+    * A thread que chama wait() executa tarefas do pool enquanto o grupo não
+    * termina. A primeira exceção lançada por uma tarefa é relançada por
+    * wait().
+    */
+   class TaskGroup {
+  private:
+      ThreadPool& pool;
+      std::atomic<std::size_t> pending { 0 };
+      std::mutex errorMutex;
+      std::exception_ptr error;
+
+  public:
+      /**
+       * @brief Construtor com o pool que executa as tarefas.
+       *
+       * @param pool O pool.
+       */
+      TaskGroup(ThreadPool& pool) : pool(pool) { }
+
+      TaskGroup(TaskGroup const&) = delete;
+      TaskGroup& operator=(TaskGroup const&) = delete;
+
+      /**
+       * @brief Destrutor que espera as tarefas pendentes.
+       */
+      ~TaskGroup() {
+         while (pending.load(std::memory_order_acquire) > 0) {
+            if (!pool.runPendingTask()) {
+               std::this_thread::yield();
+            }
+         }
+      }
+
+      /**
+       * @brief Envia uma tarefa do grupo para o pool.
+       *
+       * @param task A tarefa.
+       */
+      void run(std::function<void()> task) {
+         pending.fetch_add(1, std::memory_order_relaxed);
+
+         pool.submit([this, task = std::move(task)] {
+            try {
+               task();
+            } catch (...) {
+               std::lock_guard lock(errorMutex);
+               if (!error) {
+                  error = std::current_exception();
+               }
+            }
+
+            pending.fetch_sub(1, std::memory_order_release);
+         });
+      }
+
+      /**
+       * @brief Espera todas as tarefas do grupo, executando tarefas do pool
+       * enquanto isso.
+       *
+       * @throws A primeira exceção lançada por uma tarefa do grupo.
+       */
+      void wait() {
+         while (pending.load(std::memory_order_acquire) > 0) {
+            if (!pool.runPendingTask()) {
+               std::this_thread::yield();
+            }
+         }
+
+         if (error) {
+            std::rethrow_exception(std::exchange(error, nullptr));
+         }
+      }
+   };
+
+   /**
+    * @brief Calcula em quantas partes dividir um intervalo: até quatro por
+    * thread, cada uma com pelo menos `grain` índices.
+    *
+    * @param pool O pool que executa as partes.
+    * @param length O tamanho do intervalo.
+    * @param grain O tamanho mínimo de cada parte.
+    *
+    * @return O número de partes, pelo menos 1.
+    */
+   inline std::size_t partitionCount(
+     ThreadPool const& pool, std::size_t length, std::size_t grain) {
+      std::size_t byGrain = length / std::max<std::size_t>(grain, 1);
+      return std::clamp<std::size_t>(byGrain, 1, pool.concurrency() * 4);
+   }
+
+   /**
+    * @brief Executa uma função sobre os sub-intervalos de [begin, end) em
+    * paralelo.
+    *
+    * O intervalo é dividido em até quatro partes por thread, cada uma com
+    * pelo menos `grain` índices. Uma das partes roda na thread atual.
+    *
+    * @tparam FUNCTION Tipo da função, chamada como body(first, last).
+    *
+    * @param pool O pool que executa as partes.
+    * @param begin O início do intervalo.
+    * @param end O fim do intervalo (exclusivo).
+    * @param grain O tamanho mínimo de cada parte.
+    * @param body A função.
+    */
+   template <typename FUNCTION>
+   void parallelFor(ThreadPool& pool,
+     std::size_t begin,
+     std::size_t end,
+     std::size_t grain,
+     FUNCTION&& body) {
+      if (begin >= end) {
+         return;
+      }
+
+      std::size_t length = end - begin;
+      std::size_t parts = partitionCount(pool, length, grain);
+
+      if (parts <= 1) {
+         body(begin, end);
+         return;
+      }
+
+      TaskGroup group(pool);
+      for (std::size_t part = 1; part < parts; ++part) {
+         std::size_t first = begin + length * part / parts;
+         std::size_t last = begin + length * (part + 1) / parts;
+         group.run([&body, first, last] { body(first, last); });
+      }
+
+      body(begin, begin + length / parts);
+      group.wait();
+   }
+
+   /**
+    * @brief Reduz os sub-intervalos de [begin, end) em paralelo.
+    *
+    * Cada parte é reduzida por `map` e os resultados parciais são combinados
+    * na ordem das partes, da esquerda para a direita.
+    *
+    * @tparam VALUE Tipo do resultado.
+    * @tparam MAP Tipo da função que reduz uma parte, chamada como
+    * map(first, last).
+    * @tparam COMBINE Tipo da função que junta dois resultados.
+    *
+    * @param pool O pool que executa as partes.
+    * @param begin O início do intervalo.
+    * @param end O fim do intervalo (exclusivo).
+    * @param grain O tamanho mínimo de cada parte.
+    * @param identity O resultado de um intervalo vazio.
+    * @param map A função que reduz uma parte.
+    * @param combine A função que junta dois resultados.
+    *
+    * @return O resultado da redução.
+    */
+   template <typename VALUE, typename MAP, typename COMBINE>
+   VALUE parallelReduce(ThreadPool& pool,
+     std::size_t begin,
+     std::size_t end,
+     std::size_t grain,
+     VALUE identity,
+     MAP&& map,
+     COMBINE&& combine) {
+      if (begin >= end) {
+         return identity;
+      }
+
+      std::size_t length = end - begin;
+      std::size_t parts = partitionCount(pool, length, grain);
+      std::vector<VALUE> partials(parts, identity);
+
+      parallelFor(pool, 0, parts, 1, [&](std::size_t first, std::size_t last) {
+         for (std::size_t part = first; part < last; ++part) {
+            partials[part] = map(begin + length * part / parts,
+              begin + length * (part + 1) / parts);
+         }
+      });
+
+      VALUE result = identity;
+      for (auto const& partial : partials) {
+         result = combine(result, partial);
+      }
+
+      return result;
+   }
+}
+
+#endif /// THREAD_POOL_HPP_
@@ -0,0 +1,449 @@
+/**
+ * @file TimeRollup.hpp
+ * @author Pedro Lucas (pedrolucas.jsrn@gmail.com)
+ * @brief Arquivo de cabeçalho para a classe TimeRollup.
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef TIME_ROLLUP_HPP_
+#define TIME_ROLLUP_HPP_
+
+#include "Generator.hpp"
+#include "StreamingStatistics.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace stats {
+   /**
+    * @class TimeRollup
+    * @brief Agrega uma série temporal em baldes por intervalo (por exemplo
+    * 1 s), consolidados em camadas mais grossas (por exemplo 1 min e 1 h).
+    *
+    * Cada camada é um anel de baldes, e cada balde é um acumulador mesclável.
+    * Os valores entram só no balde aberto da camada mais fina. Quando o tempo
+    * passa do fim de um balde aberto, ele é mesclado uma única vez no balde
+    * aberto da camada seguinte. Assim a virada de intervalo custa uma fusão
+    * por camada, mesmo depois de um salto longo no tempo. Um balde velho do
+    * anel só é zerado quando é reutilizado.
+    *
+    * Uma consulta como "últimos 5 minutos" junta os baldes que cobrem o
+    * intervalo, usando a camada mais grossa possível: os segundos do minuto
+    * atual, os minutos da hora atual e as horas anteriores. Ela custa algumas
+    * dezenas de fusões, sem reler os valores.
+    *
+    * Valores atrasados entram no balde do seu instante em cada camada que
+    * ainda o guarda. Valores mais antigos que todas as camadas são
+    * descartados e contados em dropped().
+    *
+    * A classe não é segura para várias threads; o chamador deve serializar o
+    * acesso, como com os acumuladores que ela guarda.
+    *
+    * @tparam TYPE Define o tipo de dados. Deve ser um tipo numérico.
+    * @tparam ACCUMULATOR O acumulador de cada balde. Deve ser copiável e ter
+    * `push(TYPE)` e `merge(ACCUMULATOR const&)`, como StreamingStatistics,
+    * QuantileSketch, HeavyHitters ou HyperLogLog.
+    */
+   template <typename TYPE, typename ACCUMULATOR = StreamingStatistics<TYPE>>
+   class TimeRollup {
+      static_assert(std::is_arithmetic_v<TYPE>, "TYPE must be a numeric type");
+
+  public:
+      using Duration = std::chrono::milliseconds;
+
+      /**
+       * @brief Uma camada: a duração de cada balde e quantos baldes guardar.
+       */
+      struct Tier {
+         Duration resolution;
+         std::size_t bucketCount;
+      };
+
+  private:
+      /**
+       * @brief Um balde do anel, com o intervalo a que se refere.
+       */
+      struct Bucket {
+         std::int64_t interval = 0;
+         bool used = false;
+         ACCUMULATOR accumulator;
+      };
+
+      /**
+       * @brief Uma camada e os seus baldes.
+       */
+      struct Level {
+         std::int64_t resolution;
+         std::vector<Bucket> buckets;
+         // Todos os valores com instante anterior a este já estão na camada.
+         std::int64_t closedUntil;
+      };
+
+      ACCUMULATOR prototype;
+      std::vector<Level> levels;
+      std::int64_t now = 0;
+      bool started = false;
+      std::uint64_t droppedValues = 0;
+
+      /**
+       * @brief Divide arredondando para baixo, também para negativos.
+       *
+       * @param value O dividendo.
+       * @param divisor O divisor, positivo.
+       *
+       * @return O quociente arredondado para baixo.
+       */
+      static std::int64_t floorDivide(
+        std::int64_t value, std::int64_t divisor) {
+         std::int64_t quotient = value / divisor;
+         return quotient - (value % divisor < 0 ? 1 : 0);
+      }
+
+      /**
+       * @brief Diz se uma camada ainda guarda um intervalo.
+       *
+       * @param level A camada.
+       * @param interval O índice do intervalo na camada.
+       *
+       * @return True se o intervalo está dentro do anel.
+       */
+      bool retains(Level const& level, std::int64_t interval) const {
+         std::int64_t current = floorDivide(now, level.resolution);
+
+         return interval <= current
+           && current - interval
+           < static_cast<std::int64_t>(level.buckets.size());
+      }
+
+      /**
+       * @brief Retorna o balde de um intervalo, zerando-o se o anel já o
+       * usava para um intervalo mais antigo.
+       *
+       * @param level A camada.
+       * @param interval O índice do intervalo na camada.
+       *
+       * @return O balde.
+       */
+      Bucket& bucketFor(Level& level, std::int64_t interval) {
+         auto count = static_cast<std::int64_t>(level.buckets.size());
+         auto& bucket = level.buckets[static_cast<std::size_t>(
+           interval - floorDivide(interval, count) * count)];
+
+         if (!bucket.used || bucket.interval != interval) {
+            bucket.accumulator = prototype;
+            bucket.interval = interval;
+            bucket.used = true;
+         }
+
+         return bucket;
+      }
+
+      /**
+       * @brief Procura o balde guardado de um intervalo.
+       *
+       * @param level A camada.
+       * @param interval O índice do intervalo na camada.
+       *
+       * @return O balde, ou nulo se ele não existir mais ou estiver vazio.
+       */
+      Bucket const* findBucket(
+        Level const& level, std::int64_t interval) const {
+         auto count = static_cast<std::int64_t>(level.buckets.size());
+         auto const& bucket = level.buckets[static_cast<std::size_t>(
+           interval - floorDivide(interval, count) * count)];
+
+         return bucket.used && bucket.interval == interval
+             && retains(level, interval)
+           ? &bucket
+           : nullptr;
+      }
+
+      /**
+       * @brief Diz se uma camada pode responder pelo balde [start, start +
+       * resolução): o balde ainda está no anel e, nas camadas consolidadas,
+       * já recebeu todos os baldes finos.
+       *
+       * @param tier O índice da camada.
+       * @param start O início do balde, alinhado à resolução.
+       *
+       * @return True se a camada pode responder pelo balde.
+       */
+      bool covers(std::size_t tier, std::int64_t start) const {
+         auto const& level = levels[tier];
+
+         return retains(level, floorDivide(start, level.resolution))
+           && (tier == 0 || start + level.resolution <= level.closedUntil);
+      }
+
+  public:
+      /**
+       * @brief Construtor com as camadas, da mais fina para a mais grossa.
+       *
+       * @param tiers As camadas. A resolução de cada uma deve ser múltipla
+       * da anterior, e cada camada deve cobrir pelo menos um balde da
+       * seguinte. O padrão é 60 baldes de 1 s, 60 de 1 min e 24 de 1 h.
+       * @param prototype O acumulador vazio copiado para cada balde novo,
+       * com a configuração desejada (por exemplo o k de um QuantileSketch).
+       *
+       * @throws std::runtime_error se as camadas forem inválidas.
+       */
+      TimeRollup(std::vector<Tier> const& tiers
+        = { { std::chrono::seconds(1), 60 },
+          { std::chrono::minutes(1), 60 },
+          { std::chrono::hours(1), 24 } },
+        ACCUMULATOR prototype = ACCUMULATOR())
+          : prototype(prototype) {
+         if (tiers.empty()) {
+            throw std::runtime_error("Rollup has no tiers");
+         }
+
+         for (std::size_t i = 0; i < tiers.size(); ++i) {
+            auto resolution = tiers[i].resolution.count();
+
+            if (resolution <= 0 || tiers[i].bucketCount == 0) {
+               throw std::runtime_error("Tier resolution or size is zero");
+            }
+            if (i > 0 && resolution % levels.back().resolution != 0) {
+               throw std::runtime_error(
+                 "Tier resolution is not a multiple of the previous one");
+            }
+            if (i > 0
+              && static_cast<std::int64_t>(tiers[i - 1].bucketCount)
+                  * levels.back().resolution
+                < resolution) {
+               throw std::runtime_error(
+                 "Tier does not cover one bucket of the next tier");
+            }
+
+            levels.push_back({ resolution,
+              std::vector<Bucket>(tiers[i].bucketCount),
+              0 });
+         }
+      }
+
+      /**
+       * @brief Avança o relógio, consolidando os baldes que se fecharam.
+       * Instantes anteriores ao atual são ignorados.
+       *
+       * Custa no máximo uma fusão por camada, qualquer que seja o salto.
+       *
+       * @param timestamp O instante atual.
+       *
+       * @return Uma referência para o próprio objeto.
+       */
+      TimeRollup& advance(Duration timestamp) {
+         std::int64_t time = timestamp.count();
+
+         if (!started) {
+            now = time;
+            started = true;
+            for (std::size_t tier = 1; tier < levels.size(); ++tier) {
+               std::int64_t finer = levels[tier - 1].resolution;
+               levels[tier].closedUntil = floorDivide(time, finer) * finer;
+            }
+            return *this;
+         }
+
+         if (time <= now) {
+            return *this;
+         }
+
+         for (std::size_t tier = 0; tier + 1 < levels.size(); ++tier) {
+            auto& level = levels[tier];
+            std::int64_t open = floorDivide(now, level.resolution);
+            std::int64_t next = floorDivide(time, level.resolution);
+
+            if (next > open) {
+               if (auto const* closing = findBucket(level, open)) {
+                  auto& coarser = levels[tier + 1];
+                  bucketFor(coarser,
+                    floorDivide(open * level.resolution, coarser.resolution))
+                    .accumulator.merge(closing->accumulator);
+               }
+               levels[tier + 1].closedUntil = next * level.resolution;
+            }
+         }
+
+         now = time;
+         return *this;
+      }
+
+      /**
+       * @brief Adiciona um valor no seu instante, avançando o relógio se o
+       * instante for posterior ao atual.
+       *
+       * @param timestamp O instante do valor.
+       * @param value O valor.
+       *
+       * @return Uma referência para o próprio objeto.
+       */
+      TimeRollup& push(Duration timestamp, TYPE value) {
+         return pushBatch(timestamp, std::span<TYPE const>(&value, 1));
+      }
+
+      /**
+       * @brief Adiciona um lote de valores com o mesmo instante.
+       *
+       * @param timestamp O instante dos valores.
+       * @param values Os valores.
+       *
+       * @return Uma referência para o próprio objeto.
+       */
+      TimeRollup& pushBatch(Duration timestamp, std::span<TYPE const> values) {
+         advance(timestamp);
+
+         std::int64_t time = timestamp.count();
+         bool stored = false;
+
+         for (std::size_t tier = 0; tier < levels.size(); ++tier) {
+            auto& level = levels[tier];
+            std::int64_t interval = floorDivide(time, level.resolution);
+
+            // Nas camadas consolidadas o valor só entra se o balde fino do
+            // seu instante já tiver sido mesclado.
+            if ((tier != 0 && time >= level.closedUntil)
+              || !retains(level, interval)) {
+               continue;
+            }
+
+            feedBatch(bucketFor(level, interval).accumulator, values);
+            stored = true;
+         }
+
+         if (!stored) {
+            droppedValues += values.size();
+         }
+
+         return *this;
+      }
+
+      /**
+       * @brief Junta os valores de um intervalo de tempo.
+       *
+       * O intervalo é coberto do fim para o início pelos baldes da camada
+       * mais grossa que cabem nele. Os limites são arredondados para fora
+       * até a resolução da camada mais fina que ainda guarda cada ponta, e
+       * valores mais antigos que todas as camadas não aparecem.
+       *
+       * @param begin O início do intervalo, incluído.
+       * @param end O fim do intervalo, excluído.
+       *
+       * @return O acumulador com os valores do intervalo.
+       */
+      ACCUMULATOR query(Duration begin, Duration end) const {
+         ACCUMULATOR result = prototype;
+         if (!started || end <= begin) {
+            return result;
+         }
+
+         std::int64_t resolution = levels[0].resolution;
+         std::int64_t first
+           = floorDivide(begin.count(), resolution) * resolution;
+         std::int64_t cursor = std::min(
+           end.count(), (floorDivide(now, resolution) + 1) * resolution);
+         bool found = false;
+
+         // O fim é arredondado para o fim do balde mais fino que o guarda.
+         for (std::size_t tier = 0; tier < levels.size() && !found; ++tier) {
+            std::int64_t resolution = levels[tier].resolution;
+            std::int64_t start
+              = floorDivide(cursor - 1, resolution) * resolution;
+            if (covers(tier, start)) {
+               cursor = start + resolution;
+               found = true;
+            }
+         }
+
+         while (found && cursor > first) {
+            std::size_t chosen = levels.size();
+            std::size_t overshoot = levels.size();
+
+            for (std::size_t tier = levels.size(); tier-- > 0;) {
+               std::int64_t resolution = levels[tier].resolution;
+               if (floorDivide(cursor, resolution) * resolution != cursor
+                 || !covers(tier, cursor - resolution)) {
+                  continue;
+               }
+
+               if (cursor - resolution >= first) {
+                  chosen = tier;
+                  break;
+               }
+               overshoot = tier;
+            }
+
+            // No início, sem camada fina que o guarde, o balde grosso que
+            // passa do início é usado inteiro.
+            bool last = chosen == levels.size();
+            if (last) {
+               chosen = overshoot;
+            }
+            if (chosen == levels.size()) {
+               break;
+            }
+
+            auto const& level = levels[chosen];
+            std::int64_t start = cursor - level.resolution;
+            if (auto const* bucket
+              = findBucket(level, floorDivide(start, level.resolution))) {
+               result.merge(bucket->accumulator);
+            }
+
+            cursor = start;
+            if (last) {
+               break;
+            }
+         }
+
+         return result;
+      }
+
+      /**
+       * @brief Junta os valores de uma janela que termina no instante atual,
+       * como "últimos 5 minutos". O balde aberto da camada mais fina é
+       * incluído.
+       *
+       * @param window A duração da janela.
+       *
+       * @return O acumulador com os valores da janela.
+       */
+      ACCUMULATOR last(Duration window) const {
+         std::int64_t resolution = levels[0].resolution;
+         Duration end((floorDivide(now, resolution) + 1) * resolution);
+
+         return query(end - window, end);
+      }
+
+      /**
+       * @brief Retorna o instante atual do relógio.
+       *
+       * @return O maior instante visto.
+       */
+      Duration getNow() const { return Duration(now); }
+
+      /**
+       * @brief Retorna o número de camadas.
+       *
+       * @return O número de camadas.
+       */
+      std::size_t tierCount() const { return levels.size(); }
+
+      /**
+       * @brief Retorna quantos valores foram descartados por serem mais
+       * antigos que todas as camadas.
+       *
+       * @return O número de valores descartados.
+       */
+      std::uint64_t dropped() const { return droppedValues; }
+   };
+}
+
+#endif /// TIME_ROLLUP_HPP_
@@ -1,15 +1,1245 @@
-#include "Binomial.hpp"
+/**
+ * @file main.cpp
+ * @author Pedro Lucas (pedrolucas.jsrn@gmail.com)
+ * @brief Ferramenta de linha de comando que calcula estatísticas de colunas
+ * numéricas lidas de arquivos ou da entrada padrão.
+ * @version 1.0
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "CsvParser.hpp"
+#include "HeavyHitters.hpp"
+#include "HyperLogLog.hpp"
+#include "MappedColumn.hpp"
+#include "MetricsDaemon.hpp"
+#include "QuantileSketch.hpp"
 #include "Statistics.hpp"
-#include <iostream>
+#include "StreamingStatistics.hpp"
+#include "ThreadPool.hpp"
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+   using stats::CsvParser;
+   using stats::HeavyHitters;
+   using stats::HyperLogLog;
+   using stats::MappedColumn;
+   using stats::MetricsDaemon;
+   using stats::QuantileSketch;
+   using stats::ReductionMode;
+   using stats::Statistics;
+   using stats::StreamingStatistics;
+   using stats::ThreadPool;
+
+   char const* const usage = R"(Uso: stats [opções] [arquivo...]
+       stats daemon [opções do daemon]
+
+Calcula estatísticas das colunas numéricas dos arquivos, ou da entrada
+padrão se nenhum arquivo for dado ('-' também lê a entrada padrão). Os
+arquivos são lidos em sequência como uma única tabela.
+
+Opções:
+  -c, --columns LISTA     colunas a serem lidas, contadas a partir de 1 ou
+                          pelo nome do cabeçalho, com intervalos (1,3-5,preco).
+                          O padrão é 1.
+  -s, --stats LISTA       estatísticas calculadas (padrão:
+                          count,mean,sd,min,max). Aceita count, sum, mean,
+                          var, sd, cv, min, max, range, median, mode,
+                          distinct, pN (percentil N, como p99.9) e qF
+                          (quantil F entre 0 e 1, como q0.25).
+  -d, --delimiter C       separador de colunas (padrão ','; 'tab' para \t).
+  -H, --header            a primeira linha de cada arquivo é um cabeçalho.
+  -a, --approx            memória limitada: quantis, moda e valores
+                          distintos estimados por esboços, sem guardar os
+                          valores.
+  -b, --binary            os arquivos são colunas binárias de double (o
+                          formato de MappedColumn), lidas sem conversão.
+  -f, --format FORMATO    saída em text (padrão), csv ou json.
+      --sample            variância amostral em vez da populacional.
+  -t, --threads N         número de threads (padrão: uma por processador).
+  -h, --help              mostra esta ajuda.
+
+No modo daemon, agrega linhas 'chave:valor[:valor...][|sufixo]' recebidas
+por UDP em 127.0.0.1 e por um socket Unix de datagramas, e grava um retrato
+JSON das séries de cada chave a cada intervalo e ao receber SIGHUP, SIGINT
+ou SIGTERM (os dois últimos encerram o daemon).
+
+Opções do daemon:
+  -u, --udp PORTA         porta UDP (padrão 8125 se nenhum socket for dado).
+  -U, --unix CAMINHO      socket Unix de datagramas.
+  -r, --receivers N       receptoras na porta UDP, com SO_REUSEPORT
+                          (padrão 1).
+  -w, --shards N          fragmentos e threads trabalhadoras (padrão: um
+                          por processador).
+  -i, --interval S        segundos entre retratos (padrão 10).
+  -o, --output ARQUIVO    arquivo do retrato, trocado atomicamente (padrão
+                          stats-snapshot.json).
+  -s, --stats LISTA       como acima, sem mode e distinct (padrão:
+                          count,mean,sd,min,max,p50,p90,p99).
+      --reset             zera as séries a cada retrato, como o statsd.
+)";
+
+   /**
+    * @brief Erro de uso da linha de comando.
+    */
+   struct UsageError : std::runtime_error {
+      using std::runtime_error::runtime_error;
+   };
+
+   /**
+    * @brief As estatísticas que a ferramenta sabe calcular.
+    */
+   enum class Measure {
+      Count,
+      Sum,
+      Mean,
+      Variance,
+      StandardDeviation,
+      CoefficientOfVariation,
+      Min,
+      Max,
+      Amplitude,
+      Quantile,
+      Mode,
+      Distinct
+   };
+
+   /**
+    * @brief Uma estatística pedida, com o nome usado na saída.
+    */
+   struct Request {
+      std::string name;
+      Measure measure;
+      double p = 0;
+   };
+
+   enum class Format { Text, Csv, Json };
+
+   /**
+    * @brief As opções da linha de comando.
+    */
+   struct Options {
+      std::vector<std::string> columns { "1" };
+      std::vector<Request> requests;
+      std::vector<std::string> inputs;
+      char delimiter = ',';
+      bool hasHeader = false;
+      bool approx = false;
+      bool binary = false;
+      bool population = true;
+      Format format = Format::Text;
+      std::size_t threads = 0;
+   };
+
+   /**
+    * @brief As opções do modo daemon.
+    */
+   struct DaemonOptions {
+      std::optional<std::uint16_t> udpPort;
+      std::string unixPath;
+      std::size_t receivers = 1;
+      std::size_t shards = std::thread::hardware_concurrency();
+      std::chrono::milliseconds interval { 10000 };
+      std::string output = "stats-snapshot.json";
+      std::vector<Request> requests;
+      bool reset = false;
+   };
+
+   /**
+    * @brief Divide um texto em partes separadas por um caractere.
+    *
+    * @param text O texto.
+    * @param separator O separador.
+    *
+    * @return As partes, inclusive as vazias.
+    */
+   std::vector<std::string_view> split(std::string_view text, char separator) {
+      std::vector<std::string_view> parts;
+      std::size_t begin = 0;
+
+      while (true) {
+         std::size_t end = text.find(separator, begin);
+         if (end == std::string_view::npos) {
+            parts.push_back(text.substr(begin));
+            return parts;
+         }
+
+         parts.push_back(text.substr(begin, end - begin));
+         begin = end + 1;
+      }
+   }
+
+   /**
+    * @brief Lê um número inteiro ou real completo.
+    *
+    * @tparam NUMBER O tipo do número.
+    *
+    * @param text O texto.
+    *
+    * @return O número, ou nada se o texto não for um número completo.
+    */
+   template <typename NUMBER>
+   std::optional<NUMBER> parseNumber(std::string_view text) {
+      NUMBER value {};
+      auto [end, error]
+        = std::from_chars(text.data(), text.data() + text.size(), value);
+
+      if (text.empty() || error != std::errc()
+        || end != text.data() + text.size()) {
+         return std::nullopt;
+      }
+
+      return value;
+   }
+
+   /**
+    * @brief Interpreta o nome de uma estatística.
+    *
+    * @param name O nome, como "mean" ou "p99".
+    *
+    * @return A estatística pedida.
+    *
+    * @throws UsageError se o nome não for conhecido.
+    */
+   Request parseRequest(std::string_view name) {
+      static constexpr std::array<std::pair<std::string_view, Measure>, 15>
+        names { { { "count", Measure::Count },
+          { "sum", Measure::Sum },
+          { "mean", Measure::Mean },
+          { "var", Measure::Variance },
+          { "variance", Measure::Variance },
+          { "sd", Measure::StandardDeviation },
+          { "stddev", Measure::StandardDeviation },
+          { "cv", Measure::CoefficientOfVariation },
+          { "min", Measure::Min },
+          { "max", Measure::Max },
+          { "range", Measure::Amplitude },
+          { "median", Measure::Quantile },
+          { "mode", Measure::Mode },
+          { "distinct", Measure::Distinct },
+          { "amplitude", Measure::Amplitude } } };
+
+      for (auto const& [known, measure] : names) {
+         if (name == known) {
+            return { std::string(name), measure, 0.5 };
+         }
+      }
+
+      if (name.size() > 1 && (name[0] == 'p' || name[0] == 'q')) {
+         auto value = parseNumber<double>(name.substr(1));
+         double p = value ? (name[0] == 'p' ? *value / 100 : *value) : -1;
+
+         if (p >= 0 && p <= 1) {
+            return { std::string(name), Measure::Quantile, p };
+         }
+      }
+
+      throw UsageError("Unknown statistic '" + std::string(name) + "'");
+   }
+
+   /**
+    * @brief Lê as opções da linha de comando.
+    *
+    * @param argc O número de argumentos.
+    * @param argv Os argumentos.
+    *
+    * @return As opções, ou nada se a ajuda foi pedida.
+    *
+    * @throws UsageError se os argumentos forem inválidos.
+    */
+   std::optional<Options> parseOptions(int argc, char** argv) {
+      Options options;
+      std::string statistics = "count,mean,sd,min,max";
+      bool onlyInputs = false;
+
+      for (int i = 1; i < argc; ++i) {
+         std::string_view argument = argv[i];
+
+         if (onlyInputs || argument == "-" || argument.empty()
+           || argument[0] != '-') {
+            options.inputs.emplace_back(argument);
+            continue;
+         }
+
+         if (argument == "--") {
+            onlyInputs = true;
+            continue;
+         }
+
+         std::string_view name = argument;
+         std::optional<std::string_view> inlineValue;
+         if (std::size_t equals = argument.find('=');
+             argument.starts_with("--") && equals != std::string_view::npos) {
+            name = argument.substr(0, equals);
+            inlineValue = argument.substr(equals + 1);
+         }
+
+         auto value = [&]() -> std::string_view {
+            if (inlineValue) {
+               return *inlineValue;
+            }
+            if (i + 1 >= argc) {
+               throw UsageError("Missing value for " + std::string(name));
+            }
+
+            return argv[++i];
+         };
+
+         if (name == "-h" || name == "--help") {
+            return std::nullopt;
+         } else if (name == "-c" || name == "--columns") {
+            options.columns.clear();
+            for (auto column : split(value(), ',')) {
+               options.columns.emplace_back(column);
+            }
+         } else if (name == "-s" || name == "--stats") {
+            statistics = value();
+         } else if (name == "-d" || name == "--delimiter") {
+            auto delimiter = value();
+            if (delimiter == "tab" || delimiter == "\\t") {
+               options.delimiter = '\t';
+            } else if (delimiter.size() == 1 && delimiter[0] != '\n') {
+               options.delimiter = delimiter[0];
+            } else {
+               throw UsageError("Delimiter must be a single character");
+            }
+         } else if (name == "-H" || name == "--header") {
+            options.hasHeader = true;
+         } else if (name == "-a" || name == "--approx") {
+            options.approx = true;
+         } else if (name == "-b" || name == "--binary") {
+            options.binary = true;
+         } else if (name == "--sample") {
+            options.population = false;
+         } else if (name == "-f" || name == "--format") {
+            auto format = value();
+            if (format == "text") {
+               options.format = Format::Text;
+            } else if (format == "csv") {
+               options.format = Format::Csv;
+            } else if (format == "json") {
+               options.format = Format::Json;
+            } else {
+               throw UsageError("Unknown format '" + std::string(format) + "'");
+            }
+         } else if (name == "-t" || name == "--threads") {
+            auto threads = parseNumber<std::size_t>(value());
+            if (!threads || *threads == 0) {
+               throw UsageError("Thread count must be a positive integer");
+            }
+            options.threads = *threads;
+         } else {
+            throw UsageError("Unknown option '" + std::string(argument) + "'");
+         }
+      }
+
+      for (auto name : split(statistics, ',')) {
+         options.requests.push_back(parseRequest(name));
+      }
+
+      if (options.inputs.empty()) {
+         options.inputs.emplace_back("-");
+      }
+
+      return options;
+   }
+
+   /**
+    * @brief Lê as opções do modo daemon.
+    *
+    * @param argc O número de argumentos, contando "daemon".
+    * @param argv Os argumentos, a partir de "daemon".
+    *
+    * @return As opções, ou nada se a ajuda foi pedida.
+    *
+    * @throws UsageError se os argumentos forem inválidos.
+    */
+   std::optional<DaemonOptions> parseDaemonOptions(int argc, char** argv) {
+      DaemonOptions options;
+      std::string statistics = "count,mean,sd,min,max,p50,p90,p99";
+
+      auto positive = [](std::string_view text, std::string const& what) {
+         auto number = parseNumber<std::size_t>(text);
+         if (!number || *number == 0) {
+            throw UsageError(what + " must be a positive integer");
+         }
+
+         return *number;
+      };
+
+      for (int i = 1; i < argc; ++i) {
+         std::string_view argument = argv[i];
+         std::string_view name = argument;
+         std::optional<std::string_view> inlineValue;
+         if (std::size_t equals = argument.find('=');
+             argument.starts_with("--") && equals != std::string_view::npos) {
+            name = argument.substr(0, equals);
+            inlineValue = argument.substr(equals + 1);
+         }
+
+         auto value = [&]() -> std::string_view {
+            if (inlineValue) {
+               return *inlineValue;
+            }
+            if (i + 1 >= argc) {
+               throw UsageError("Missing value for " + std::string(name));
+            }
+
+            return argv[++i];
+         };
+
+         if (name == "-h" || name == "--help") {
+            return std::nullopt;
+         } else if (name == "-u" || name == "--udp") {
+            auto port = parseNumber<std::uint16_t>(value());
+            if (!port) {
+               throw UsageError("UDP port must be between 0 and 65535");
+            }
+            options.udpPort = *port;
+         } else if (name == "-U" || name == "--unix") {
+            options.unixPath = value();
+         } else if (name == "-r" || name == "--receivers") {
+            options.receivers = positive(value(), "Receiver count");
+         } else if (name == "-w" || name == "--shards") {
+            options.shards = positive(value(), "Shard count");
+         } else if (name == "-i" || name == "--interval") {
+            auto seconds = parseNumber<double>(value());
+            if (!seconds || !(*seconds >= 0.001) || *seconds > 1e6) {
+               throw UsageError(
+                 "Interval must be a positive number of seconds");
+            }
+            options.interval = std::chrono::milliseconds(
+              static_cast<std::int64_t>(std::llround(*seconds * 1000)));
+         } else if (name == "-o" || name == "--output") {
+            options.output = value();
+         } else if (name == "-s" || name == "--stats") {
+            statistics = value();
+         } else if (name == "--reset") {
+            options.reset = true;
+         } else {
+            throw UsageError("Unknown option '" + std::string(argument) + "'");
+         }
+      }
+
+      for (auto name : split(statistics, ',')) {
+         auto request = parseRequest(name);
+         if (request.measure == Measure::Mode
+           || request.measure == Measure::Distinct) {
+            throw UsageError("Statistic '" + request.name
+              + "' is not available in daemon mode");
+         }
+         options.requests.push_back(request);
+      }
+
+      if (!options.udpPort && options.unixPath.empty()) {
+         options.udpPort = 8125;
+      }
+      if (options.shards == 0) {
+         options.shards = 1;
+      }
+
+      return options;
+   }
+
+   /**
+    * @brief Calcula uma estatística que depende só dos momentos.
+    *
+    * @param moments Os momentos.
+    * @param request A estatística.
+    *
+    * @return O valor, ou NaN se não houver valores ou se a estatística não
+    * depender só dos momentos.
+    */
+   double measureMoments(
+     StreamingStatistics<double> const& moments, Request const& request) {
+      double const nan = std::numeric_limits<double>::quiet_NaN();
+
+      if (request.measure == Measure::Count) {
+         return static_cast<double>(moments.size());
+      }
+      if (moments.size() == 0) {
+         return nan;
+      }
+
+      bool undefinedVariance
+        = moments.size() < 2 && !moments.isPopulationData();
+
+      switch (request.measure) {
+      case Measure::Sum:
+         return moments.sum();
+      case Measure::Mean:
+         return moments.mean();
+      case Measure::Variance:
+         return undefinedVariance ? nan : moments.variance();
+      case Measure::StandardDeviation:
+         return undefinedVariance ? nan : moments.standardDeviation();
+      case Measure::CoefficientOfVariation:
+         return undefinedVariance || moments.mean() == 0
+           ? nan
+           : moments.standardDeviation() / moments.mean();
+      case Measure::Min:
+         return moments.min();
+      case Measure::Max:
+         return moments.max();
+      case Measure::Amplitude:
+         return moments.amplitude();
+      default:
+         return nan;
+      }
+   }
+
+   /**
+    * @brief Acumulador de uma coluna que alimenta, em uma única passada por
+    * lote, só as estruturas que as estatísticas pedidas precisam.
+    *
+    * Contagem, soma, média, variância, mínimo e máximo vêm sempre de um
+    * StreamingStatistics. Quantis, moda e valores distintos guardam os
+    * valores em um Statistics, ou, no modo aproximado, usam QuantileSketch,
+    * HeavyHitters e HyperLogLog com memória limitada.
+    */
+   class ColumnSummary {
+  private:
+      StreamingStatistics<double> moments;
+      std::optional<Statistics<double>> values;
+      std::optional<QuantileSketch<double>> sketch;
+      std::optional<HeavyHitters<double>> hitters;
+      std::optional<HyperLogLog<double>> distinct;
+
+      mutable std::optional<std::pair<double, std::size_t>> modeAndDistinct;
+
+      /**
+       * @brief Calcula a moda exata e o número de valores distintos em uma
+       * passada pelos valores ordenados.
+       *
+       * @return A moda, a menor em caso de empate, e o número de distintos.
+       */
+      std::pair<double, std::size_t> exactModeAndDistinct() const {
+         if (!modeAndDistinct) {
+            auto ordered = values->getSortedValues();
+            auto const& data = *ordered;
+
+            double mode = data.front();
+            std::size_t modeCount = 0;
+            std::size_t distinctCount = 0;
+
+            for (std::size_t first = 0; first < data.size();) {
+               std::size_t last = first + 1;
+               while (last < data.size() && data[last] == data[first]) {
+                  ++last;
+               }
+
+               if (last - first > modeCount) {
+                  mode = data[first];
+                  modeCount = last - first;
+               }
+
+               ++distinctCount;
+               first = last;
+            }
+
+            modeAndDistinct.emplace(mode, distinctCount);
+         }
+
+         return *modeAndDistinct;
+      }
+
+  public:
+      /**
+       * @brief Construtor com as estatísticas que serão pedidas.
+       *
+       * @param requests As estatísticas.
+       * @param approx Define se quantis, moda e distintos são estimados.
+       * @param population Define se a variância é populacional.
+       */
+      ColumnSummary(
+        std::vector<Request> const& requests, bool approx, bool population)
+          : moments(population) {
+         for (auto const& request : requests) {
+            auto measure = request.measure;
+
+            if (!approx
+              && (measure == Measure::Quantile || measure == Measure::Mode
+                || measure == Measure::Distinct)
+              && !values) {
+               values.emplace(population);
+               values->setReductionMode(ReductionMode::Parallel);
+            } else if (approx && measure == Measure::Quantile && !sketch) {
+               sketch.emplace();
+            } else if (approx && measure == Measure::Mode && !hitters) {
+               hitters.emplace();
+            } else if (approx && measure == Measure::Distinct && !distinct) {
+               distinct.emplace();
+            }
+         }
+      }
+
+      /**
+       * @brief Entrega um lote de valores a todas as estruturas da coluna.
+       *
+       * @param batch Os valores.
+       *
+       * @return Uma referência para o próprio objeto.
+       */
+      ColumnSummary& pushBatch(std::span<double const> batch) {
+         moments.pushBatch(batch);
+
+         if (values) {
+            values->addValues(batch.begin(), batch.end());
+         }
+         if (sketch) {
+            sketch->pushBatch(batch);
+         }
+         if (hitters) {
+            hitters->pushBatch(batch);
+         }
+         if (distinct) {
+            distinct->pushBatch(batch);
+         }
+
+         return *this;
+      }
+
+      /**
+       * @brief Retorna o número de valores lidos.
+       *
+       * @return O número de valores.
+       */
+      std::uint64_t size() const { return moments.size(); }
+
+      /**
+       * @brief Calcula uma estatística pedida.
+       *
+       * @param request A estatística.
+       *
+       * @return O valor, ou NaN se a coluna estiver vazia.
+       */
+      double measure(Request const& request) const {
+         if (moments.size() == 0) {
+            return measureMoments(moments, request);
+         }
+
+         switch (request.measure) {
+         case Measure::Quantile:
+            return sketch ? sketch->quantile(request.p)
+                          : values->quantile(request.p);
+         case Measure::Mode:
+            return hitters ? hitters->mode() : exactModeAndDistinct().first;
+         case Measure::Distinct:
+            return distinct
+              ? static_cast<double>(distinct->distinctCount())
+              : static_cast<double>(exactModeAndDistinct().second);
+         default:
+            return measureMoments(moments, request);
+         }
+      }
+   };
+
+   /**
+    * @brief Lê um descritor até encher o buffer ou chegar ao fim.
+    *
+    * @param descriptor O descritor.
+    * @param buffer O buffer.
+    *
+    * @return O número de bytes lidos; menor que o buffer só no fim.
+    *
+    * @throws std::runtime_error se a leitura falhar.
+    */
+   std::size_t readBlock(int descriptor, std::span<char> buffer) {
+      std::size_t filled = 0;
+
+      while (filled < buffer.size()) {
+         ssize_t count
+           = ::read(descriptor, buffer.data() + filled, buffer.size() - filled);
+         if (count < 0 && errno == EINTR) {
+            continue;
+         }
+         if (count < 0) {
+            throw std::runtime_error(
+              std::string("Could not read input: ") + std::strerror(errno));
+         }
+         if (count == 0) {
+            break;
+         }
+
+         filled += static_cast<std::size_t>(count);
+      }
+
+      return filled;
+   }
+
+   /**
+    * @brief Lê as entradas e entrega as colunas selecionadas aos
+    * acumuladores.
+    */
+   class Reader {
+  private:
+      static constexpr std::size_t blockBytes = std::size_t { 32 } << 20;
+
+      Options const& options;
+      CsvParser<double> parser;
+      std::vector<ColumnSummary>& summaries;
+      std::vector<std::string> labels;
+      bool resolved = false;
+
+      /**
+       * @brief Traduz as colunas pedidas para posições, usando o cabeçalho
+       * da primeira entrada para os nomes.
+       *
+       * @param header A primeira linha da primeira entrada.
+       */
+      void resolveColumns(std::string_view header) {
+         std::vector<std::string_view> names;
+         if (options.hasHeader) {
+            if (!header.empty() && header.back() == '\r') {
+               header.remove_suffix(1);
+            }
+            names = split(header, options.delimiter);
+            for (auto& name : names) {
+               std::size_t first = name.find_first_not_of(" \t\"");
+               std::size_t last = name.find_last_not_of(" \t\"");
+               name = first == std::string_view::npos
+                 ? std::string_view()
+                 : name.substr(first, last - first + 1);
+            }
+         }
+
+         std::vector<std::size_t> columns;
+         auto add = [&](std::size_t column) {
+            columns.push_back(column);
+            labels.push_back(column < names.size() && !names[column].empty()
+                ? std::string(names[column])
+                : std::to_string(column + 1));
+         };
+
+         for (std::string_view spec : options.columns) {
+            auto single = parseNumber<std::size_t>(spec);
+
+            // from e to ficam 0 se spec não for um intervalo "início-fim".
+            std::size_t from = 0;
+            std::size_t to = 0;
+            std::size_t dash = spec.find('-', 1);
+            if (dash != std::string_view::npos) {
+               auto first = parseNumber<std::size_t>(spec.substr(0, dash));
+               auto last = parseNumber<std::size_t>(spec.substr(dash + 1));
+               if (first && last) {
+                  from = *first;
+                  to = *last;
+               }
+            }
+
+            if (single && *single > 0) {
+               add(*single - 1);
+            } else if (from > 0 && from <= to) {
+               for (std::size_t column = from; column <= to; ++column) {
+                  add(column - 1);
+               }
+            } else {
+               auto found = std::find(names.begin(), names.end(), spec);
+               if (found == names.end()) {
+                  throw UsageError(
+                    "Unknown column '" + std::string(spec) + "'");
+               }
+               add(static_cast<std::size_t>(found - names.begin()));
+            }
+         }
+
+         parser.setColumns(std::move(columns));
+         for (std::size_t i = 0; i < labels.size(); ++i) {
+            summaries.emplace_back(
+              options.requests, options.approx, options.population);
+         }
+         resolved = true;
+      }
+
+      /**
+       * @brief Lê um texto inteiro já na memória.
+       *
+       * @param text O texto.
+       * @param offset A posição do texto na entrada, para as mensagens de
+       * erro.
+       */
+      void parseText(std::string_view text, std::size_t offset = 0) {
+         std::size_t headerEnd = text.find('\n');
+         std::string_view header = text.substr(0, headerEnd);
+
+         if (!resolved) {
+            resolveColumns(header);
+         }
+         if (options.hasHeader) {
+            std::size_t skipped = headerEnd == std::string_view::npos
+              ? text.size()
+              : headerEnd + 1;
+            text.remove_prefix(skipped);
+            offset += skipped;
+         }
+
+         parser.parse(text, std::span<ColumnSummary>(summaries), offset);
+      }
+
+      /**
+       * @brief Lê um texto de um descritor que não pode ser mapeado, em
+       * blocos, lendo o próximo bloco enquanto o atual é convertido.
+       *
+       * Cada bloco é convertido até a última quebra de linha; o resto vai
+       * para o início do bloco seguinte, em uma pequena cópia.
+       *
+       * @param descriptor O descritor.
+       */
+      void parseStream(int descriptor) {
+         std::array<std::vector<char>, 2> blocks {
+            std::vector<char>(blockBytes), std::vector<char>(blockBytes)
+         };
+         std::string carry;
+         bool headerPending = true;
+         std::size_t blockOffset = 0;
+         std::size_t current = readBlock(descriptor, blocks[0]);
+
+         for (std::size_t index = 0; current > 0; index ^= 1) {
+            auto& block = blocks[index];
+            auto next = std::async(std::launch::async,
+              [&, other = index ^ 1] {
+                 return readBlock(descriptor, blocks[other]);
+              });
+
+            std::string_view text(block.data(), current);
+            std::size_t firstLine = text.find('\n');
+            std::size_t lastLine = text.rfind('\n');
+            std::size_t carryOffset = blockOffset - carry.size();
+
+            if (firstLine == std::string_view::npos) {
+               carry.append(text);
+            } else {
+               carry.append(text.substr(0, firstLine + 1));
+               if (headerPending) {
+                  parseText(carry, carryOffset);
+                  headerPending = false;
+               } else {
+                  parser.parse(carry,
+                    std::span<ColumnSummary>(summaries),
+                    carryOffset);
+               }
+
+               parser.parse(text.substr(firstLine + 1, lastLine - firstLine),
+                 std::span<ColumnSummary>(summaries),
+                 blockOffset + firstLine + 1);
+               carry.assign(text.substr(lastLine + 1));
+            }
+
+            blockOffset += current;
+            current = next.get();
+         }
+
+         std::size_t carryOffset = blockOffset - carry.size();
+         if (headerPending) {
+            parseText(carry, carryOffset);
+         } else if (!carry.empty()) {
+            parser.parse(
+              carry, std::span<ColumnSummary>(summaries), carryOffset);
+         }
+      }
+
+      /**
+       * @brief Lê uma coluna binária mapeada em memória.
+       *
+       * @param path O caminho do arquivo.
+       */
+      void parseBinary(std::string const& path) {
+         if (!resolved) {
+            if (options.columns.size() != 1 || options.columns[0] != "1") {
+               throw UsageError("Binary input has a single column");
+            }
+            resolveColumns({});
+         }
+
+         MappedColumn<double> column(path);
+         auto data = column.values();
+         std::size_t batch = std::size_t { 1 } << 20;
+
+         for (std::size_t first = 0; first < data.size(); first += batch) {
+            summaries[0].pushBatch(
+              data.subspan(first, std::min(batch, data.size() - first)));
+         }
+      }
+
+  public:
+      /**
+       * @brief Construtor com as opções e os acumuladores a preencher.
+       *
+       * @param options As opções.
+       * @param summaries Os acumuladores, um por coluna selecionada, criados
+       * na primeira entrada.
+       */
+      Reader(Options const& options, std::vector<ColumnSummary>& summaries)
+          : options(options),
+            parser(options.delimiter),
+            summaries(summaries) { }
+
+      /**
+       * @brief Lê uma entrada. Arquivos comuns, inclusive a entrada padrão
+       * redirecionada de um arquivo, são mapeados em memória; pipes são
+       * lidos em blocos.
+       *
+       * @param input O caminho, ou "-" para a entrada padrão.
+       */
+      void read(std::string const& input) {
+         bool standardInput = input == "-";
+         std::string path = standardInput ? "/dev/stdin" : input;
+
+         struct stat status;
+         int result = standardInput ? fstat(STDIN_FILENO, &status)
+                                    : stat(path.c_str(), &status);
+         if (result != 0) {
+            throw std::runtime_error("Could not stat '" + input
+              + "': " + std::strerror(errno));
+         }
+
+         if (options.binary) {
+            if (!S_ISREG(status.st_mode)) {
+               throw std::runtime_error(
+                 "Binary input '" + input + "' must be a regular file");
+            }
+            parseBinary(path);
+         } else if (S_ISREG(status.st_mode)) {
+            MappedColumn<char> file(path, false);
+            auto bytes = file.values();
+            parseText(std::string_view(bytes.data(), bytes.size()));
+         } else if (standardInput) {
+            parseStream(STDIN_FILENO);
+         } else {
+            int descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (descriptor < 0) {
+               throw std::runtime_error("Could not open '" + input
+                 + "': " + std::strerror(errno));
+            }
+
+            try {
+               parseStream(descriptor);
+            } catch (...) {
+               close(descriptor);
+               throw;
+            }
+            close(descriptor);
+         }
+      }
+
+      /**
+       * @brief Retorna o rótulo de cada coluna selecionada: o nome do
+       * cabeçalho, ou a posição contada a partir de 1.
+       *
+       * @return Os rótulos.
+       */
+      std::vector<std::string> const& getLabels() const { return labels; }
+   };
+
+   /**
+    * @brief Formata um número na menor forma que o recupera exatamente.
+    *
+    * @param value O número.
+    * @param json Define se NaN e infinitos viram null.
+    *
+    * @return O texto.
+    */
+   std::string formatNumber(double value, bool json) {
+      if (!std::isfinite(value)) {
+         return json ? "null" : std::isnan(value) ? "nan"
+           : value > 0                            ? "inf"
+                                                  : "-inf";
+      }
+
+      std::array<char, 32> buffer;
+      auto result = std::abs(value) < 0x1p53 && value == std::trunc(value)
+        ? std::to_chars(buffer.data(),
+            buffer.data() + buffer.size(),
+            static_cast<std::int64_t>(value))
+        : std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+
+      return std::string(buffer.data(), result.ptr);
+   }
+
+   /**
+    * @brief Escreve um texto como string JSON.
+    *
+    * @param text O texto.
+    *
+    * @return A string entre aspas.
+    */
+   std::string quoteJson(std::string_view text) {
+      std::string quoted = "\"";
+
+      for (char character : text) {
+         if (character == '"' || character == '\\') {
+            quoted += '\\';
+            quoted += character;
+         } else if (static_cast<unsigned char>(character) < 0x20) {
+            std::array<char, 8> escape;
+            std::snprintf(escape.data(), escape.size(), "\\u%04x", character);
+            quoted += escape.data();
+         } else {
+            quoted += character;
+         }
+      }
+
+      return quoted + "\"";
+   }
+
+   /**
+    * @brief Escreve os resultados na saída padrão.
+    *
+    * @param options As opções.
+    * @param labels O rótulo de cada coluna.
+    * @param summaries Os acumuladores de cada coluna.
+    */
+   void report(Options const& options,
+     std::vector<std::string> const& labels,
+     std::vector<ColumnSummary> const& summaries) {
+      bool json = options.format == Format::Json;
+      std::vector<std::vector<std::string>> table;
+
+      for (std::size_t column = 0; column < summaries.size(); ++column) {
+         auto& row = table.emplace_back();
+         row.push_back(labels[column]);
+         for (auto const& request : options.requests) {
+            row.push_back(
+              formatNumber(summaries[column].measure(request), json));
+         }
+      }
+
+      std::string output;
+
+      if (json) {
+         output += "[";
+         for (std::size_t column = 0; column < table.size(); ++column) {
+            output += column == 0 ? "\n  {" : ",\n  {";
+            output += "\"column\": " + quoteJson(table[column][0]);
+            for (std::size_t i = 0; i < options.requests.size(); ++i) {
+               output += ", " + quoteJson(options.requests[i].name) + ": "
+                 + table[column][i + 1];
+            }
+            output += "}";
+         }
+         output += "\n]\n";
+      } else if (options.format == Format::Csv) {
+         output += "column";
+         for (auto const& request : options.requests) {
+            output += "," + request.name;
+         }
+         output += "\n";
+         for (auto const& row : table) {
+            for (std::size_t i = 0; i < row.size(); ++i) {
+               output += (i == 0 ? "" : ",") + row[i];
+            }
+            output += "\n";
+         }
+      } else {
+         std::vector<std::string> header { "column" };
+         for (auto const& request : options.requests) {
+            header.push_back(request.name);
+         }
+
+         std::vector<std::size_t> widths(header.size());
+         for (std::size_t i = 0; i < header.size(); ++i) {
+            widths[i] = header[i].size();
+            for (auto const& row : table) {
+               widths[i] = std::max(widths[i], row[i].size());
+            }
+         }
+
+         table.insert(table.begin(), header);
+         for (auto const& row : table) {
+            for (std::size_t i = 0; i < row.size(); ++i) {
+               std::string padding(widths[i] - row[i].size(), ' ');
+               output += i == 0 ? row[i] + padding : "  " + padding + row[i];
+            }
+            output += "\n";
+         }
+      }
+
+      std::fwrite(output.data(), 1, output.size(), stdout);
+   }
+
+   /**
+    * @brief Grava o retrato das séries do daemon em JSON. O arquivo é
+    * escrito ao lado do destino e renomeado, então os leitores nunca veem um
+    * retrato pela metade.
+    *
+    * @param options As opções do daemon.
+    * @param daemon O daemon.
+    *
+    * @throws std::runtime_error se o arquivo não puder ser gravado.
+    */
+   void writeSnapshot(DaemonOptions const& options, MetricsDaemon& daemon) {
+      auto series = daemon.snapshot(options.reset);
+      auto timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch());
+
+      std::string output = "{\"timestamp\": "
+        + std::to_string(timestamp.count())
+        + ", \"datagrams\": " + std::to_string(daemon.datagrams())
+        + ", \"samples\": " + std::to_string(daemon.samples())
+        + ", \"malformed\": " + std::to_string(daemon.malformed())
+        + ", \"metrics\": [";
+
+      for (std::size_t i = 0; i < series.size(); ++i) {
+         auto const& [key, values] = series[i];
+         output += i == 0 ? "\n  {" : ",\n  {";
+         output += "\"key\": " + quoteJson(key);
+
+         for (auto const& request : options.requests) {
+            double value = request.measure == Measure::Quantile
+                && values.sketch.size() > 0
+              ? values.sketch.quantile(request.p)
+              : measureMoments(values.statistics, request);
+            output += ", " + quoteJson(request.name) + ": "
+              + formatNumber(value, true);
+         }
+         output += "}";
+      }
+      output += series.empty() ? "]}\n" : "\n]}\n";
+
+      std::string temporary = options.output + ".tmp";
+      std::FILE* file = std::fopen(temporary.c_str(), "w");
+      if (file == nullptr) {
+         throw std::runtime_error("Could not open '" + temporary
+           + "': " + std::strerror(errno));
+      }
+
+      bool written
+        = std::fwrite(output.data(), 1, output.size(), file) == output.size();
+      written = std::fclose(file) == 0 && written;
+
+      if (!written || std::rename(temporary.c_str(), options.output.c_str())) {
+         std::string message = std::strerror(errno);
+         std::remove(temporary.c_str());
+         throw std::runtime_error(
+           "Could not write '" + options.output + "': " + message);
+      }
+   }
+
+   /**
+    * @brief Executa o modo daemon até receber SIGINT ou SIGTERM.
+    *
+    * @param argc O número de argumentos, contando "daemon".
+    * @param argv Os argumentos, a partir de "daemon".
+    *
+    * @return O código de saída.
+    */
+   int runDaemon(int argc, char** argv) {
+      auto options = parseDaemonOptions(argc, argv);
+      if (!options) {
+         std::fputs(usage, stdout);
+         return EXIT_SUCCESS;
+      }
+
+      // Os sinais são bloqueados antes de criar as threads, que herdam a
+      // máscara, e tratados aqui com sigtimedwait().
+      sigset_t signals;
+      sigemptyset(&signals);
+      sigaddset(&signals, SIGINT);
+      sigaddset(&signals, SIGTERM);
+      sigaddset(&signals, SIGHUP);
+      pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+      MetricsDaemon daemon(options->shards);
+      if (options->udpPort) {
+         daemon.listenUdp(*options->udpPort, options->receivers);
+         std::fprintf(
+           stderr, "stats: listening on udp 127.0.0.1:%u\n", daemon.udpPort());
+      }
+      if (!options->unixPath.empty()) {
+         daemon.listenUnix(options->unixPath);
+         std::fprintf(
+           stderr, "stats: listening on unix %s\n", options->unixPath.c_str());
+      }
+
+      auto deadline = std::chrono::steady_clock::now() + options->interval;
+
+      while (true) {
+         auto remaining = std::max(deadline - std::chrono::steady_clock::now(),
+           std::chrono::steady_clock::duration::zero());
+         auto seconds
+           = std::chrono::duration_cast<std::chrono::seconds>(remaining);
+         timespec timeout { static_cast<time_t>(seconds.count()),
+            static_cast<long>(
+              std::chrono::duration_cast<std::chrono::nanoseconds>(
+                remaining - seconds)
+                .count()) };
+
+         int received = sigtimedwait(&signals, nullptr, &timeout);
+         if (received < 0 && errno == EINTR) {
+            continue;
+         }
+         if (received == SIGINT || received == SIGTERM) {
+            break;
+         }
+
+         writeSnapshot(*options, daemon);
+         if (received < 0) {
+            deadline = std::max(deadline + options->interval,
+              std::chrono::steady_clock::now());
+         }
+      }
+
+      daemon.stop();
+      writeSnapshot(*options, daemon);
+
+      return EXIT_SUCCESS;
+   }
+}
 
 int main(int argc, char** argv) {
-   stats::Statistics stats({ 1, 2, 3, 4, 5 });
+   try {
+      if (argc > 1 && std::string_view(argv[1]) == "daemon") {
+         return runDaemon(argc - 1, argv + 1);
+      }
+
+      auto options = parseOptions(argc, argv);
+      if (!options) {
+         std::fputs(usage, stdout);
+         return EXIT_SUCCESS;
+      }
+
+      if (options->threads > 0) {
+         ThreadPool::setDefault(std::make_shared<ThreadPool>(options->threads));
+      }
 
-   std::cout << "Média: " << stats.mean() << std::endl;
-   std::cout << "Desvio Padrão: " << stats.standardDeviation() << std::endl;
+      std::vector<ColumnSummary> summaries;
+      Reader reader(*options, summaries);
+      for (auto const& input : options->inputs) {
+         reader.read(input);
+      }
 
-   stats::Binomial binom(10, 0.5);
-   std::cout << "Probabilidade: " << binom.getProbability(5) << std::endl;
+      report(*options, reader.getLabels(), summaries);
+   } catch (UsageError const& error) {
+      std::fprintf(stderr, "stats: %s\n\n%s", error.what(), usage);
+      return 2;
+   } catch (std::exception const& error) {
+      std::fprintf(stderr, "stats: %s\n", error.what());
+      return EXIT_FAILURE;
+   }
 
    return EXIT_SUCCESS;
-}
\ No newline at end of file
+}